@@ -129,7 +129,8 @@ class _MultVecScalar(expr.Function):
 class _MultMatVec(expr.Function):
     """
     Class for handling dotproduct of two Expressions.
-    One argument is a MultiDimParameter.
+    One argument is a MultiDimParameter, a SparseMultiDimParameter selects
+    the sparse variants (O(nnz) per evaluation).
     """
 
     def __init__(self, a: "expr.MultiDimParameter", b: "expr.Expression"):
@@ -147,33 +148,41 @@ class _MultMatVec(expr.Function):
                                  + str(a.get_dim()) + ", b:" +
                                  str(b.get_dim()) + ")")
 
+        if isinstance(a, expr.SparseMultiDimParameter):
+            prefix = "Mult_SpMat"
+        else:
+            prefix = "Mult_Mat"
+
+        def variant(name):
+            return getattr(cppyy.gbl, prefix + name)(a.cpprep, b.cpprep)
+
         if a.get_sign() == cppyy.gbl.sign.NN and \
                 b.get_sign() == cppyy.gbl.sign.NN:
-            self.cpprep = cppyy.gbl.Mult_MatNN_VecNN(a.cpprep, b.cpprep)
+            self.cpprep = variant("NN_VecNN")
         elif a.get_sign() == cppyy.gbl.sign.NP and \
                 b.get_sign() == cppyy.gbl.sign.NP:
-            self.cpprep = cppyy.gbl.Mult_MatNP_VecNP(a.cpprep, b.cpprep)
+            self.cpprep = variant("NP_VecNP")
         elif a.get_sign() == cppyy.gbl.sign.NN and \
                 b.get_sign() == cppyy.gbl.sign.NP:
-            self.cpprep = cppyy.gbl.Mult_MatNN_VecNP(a.cpprep, b.cpprep)
+            self.cpprep = variant("NN_VecNP")
         elif a.get_sign() == cppyy.gbl.sign.NP and \
                 b.get_sign() == cppyy.gbl.sign.NN:
-            self.cpprep = cppyy.gbl.Mult_MatNP_VecNN(a.cpprep, b.cpprep)
+            self.cpprep = variant("NP_VecNN")
         elif a.get_sign() == cppyy.gbl.sign.NN and \
                 b.get_sign() == cppyy.gbl.sign.unknown:
-            self.cpprep = cppyy.gbl.Mult_MatNN_VecU(a.cpprep, b.cpprep)
+            self.cpprep = variant("NN_VecU")
         elif a.get_sign() == cppyy.gbl.sign.NP and \
                 b.get_sign() == cppyy.gbl.sign.unknown:
-            self.cpprep = cppyy.gbl.Mult_MatNP_VecU(a.cpprep, b.cpprep)
+            self.cpprep = variant("NP_VecU")
         elif a.get_sign() == cppyy.gbl.sign.unknown and \
                 b.get_sign() == cppyy.gbl.sign.NN:
-            self.cpprep = cppyy.gbl.Mult_MatU_VecNN(a.cpprep, b.cpprep)
+            self.cpprep = variant("U_VecNN")
         elif a.get_sign() == cppyy.gbl.sign.unknown and \
                 b.get_sign() == cppyy.gbl.sign.NP:
-            self.cpprep = cppyy.gbl.Mult_MatU_VecNP(a.cpprep, b.cpprep)
+            self.cpprep = variant("U_VecNP")
         elif a.get_sign() == cppyy.gbl.sign.unknown and \
                 b.get_sign() == cppyy.gbl.sign.unknown:
-            self.cpprep = cppyy.gbl.Mult_MatU_VecU(a.cpprep, b.cpprep)
+            self.cpprep = variant("U_VecU")
         else:
             raise AssertionError("Operation not supported for given signs: a "
                                  "is " + str(_get_sign_string(a.get_sign()))
@@ -467,6 +476,50 @@ class _ListOfExpressions(expr.Function):
         self.cpprep = cppyy.gbl.List(cppexprlist)
 
 
+class _Rate(expr.Function):
+    """
+    Class for handling the rates of an interference channel,
+    log2(1 + alpha * p / (sigma + beta * p)), as one fused Expression.
+    """
+
+    def __init__(self, alpha: "expr.Parameter", p: "expr.Expression",
+                 beta: "expr.MultiDimParameter", sigma: "expr.Parameter",
+                 kind: str):
+        """
+        Create a Rate-Expression.
+
+        :param alpha: gains of the users (Parameter, NN).
+        :param p: powers of the users (any NN Expression).
+        :param beta: interference gains (MultiDimParameter, NN).
+        :param sigma: noise power (Parameter of dimension 1 or dim(p), NN).
+        :param kind: "PerUser" (the rates), "Sum" (their sum) or
+            "PropFair" (their product).
+        """
+        super().__init__(name="rate", args=[alpha, p, beta, sigma])
+
+        if not isinstance(alpha, expr.Parameter) or \
+                not isinstance(sigma, expr.Parameter) or \
+                not isinstance(beta, expr.MultiDimParameter) or \
+                isinstance(beta, expr.SparseMultiDimParameter):
+            raise TypeError("alpha and sigma have to be constant vectors "
+                            "and beta a dense constant matrix!")
+        if list(beta.get_dim()) != [p.get_dim(), p.get_dim()] or \
+                alpha.get_dim() != p.get_dim() or \
+                sigma.get_dim() not in (1, p.get_dim()):
+            raise AssertionError("Inputs have different dimensions! (alpha:"
+                                 + str(alpha.get_dim()) + ", p:" +
+                                 str(p.get_dim()) + ", beta:" +
+                                 str(beta.get_dim()) + ", sigma:" +
+                                 str(sigma.get_dim()) + ")")
+        if any(e.get_sign() != cppyy.gbl.sign.NN
+               for e in (alpha, p, beta, sigma)):
+            raise AssertionError("The rate can only be used on NN "
+                                 "expressions!")
+        self.cpprep = cppyy.gbl.Rate(alpha.cpprep, p.cpprep, beta.cpprep,
+                                     sigma.cpprep,
+                                     getattr(cppyy.gbl.rate, kind))
+
+
 def _get_sign_string(a):
     if a == 0:
         return "NN"
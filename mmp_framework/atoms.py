@@ -248,6 +248,66 @@ def sum(a: ["expr.Expression", "int", "float", "list", "tuple", "np.ndarray"])\
     return obj
 
 
+def rate(alpha: ["expr.Expression", "int", "float", "list", "tuple",
+                 "np.ndarray"],
+         p: ["expr.Expression", "list", "tuple", "np.ndarray"],
+         beta: ["expr.Expression", "list", "tuple", "np.ndarray"],
+         sigma: ["expr.Expression", "int", "float", "list", "tuple",
+                 "np.ndarray"]) -> "expr.Function":
+    """
+    Atom for the rates of the users of an interference channel,
+    log2(1 + alpha * p / (sigma + beta * p)) (elementwise), i.e., the same as
+    log2(add(1, div(mult(alpha, p), add(sigma, mult(beta, p))))) but
+    evaluated as one fused Expression. The power of user i in the
+    denominator (beta[i][i] * p[i]) is bounded like the numerator.
+
+    :param alpha: gains of the users (constant vector, NN)
+    :param p: powers of the users (NN vector)
+    :param beta: interference gains (constant matrix, NN)
+    :param sigma: noise power (constant scalar or vector, NN)
+    :return: an object of type 'Function'
+    """
+    return _rate(alpha, p, beta, sigma, "PerUser")
+
+
+def sum_rate(alpha: ["expr.Expression", "int", "float", "list", "tuple",
+                     "np.ndarray"],
+             p: ["expr.Expression", "list", "tuple", "np.ndarray"],
+             beta: ["expr.Expression", "list", "tuple", "np.ndarray"],
+             sigma: ["expr.Expression", "int", "float", "list", "tuple",
+                     "np.ndarray"]) -> "expr.Function":
+    """
+    Atom for the sum of the rates, sum(rate(alpha, p, beta, sigma)),
+    computed as log2 of the product of the 1 + SINR.
+
+    :param alpha: gains of the users (constant vector, NN)
+    :param p: powers of the users (NN vector)
+    :param beta: interference gains (constant matrix, NN)
+    :param sigma: noise power (constant scalar or vector, NN)
+    :return: an object of type 'Function'
+    """
+    return _rate(alpha, p, beta, sigma, "Sum")
+
+
+def prop_fair_rate(alpha: ["expr.Expression", "int", "float", "list",
+                           "tuple", "np.ndarray"],
+                   p: ["expr.Expression", "list", "tuple", "np.ndarray"],
+                   beta: ["expr.Expression", "list", "tuple", "np.ndarray"],
+                   sigma: ["expr.Expression", "int", "float", "list",
+                           "tuple", "np.ndarray"]) -> "expr.Function":
+    """
+    Atom for the product of the rates, prod(rate(alpha, p, beta, sigma))
+    (proportional fairness).
+
+    :param alpha: gains of the users (constant vector, NN)
+    :param p: powers of the users (NN vector)
+    :param beta: interference gains (constant matrix, NN)
+    :param sigma: noise power (constant scalar or vector, NN)
+    :return: an object of type 'Function'
+    """
+    return _rate(alpha, p, beta, sigma, "PropFair")
+
+
 """
 -------------------------------------------------------------------------------
 Below are internal/private helper methods to check
@@ -292,6 +352,9 @@ def _check_and_convert_input(a):
     :param a: The given argument
     :return: (potentially converted) given argument
     """
+    # scipy.sparse matrices become sparse matrix parameters
+    if hasattr(a, "tocsr"):
+        return expr.SparseMultiDimParameter(a)
     # Typechecking
     if not isinstance(a, (expr.Expression, int, float, list, tuple,
                           np.ndarray)):
@@ -311,6 +374,29 @@ def _check_and_convert_input(a):
     return a
 
 
+def _rate(alpha, p, beta, sigma, kind: str):
+    """
+    Create the Rate-Expression of the rate atoms.
+
+    :param kind: "PerUser", "Sum" or "PropFair"
+    :return: an object of type 'Function'
+    """
+    alpha = _check_and_convert_input(alpha)
+    p = _check_and_convert_input(p)
+    beta = _check_and_convert_input(beta)
+    sigma = _check_and_convert_input(sigma)
+
+    if isinstance(p, expr.MultiDimParameter) or \
+            isinstance(alpha, expr.MultiDimParameter) or \
+            isinstance(sigma, expr.MultiDimParameter) or \
+            not isinstance(beta, expr.MultiDimParameter):
+        raise TypeError("Invalid argument types for rate(alpha, p, beta, "
+                        "sigma)! (alpha: " + str(type(alpha)) + ", p: "
+                        + str(type(p)) + ", beta: " + str(type(beta))
+                        + ", sigma: " + str(type(sigma)) + ")")
+    return f._Rate(alpha, p, beta, sigma, kind)
+
+
 def _dim(a: ["list", "tuple", "np.ndarray"]):
     """
     Return the Dimensions of a list, tuple, numpy.ndarray.
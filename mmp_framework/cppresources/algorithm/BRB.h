@@ -30,12 +30,18 @@
 #include <cstdio>
 #include <cmath>
 #include <stdexcept>
+#include <string>
 #include <cassert>
 #include <clocale>
 #include <queue>
 #include <memory>
+#include <memory_resource>
+#include <type_traits>
 
 #include "util.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "Observer.h"
 
 using std::cout;
 using std::endl;
@@ -54,6 +60,25 @@ std::ostream& operator<< (std::ostream &out, const std::vector<T>& v)
 }
 
 
+/*
+ * Dimension of BRB and the classes derived from it that is given to the
+ * constructor at runtime instead of as template argument. All dimensions then
+ * share one instantiation of the algorithm (e.g., compiled once by cppyy),
+ * at the price of vectors allocated at runtime instead of std::array. The
+ * bounds of the boxes are allocated from a pool owned by the solver.
+ */
+constexpr size_t DynamicDim = 0;
+
+// std::array<T, Dim>, or Dynamic for DynamicDim
+template <size_t Dim, typename T, typename Dynamic = std::vector<T>>
+using DimVector = std::conditional_t<Dim == DynamicDim, Dynamic, std::array<T, Dim>>;
+
+template <typename T, size_t N>
+void setDim(std::array<T, N>&, size_t) {}
+
+template <typename T, typename Alloc>
+void setDim(std::vector<T, Alloc>& v, size_t n) { v.resize(n); }
+
 template<typename BRB>
 struct compare_RBox
 {
@@ -65,11 +90,11 @@ template <size_t Dim, typename storageT = float>
 class BRB
 {
 	public:
-    using vtype = std::array<double, Dim>;
+    using vtype = DimVector<Dim, double>;
 
     struct PBox
     {
-		using vtype = std::array<storageT, Dim>;
+		using vtype = DimVector<Dim, storageT, std::pmr::vector<storageT>>;
 		vtype lb, ub;
     };
 
@@ -107,7 +132,8 @@ class BRB
     class PType
     {
     public:
-        PType() : len(1) { };
+        // copies of box, their bounds allocated from mr for DynamicDim
+        PType(const PBox& box, std::pmr::memory_resource* mr) : P1(copy(box, mr)), P2{{copy(box, mr), copy(box, mr)}}, len(1) { };
 
         PBox& operator[](const size_t index)
         {
@@ -133,15 +159,39 @@ class BRB
         PBox P1;
         std::array<PBox, 2> P2;
         size_t len;
+
+        static PBox copy(const PBox& box, [[maybe_unused]] std::pmr::memory_resource* mr)
+        {
+            if constexpr (Dim == DynamicDim)
+                return PBox{typename PBox::vtype(box.lb, mr), typename PBox::vtype(box.ub, mr)};
+            else
+                return box;
+        }
     };
 
+    // pool for the box bounds of DynamicDim, kept at a stable address; a copy
+    // of the solver starts with an empty pool of its own
+    class Arena
+    {
     public:
-		BRB();
+        Arena() : pool(std::make_unique<std::pmr::unsynchronized_pool_resource>()) { };
+        Arena(const Arena&) : Arena() { };
+        Arena& operator=(const Arena&) { return *this; }
+
+        std::pmr::memory_resource* get() const { return pool.get(); }
+
+    private:
+        std::unique_ptr<std::pmr::unsynchronized_pool_resource> pool;
+    };
+
+    public:
+		// dim is the number of variables, it must equal Dim unless Dim is DynamicDim
+		explicit BRB(const size_t dim = Dim);
 
 		virtual ~BRB() {};
 
 		// types
-		enum class Status { Optimal, Unsolved, Infeasible };
+		enum class Status { Optimal, Unsolved, Infeasible, Cancelled };
 
 		// parameter setter
 		void setPrecision(const double eta);
@@ -159,6 +209,9 @@ class BRB
 		bool disableReduction;
 		bool useRelTol;
 		bool enablePruning;
+		Observer *observer; // not owned, may be nullptr
+		double observerInterval; // min. seconds between calls to observer->progress()
+		CancellationToken cancellation; // checked once per iteration
 
 		// result
 		vtype xopt;
@@ -170,12 +223,18 @@ class BRB
 		double runtime; // in seconds
 		size_t max_queue_size;
 		const size_t data_size;
+		Profiler profile; // filled by optimize() if profile.enabled
+		Trace trace; // filled by optimize() if trace.enabled
 
 		// run algorithm
 		virtual void optimize(bool startFromXopt = false);
 		virtual void printResult() const;
+		void setProfiling(bool isProfiling) { profile.enabled = isProfiling; }
+		void setTrace(bool isTrace) { trace.enabled = isTrace; }
+		void setObserver(Observer *o, const double interval = 1.0) { observer = o; observerInterval = interval; }
+		void cancel() { cancellation.cancel(); }
 
-		constexpr size_t dim() const { return Dim; }
+		size_t dim() const { return numVars; }
 		double getEpsilon() const { return epsilon; }
 
 	protected:
@@ -187,6 +246,7 @@ class BRB
 
 		// functions
 		void setStatus(const Status s);
+		std::unique_ptr<PBox> makeBox();
 
 		void reduction(RBox& red, const double gamma) const; // false if reduced box is empty
 
@@ -204,12 +264,28 @@ class BRB
 		virtual void checkpoint() const;
 
 		void prune(RType& R);
+
+	private:
+		double topBound(const RType& R) const;
+		void notify(const RType& R, const bool isIncumbent);
+
+		double nextProgress;
+		const size_t numVars;
+		// storage of the box bounds for DynamicDim
+		Arena arena;
 };
 
 
 template <size_t Dim, typename storageT>
-BRB<Dim, storageT>::BRB() : output(true), outputEvery(1e6), disableReduction(false), useRelTol(true), enablePruning(false), data_size((2*Dim+1) * sizeof(storageT)), epsilon(1e-2)
+BRB<Dim, storageT>::BRB(const size_t dim) : output(true), outputEvery(1e6), disableReduction(false), useRelTol(true), enablePruning(false), observer(nullptr), observerInterval(1.0), data_size((2*dim+1) * sizeof(storageT)), epsilon(1e-2), numVars(dim)
 {
+	if (dim == 0 || (Dim != DynamicDim && dim != Dim))
+		throw std::invalid_argument(ERR("invalid dimension " + std::to_string(dim)));
+
+	setDim(xopt, dim);
+	setDim(lb, dim);
+	setDim(ub, dim);
+
 	setStatus(Status::Unsolved);
 	std::setlocale(LC_NUMERIC, "en_US.UTF-8");
 }
@@ -233,6 +309,9 @@ template <size_t Dim, typename storageT>
 void
 BRB<Dim, storageT>::setLB(const vtype& v)
 {
+	if (v.size() != dim())
+		throw std::invalid_argument(ERR("wrong dimension"));
+
 	lb = v;
 	setStatus(Status::Unsolved);
 }
@@ -258,6 +337,9 @@ template <size_t Dim, typename storageT>
 void
 BRB<Dim, storageT>::setUB(const vtype& v)
 {
+	if (v.size() != dim())
+		throw std::invalid_argument(ERR("wrong dimension"));
+
 	ub = v;
 	setStatus(Status::Unsolved);
 }
@@ -294,6 +376,9 @@ BRB<Dim, storageT>::printResult() const
 	cout << "Solution found in iter: " << lastUpdate << endl;
 
 	cout << "Runtime: " << runtime << " sec" << endl;
+
+	if (profile.enabled)
+		profile.print();
 }
 
 inline
@@ -341,7 +426,7 @@ BRB<Dim, storageT>::optimize(bool startFromXopt)
 {
     if (output) {std::cout << "\nIteration  R.size()     opt_val      M.bound  ( difference | lastUpdate)\n";}
 
-	PType P;
+	PType P(*makeBox(), arena.get());
 	RType R;
 	bool doPrune = false;
 
@@ -358,6 +443,9 @@ BRB<Dim, storageT>::optimize(bool startFromXopt)
 	else
 	{
 		tic = clock::now();
+		profile.start();
+		trace.reset();
+		nextProgress = observerInterval;
 		iter = lastUpdate = 0;
 		optval = -std::numeric_limits<double>::infinity();
 	}
@@ -373,33 +461,59 @@ BRB<Dim, storageT>::optimize(bool startFromXopt)
     while (true)
 	{
 		iter++;
+		bool improved = false;
 
 		// step 1: reduce & bound
 		for (size_t i = 0; i < P.size(); i++)
 		{
-			RBox box(pool.get());
+			RBox box(pool.get([this] { return makeBox(); }));
 
 			box.lb() = P[i].lb;
 			box.ub() = P[i].ub;
 
-			bound(box); // set bound
+			{
+				auto s = profile.measure(Profiler::Bound);
+				bound(box); // set bound
+			}
 			const double gamma = calcTolerance(useRelTol, optval, epsilon);
 
-			if (box.bound < gamma || isEmpty(box)) {
+			if (box.bound < gamma) {
 				pool.put(box.move_data());
 				continue; // skip boxes containing no feasible points
 			}
 
+			{
+				auto s = profile.measure(Profiler::IsEmpty);
+				if (isEmpty(box)) {
+					pool.put(box.move_data());
+					continue; // skip boxes containing no feasible points
+				}
+			}
+
 			if (!disableReduction)
 			{
-				reduction(box, gamma); // update lb, ub
+				{
+					auto s = profile.measure(Profiler::Reduction);
+					reduction(box, gamma); // update lb, ub
+				}
+				auto s = profile.measure(Profiler::Bound);
 				bound(box); // TODO calculating bound twice!
 			}
 
 			// step 2: update CBV, update R
-			if (feasible(box))
+			bool isFeasible;
 			{
-				double tmp = obj(box);
+				auto s = profile.measure(Profiler::Feasible);
+				isFeasible = feasible(box);
+			}
+
+			if (isFeasible)
+			{
+				double tmp;
+				{
+					auto s = profile.measure(Profiler::Obj);
+					tmp = obj(box);
+				}
 
 				if (tmp > optval)
 				{
@@ -409,12 +523,18 @@ BRB<Dim, storageT>::optimize(bool startFromXopt)
 
 					doPrune = enablePruning;
 					lastUpdate = iter;
+					improved = true;
 				}
 			}
 
+			auto s = profile.measure(Profiler::Push);
 			R.push(std::move(box));
 		}
 
+		// after all new boxes are queued, so that the bound covers them
+		if (observer && improved)
+			notify(R, true);
+
 		if (doPrune && iter - lastUpdate > 10000)
 		{
 			doPrune = false;
@@ -425,6 +545,12 @@ BRB<Dim, storageT>::optimize(bool startFromXopt)
 		}
 
 		// step 3: terminate
+		if (cancellation.cancelled())
+		{
+			setStatus(Status::Cancelled);
+			break;
+		}
+
 #ifdef FIFO
 		if (R.empty())
 #else
@@ -450,30 +576,64 @@ BRB<Dim, storageT>::optimize(bool startFromXopt)
 			if (output && iter % outputEvery == 0)
 				std::printf("%8llu  %8llu  %11g  %11g  (%11g | %8llu) | Peak RSS: %g\n", iter, static_cast<unsigned long long>(R.size()), optval, M.bound, (M.bound - optval), lastUpdate, (double)getPeakRSS()/(double)1000000000);
 
+			if (trace.enabled)
+			{
+				const double t = std::chrono::duration<double>(clock::now() - tic).count();
+
+				if (trace.due(t))
+					trace.record({t, iter, R.size(), optval, M.bound, (double)getPeakRSS()/(double)1000000000});
+			}
 
-			vtype tmp;
-			std::transform(M.ub().begin(), M.ub().end(), M.lb().begin(), tmp.begin(), [] (double x, double y) { return x-y; });
-			auto max = std::max_element(tmp.begin(), tmp.end());
-			size_t jk = std::distance(tmp.begin(), max);
+			if (observer && std::chrono::duration<double>(clock::now() - tic).count() >= nextProgress)
+				notify(R, false);
 
-			auto vk = M.lb(jk) + static_cast<double>(*max) / 2;
 
-			P.use2();
+			{
+				auto s = profile.measure(Profiler::Branch);
 
-			P[0].lb = M.lb();
-			P[0].ub = M.ub();
-			P[0].ub[jk] = vk;
+				// longest edge, the first one if there are several
+				size_t jk = 0;
+				double max = static_cast<double>(M.ub(0)) - M.lb(0);
+				for (size_t i = 1; i < dim(); ++i)
+				{
+					const double d = static_cast<double>(M.ub(i)) - M.lb(i);
+					if (d > max)
+					{
+						max = d;
+						jk = i;
+					}
+				}
 
-			P[1].lb = M.lb();
-			P[1].lb[jk] = vk;
-			P[1].ub = M.ub();
+				auto vk = M.lb(jk) + max / 2;
 
+				P.use2();
+
+				P[0].lb = M.lb();
+				P[0].ub = M.ub();
+				P[0].ub[jk] = vk;
+
+				P[1].lb = M.lb();
+				P[1].lb[jk] = vk;
+				P[1].ub = M.ub();
+			}
+
+			auto s = profile.measure(Profiler::Pop);
 			pool.put(const_cast<RBox&>(M).move_data());
 			R.pop();
 		}
 	}
 
 	runtime = std::chrono::duration<double>(clock::now() - tic).count();
+	profile.stop();
+
+	if (trace.enabled)
+		trace.record({runtime, iter, R.size(), optval, topBound(R), (double)getPeakRSS()/(double)1000000000});
+
+	if (observer)
+		notify(R, false);
+
+	cancellation.reset();
+
 	max_queue_size = pool.size() + R.size();
 
 	if (output)
@@ -489,14 +649,14 @@ void
 BRB<Dim, storageT>::reduction(RBox& red, const double gamma) const
 {
 	// compute red.lb
-	for (size_t i = 0; i < Dim; ++i)
+	for (size_t i = 0; i < dim(); ++i)
 	{
 		const double alpha = red_alpha(i, gamma, red);
 		red.lb(i) = red.ub(i) - alpha * (red.ub(i) - red.lb(i));
 	}
 
 	// compute red.ub
-	for (size_t i = 0; i < Dim; ++i)
+	for (size_t i = 0; i < dim(); ++i)
 	{
 		const double beta = red_beta(i, gamma, red);
 		red.ub(i) = red.lb(i) + beta * (red.ub(i) - red.lb(i));
@@ -522,6 +682,53 @@ BRB<Dim, storageT>::setStatus(const Status s)
 		case Status::Infeasible:
 			statusStr = "Infeasible";
 			break;
+
+		case Status::Cancelled:
+			statusStr = "Cancelled";
+			break;
+	}
+}
+
+template <size_t Dim, typename storageT>
+std::unique_ptr<typename BRB<Dim, storageT>::PBox>
+BRB<Dim, storageT>::makeBox()
+{
+	if constexpr (Dim == DynamicDim)
+	{
+		using vtypeS = typename PBox::vtype;
+		return std::make_unique<PBox>(PBox{vtypeS(numVars, arena.get()), vtypeS(numVars, arena.get())});
+	}
+	else
+		return std::make_unique<PBox>();
+}
+
+template <size_t Dim, typename storageT>
+double
+BRB<Dim, storageT>::topBound(const RType& R) const
+{
+	if (R.empty())
+		return optval;
+
+#ifdef FIFO
+	return R.front().bound;
+#else
+	return R.top().bound;
+#endif
+}
+
+template <size_t Dim, typename storageT>
+void
+BRB<Dim, storageT>::notify(const RType& R, const bool isIncumbent)
+{
+	const double t = std::chrono::duration<double>(clock::now() - tic).count();
+	const Progress p {t, iter, R.size(), optval, topBound(R), get_xopt()};
+
+	if (isIncumbent)
+		observer->incumbent(p);
+	else
+	{
+		observer->progress(p);
+		nextProgress = t + observerInterval;
 	}
 }
 
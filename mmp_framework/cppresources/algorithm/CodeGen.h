@@ -0,0 +1,281 @@
+#ifndef _MMP_CODEGEN_
+#define _MMP_CODEGEN_
+
+#include <algorithm>
+#include <cmath>
+#include <ios>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "MMP.h"
+#include "../expressiontree/Function.h"
+#include "../expressiontree/Expression.h"
+#include "../expressiontree/Constraint.h"
+#include "../expressiontree/Model.h"
+#include "../expressiontree/Tape.h"
+
+/*
+ * Code generator for problem specific MMP classes.
+ *
+ * generateMMP() and generateMMPconstraints() return the C++ source of a class
+ * derived from MMP<Dim> resp. MMPconstraints<Dim> that evaluates the
+ * objective (and the constraints) of the given expression trees as straight
+ * line code, i.e., the same kind of class as the hand written problems in
+ * the original framework. The source is meant to be JIT-compiled with
+ * cppyy.cppdef() and has the same interface as OptimizationProblem resp.
+ * OptimizationProblemWithConstraints; its constructor takes the objective
+ * (for printObjective()).
+ *
+ * The code is derived from the Tape of the trees, simplified in a Model (see
+ * rewrite()): every instruction becomes one call of Tape::apply() with a
+ * compile time constant Instruction, the parameters become a static constexpr
+ * array and the intermediate results live on the stack, or for more than
+ * Emitter::maxStack values in a member allocated with the object (the
+ * results grow with K^2 for K users and would overflow the stack of solver
+ * threads). Thereby the compiler sees all dimensions, sign variants and
+ * parameter values and can unroll and inline everything.
+ */
+namespace codegen
+{
+
+class Emitter
+{
+	public:
+		// number of results (incl. x and y) kept in an array on the stack
+		static constexpr size_t maxStack = 4096;
+
+		Emitter(const Tape& tape) : tape(tape)
+		{
+			const size_t size = tape.getBufferSize();
+			const size_t dimX = tape.getVariableDim();
+
+			// classify the buffer: x|y and results go to v[], constants to c[]
+			std::vector<bool> isResult(size, false);
+			for (size_t i = 0; i < 2*dimX; ++i)
+				isResult[i] = true;
+			for (const auto& ins : tape.getInstructions())
+				for (uint32_t i = 0; i < ins.dim; ++i)
+					isResult[ins.out + i] = true;
+
+			index.resize(size);
+			inV = isResult;
+			for (size_t i = 0; i < size; ++i)
+			{
+				if (isResult[i])
+					index[i] = nv++;
+				else
+				{
+					index[i] = constants.size();
+					constants.push_back(tape.getConstant(i));
+				}
+			}
+		}
+
+		// body of a function evaluating the tape for (x,y), leaves the results in v[]
+		// (the member buffer if they do not fit on the stack, see member())
+		void body(std::ostream& os, const std::string& indent, const std::string& buffer) const
+		{
+			const size_t dimX = tape.getVariableDim();
+
+			os << indent << "static constexpr double c[] = {";
+			if (constants.empty())
+				os << "0.0";
+			for (size_t i = 0; i < constants.size(); ++i)
+				os << (i ? ", " : "") << literal(constants[i]);
+			os << "};\n";
+
+			if (nv <= maxStack)
+				os << indent << "double v[" << nv << "];\n";
+			else
+			{
+				os << indent << "double* const v = " << buffer << ".data();\n";
+			}
+			os << indent << "std::copy(x.begin(), x.end(), v);\n";
+			os << indent << "std::copy(y.begin(), y.end(), v + " << dimX << ");\n";
+
+			const auto& args = tape.getListArgs();
+			for (const auto& ins : tape.getInstructions())
+			{
+				if (ins.op == Tape::List)
+				{
+					for (uint32_t i = 0; i < ins.dim; ++i)
+						os << indent << value(ins.out + i) << " = " << value(args[ins.aux + i]) << ";\n";
+					continue;
+				}
+
+				// the offsets are not read by apply(), the operands are passed as pointers
+				os << indent << "{ static constexpr Tape::Instruction ins{Tape::" << opEnum(ins.op)
+				   << ", " << signName(ins.sa) << ", " << signName(ins.sb)
+				   << ", " << ins.dim << ", " << ins.n << ", 0, 0, 0, 0, 0, " << ins.aux << "};\n"
+				   << indent << "  Tape::apply(ins, " << pointer(ins.out) << ", " << pointer(ins.a) << ", " << pointer(ins.as)
+				   << ", " << pointer(ins.b) << ", " << pointer(ins.bs) << "); } // " << Tape::opName(ins.op) << "\n";
+			}
+		}
+
+		// declaration of the member buffer used by body(), if any
+		void member(std::ostream& os, const std::string& indent, const std::string& buffer) const
+		{
+			if (nv > maxStack)
+				os << indent << "mutable std::vector<double> " << buffer << " = std::vector<double>(" << nv << ");\n";
+		}
+
+		// expression for element o of the buffer
+		std::string value(uint32_t o) const
+		{
+			return (inV[o] ? "v[" : "c[") + std::to_string(index[o]) + "]";
+		}
+
+		// expression for a pointer to element o of the buffer (unused operands point to v)
+		std::string pointer(uint32_t o) const
+		{
+			if (o == Tape::none)
+				return "v";
+			return (inV[o] ? "v + " : "c + ") + std::to_string(index[o]);
+		}
+
+		static std::string literal(double d)
+		{
+			if (std::isnan(d))
+				return "std::numeric_limits<double>::quiet_NaN()";
+			if (std::isinf(d))
+				return d > 0 ? "std::numeric_limits<double>::infinity()" : "-std::numeric_limits<double>::infinity()";
+
+			// exact round trip
+			std::ostringstream os;
+			os << std::hexfloat << d;
+			return os.str();
+		}
+
+		static const char* signName(sign s)
+		{
+			switch (s)
+			{
+				case NN: return "NN";
+				case NP: return "NP";
+				default: return "unknown";
+			}
+		}
+
+		static const char* opEnum(Tape::Op op)
+		{
+			static const char* names[] = {"AddVecVec", "AddVecScalar", "MultVecVec", "MultVecScalar", "MultMatVec", "MultSpMatVec",
+			                              "DivVecVec", "DivVecScalar", "DivScalarVec", "Dot", "Inv", "Log2", "LogN",
+			                              "Neg", "Prod", "Sum", "List", "Rate", "Affine"};
+			return names[op];
+		}
+
+	private:
+		const Tape& tape;
+		std::vector<bool> inV;
+		std::vector<size_t> index;
+		std::vector<double> constants;
+		size_t nv = 0;
+};
+
+inline void header(std::ostream& os, const std::string& className, const std::string& base, size_t dim, size_t size)
+{
+	os << "class " << className << " : public " << base << "<" << dim << ">\n"
+	   << "{\n"
+	   << "\tusing typename " << base << "<" << dim << ">::vtypeS;\n"
+	   << "\tusing typename " << base << "<" << dim << ">::RBox;\n\n"
+	   << "\tpublic:\n"
+	   << "\t\t" << className << "(Function* obj) : " << base << "<" << dim << ">(), useTape(true), m_root(obj) {}\n\n"
+	   << "\t\tvoid printObjective() {m_root->printFunction();}\n"
+	   << "\t\tvoid printTape() const {std::cout << \"" << className << ": " << size << " compiled instructions\\n\";}\n\n"
+	   << "\t\t// no effect, the generated code is always used\n"
+	   << "\t\tbool useTape;\n"
+	   << "\t\tvoid setTapeCache(size_t) {}\n"
+	   << "\t\tvoid setOutwardRounding(bool on) {if (on) throw std::logic_error(\"" << className << ": no outward rounding in generated code\");}\n"
+	   << "\t\tvoid setIntervalBounds(bool on) {if (on) throw std::logic_error(\"" << className << ": no interval bounds in generated code\");}\n\n"
+	   << "\tprivate:\n"
+	   << "\t\tFunction* m_root;\n\n";
+}
+
+inline void objective(std::ostream& os, const Tape& tape)
+{
+	Emitter e(tape);
+	os << "\t\tdouble MMPobj(const vtypeS& x, const vtypeS& y) const override\n"
+	   << "\t\t{\n";
+	e.body(os, "\t\t\t", "m_objBuffer");
+	os << "\t\t\treturn " << e.value(tape.getOffset()) << ";\n"
+	   << "\t\t}\n";
+	e.member(os, "\t\t", "m_objBuffer");
+}
+
+inline void checkDim(const Tape& tape, size_t dim)
+{
+	if (tape.getVariableDim() != 0 && tape.getVariableDim() != dim)
+		throw std::invalid_argument("codegen: dimension of the variable does not match");
+}
+
+} // namespace codegen
+
+// source of class className : public MMP<dim> maximizing obj
+inline std::string generateMMP(const std::string& className, Function* obj, size_t dim)
+{
+	Model model({obj});
+	Tape tape(model.get(obj));
+	codegen::checkDim(tape, dim);
+
+	std::ostringstream os;
+	codegen::header(os, className, "MMP", dim, tape.size());
+	codegen::objective(os, tape);
+	os << "};\n";
+	return os.str();
+}
+
+// source of class className : public MMPconstraints<dim> maximizing obj subject to constraints
+inline std::string generateMMPconstraints(const std::string& className, Function* obj, const std::vector<Constraint*>& constraints, size_t dim)
+{
+	std::vector<Expression*> roots;
+	for (auto c : constraints)
+		roots.push_back(c->getConstraint());
+	std::vector<Expression*> all(roots);
+	all.push_back(obj);
+	Model model(all);
+
+	Tape tape(model.get(obj));
+	codegen::checkDim(tape, dim);
+
+	for (auto& r : roots)
+		r = model.get(r);
+	Tape constraintTape(roots);
+	codegen::checkDim(constraintTape, dim);
+
+	std::ostringstream os;
+	codegen::header(os, className, "MMPconstraints", dim, tape.size() + constraintTape.size());
+	codegen::objective(os, tape);
+
+	// same checks as Constraint::fulfilled()
+	codegen::Emitter e(constraintTape);
+	os << "\n\t\tbool constraints(const vtypeS& x, const vtypeS& y) const override\n"
+	   << "\t\t{\n";
+	e.body(os, "\t\t\t", "m_constraintBuffer");
+	for (size_t i = 0; i < constraints.size(); ++i)
+	{
+		const char* violated;
+		if (dynamic_cast<InequalityConstraint*>(constraints[i]))
+			violated = " == 0";
+		else if (dynamic_cast<GTOEConstraint*>(constraints[i]))
+			violated = " > 0";
+		else if (dynamic_cast<LTOEConstraint*>(constraints[i]))
+			violated = " < 0";
+		else
+			throw std::invalid_argument("codegen: unknown constraint type");
+
+		for (int j = 0; j < constraintTape.getDim(i); ++j)
+			os << "\t\t\tif (" << e.value(constraintTape.getOffset(i) + j) << violated << ") return false;\n";
+	}
+	os << "\t\t\treturn true;\n"
+	   << "\t\t}\n";
+	e.member(os, "\t\t", "m_constraintBuffer");
+	os << "\n"
+	   << "\t\tvtypeS feasiblePoint(const RBox& r) const override\n"
+	   << "\t\t\t{ return r.lb(); }\n"
+	   << "};\n";
+	return os.str();
+}
+
+#endif
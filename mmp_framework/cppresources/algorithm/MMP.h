@@ -24,6 +24,8 @@
 #include <functional>
 #include "BRB.h"
 
+enum class RootFinder { Bisection, Illinois };
+
 template <size_t Dim>
 class _MMPbase : public BRB<Dim>
 {
@@ -34,11 +36,23 @@ class _MMPbase : public BRB<Dim>
 	    using BRB<Dim>::disableReduction;
 		using vtypeS = typename PBox::vtype;
 
-		_MMPbase() : BRB<Dim>() { disableReduction = true; }
+		explicit _MMPbase(const size_t dim = Dim) : BRB<Dim>(dim), rootFinder(RootFinder::Illinois), reductionTol(1e-1), useIntervals(false) { disableReduction = true; }
+
+		// reduction parameter
+		RootFinder rootFinder;
+		double reductionTol; // width of the final bracket in zero()
+
+		// bound boxes by the minimum of the MMP bound and intervalObj()
+		bool useIntervals;
 
 	protected:
 		virtual double MMPobj(const vtypeS& x, const vtypeS& y) const =0;
 
+		// Upper bound of the objective on the box [lb, ub] by other means than MMPobj(), e.g., interval
+		// arithmetic. Only used with useIntervals, +inf (or nan) if there is none.
+		virtual double intervalObj(const vtypeS&, const vtypeS&) const
+			{ return std::numeric_limits<double>::infinity(); }
+
 		// Return true, if feasible point is known. if feasible() == true, feasiblePoint() returns a feasible point.
 		//bool feasible(const RBox& r) const override =0;
 		//const vtype& feasiblePoint(const RBox& r) const override =0;
@@ -47,7 +61,15 @@ class _MMPbase : public BRB<Dim>
 		//bool isEmpty(const PBox& r) const override =0;
 
 		void bound(RBox& r) const override final
-			{ r.bound = MMPobj(r.ub(), r.lb()); }
+		{
+			r.bound = MMPobj(r.ub(), r.lb());
+			if (useIntervals)
+			{
+				const double b = intervalObj(r.lb(), r.ub());
+				if (b < r.bound)
+					r.bound = b;
+			}
+		}
 
 		double obj(const RBox& r) const override final
 			{ auto p = this->feasiblePoint(r); return MMPobj(p, p); }
@@ -120,28 +142,71 @@ class MMPconstraints : public _MMPbase<Dim>
 		double red_beta(const size_t i, const double gamma, const RBox& box) const override;
 };
 
-template <class UnaryPredicate>
+/*
+ * Bracketed root finder used by the reduction.
+ *
+ * res(t) is nonincreasing on [0, 1] and t is feasible iff res(t) >= 0. The
+ * caller supplies res0, its (upper estimate of the) value at t = 0, so that
+ * evaluation is not repeated here. The returned value is the smallest t known
+ * to be infeasible (or 1 if t = 1 is feasible), i.e., the result is
+ * conservative in the same way as plain bisection. Iteration stops as soon as
+ * the bracket is narrower than tol.
+ *
+ * RootFinder::Illinois uses the modified regula falsi (Illinois) step and
+ * falls back to bisection whenever the bracket values are not finite (e.g.,
+ * violated constraints) or the bracket fails to shrink fast enough.
+ */
+template <class Residual>
 double
-zero(UnaryPredicate feas)
+zero(Residual res, const double res0, const double tol = 1e-1, const RootFinder method = RootFinder::Illinois)
 {
-	const double tol = 1e-1;
-	double beta;
-	double beta_min = 0;
-	double beta_max = 1;
-	bool ret;
+	double a = 0, ra = res0; // feasible end
+	double b = 1, rb = res(b); // infeasible end
+
+	if (rb >= 0)
+		return 1;
 
-	while (beta_max - beta_min > tol)
+	int side = 0; // end retained in the last step: -1 = a, +1 = b
+	int slow = 0; // consecutive steps without halving the bracket
+
+	while (b - a > tol)
 	{
-		beta = (beta_max + beta_min) / 2;
-		ret = feas(beta);
+		double c = (a + b) / 2;
+		const double width = b - a;
+
+		if (method == RootFinder::Illinois && slow < 2 && std::isfinite(ra) && std::isfinite(rb) && ra > rb)
+		{
+			const double t = a + width * ra / (ra - rb);
+
+			if (t > a && t < b) // false for NaN
+				c = t;
+		}
+
+		const double rc = res(c);
+
+		if (rc >= 0)
+		{
+			a = c;
+			ra = rc;
 
-		if (ret)
-			beta_min = beta;
+			if (side == 1)
+				rb /= 2;
+			side = 1;
+		}
 		else
-			beta_max = beta;
+		{
+			b = c;
+			rb = rc;
+
+			if (side == -1)
+				ra /= 2;
+			side = -1;
+		}
+
+		slow = (b - a > width / 2) ? slow + 1 : 0;
 	}
 
-	return beta_max;
+	return b;
 }
 
 
@@ -153,8 +218,8 @@ MMP<Dim>::red_alpha(const size_t i, const double gamma, const RBox& box) const
 		{
 			vtypeS p(box.ub());
 			p[i] -= alpha * (static_cast<double>(box.ub(i)) - static_cast<double>(box.lb(i)));
-			return this->MMPobj(p, box.lb()) >= gamma;
-		});
+			return this->MMPobj(p, box.lb()) - gamma;
+		}, box.bound - gamma, this->reductionTol, this->rootFinder);
 }
 
 
@@ -166,8 +231,8 @@ MMP<Dim>::red_beta(const size_t i, const double gamma, const RBox& box) const
 		{
 			vtypeS p(box.lb());
 			p[i] += beta * (static_cast<double>(box.ub(i))- static_cast<double>(box.lb(i)));
-			return this->MMPobj(box.ub(), p) >= gamma;
-		});
+			return this->MMPobj(box.ub(), p) - gamma;
+		}, box.bound - gamma, this->reductionTol, this->rootFinder);
 }
 
 template <size_t Dim>
@@ -178,8 +243,9 @@ MMPconstraints<Dim>::red_alpha(const size_t i, const double gamma, const RBox& b
 		{
 			vtypeS p(box.ub());
 			p[i] -= alpha * (static_cast<double>(box.ub(i)) - static_cast<double>(box.lb(i)));
-			return this->MMPobj(p, box.lb()) >= gamma && constraints(box.lb(), p);
-		});
+			const double r = this->MMPobj(p, box.lb()) - gamma;
+			return (r < 0 || constraints(box.lb(), p)) ? r : -std::numeric_limits<double>::infinity();
+		}, box.bound - gamma, this->reductionTol, this->rootFinder);
 }
 
 template <size_t Dim>
@@ -190,8 +256,9 @@ MMPconstraints<Dim>::red_beta(const size_t i, const double gamma, const RBox& bo
 		{
 			vtypeS p(box.lb());
 			p[i] += beta * (static_cast<double>(box.ub(i)) - static_cast<double>(box.lb(i)));
-			return this->MMPobj(box.ub(), p) >= gamma && constraints(p, box.ub());
-		});
+			const double r = this->MMPobj(box.ub(), p) - gamma;
+			return (r < 0 || constraints(p, box.ub())) ? r : -std::numeric_limits<double>::infinity();
+		}, box.bound - gamma, this->reductionTol, this->rootFinder);
 }
 
 #endif
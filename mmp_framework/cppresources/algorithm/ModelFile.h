@@ -0,0 +1,197 @@
+#ifndef _MMP_MODELFILE_
+#define _MMP_MODELFILE_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#if defined(_WIN32)
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "../expressiontree/Constraint.h"
+#include "../expressiontree/Tape.h"
+#include "../expressiontree/util/Binary.h"
+
+/*
+ * Binary file of a compiled problem, written by save() of OptimizationProblem
+ * resp. OptimizationProblemWithConstraints and loaded by their constructors
+ * taking a ModelFile.
+ *
+ * The file holds the dimension, the box bounds, the type of every constraint
+ * and the Tapes of the objective and the constraints (instructions with their
+ * sign variants, parameters and all other constants), only offsets and no
+ * pointers. It is mapped into memory read-only and the constants are used in
+ * place, so processes loading the same file share them and loading costs
+ * neither building the expression trees nor compiling them.
+ *
+ * Layout (arrays aligned to 8 bytes, see util/Binary.h):
+ *   "MMPMODEL" | version, byte order mark, Tape::formatVersion, dimension,
+ *   number of constraints | lb | ub | constraint types | objective Tape |
+ *   constraint Tape (if there are constraints)
+ */
+class ModelFile
+{
+	public:
+		// incremented on every incompatible change of the layout
+		static constexpr uint64_t version = 1;
+
+		explicit ModelFile(const std::string& file)
+		{
+			map(file);
+			binary::Reader in(m_data.get(), m_size);
+
+			if (std::memcmp(in.view<char>(8), magic, 8) != 0)
+				throw std::runtime_error("ModelFile: " + file + " is no model file");
+			uint64_t header[5];
+			in.read(header, 5);
+			if (header[0] != version || header[2] != Tape::formatVersion)
+				throw std::runtime_error("ModelFile: " + file + " has an unsupported version");
+			if (header[1] != byteOrderMark)
+				throw std::runtime_error("ModelFile: " + file + " was written on a platform of different byte order");
+
+			// lb and ub, checked before they are allocated
+			if (header[3] > in.remaining() / (2 * sizeof(double)))
+				throw std::runtime_error("ModelFile: inconsistent model file");
+			m_dim = header[3];
+			m_lb.resize(m_dim);
+			m_ub.resize(m_dim);
+			in.read(m_lb.data(), m_dim);
+			in.read(m_ub.data(), m_dim);
+
+			const uint8_t* types = in.view<uint8_t>(header[4]);
+			for (size_t i = 0; i < header[4]; ++i)
+			{
+				if (types[i] > LTOE)
+					throw std::runtime_error("ModelFile: invalid constraint type in " + file);
+				m_types.push_back(static_cast<ConstraintType>(types[i]));
+			}
+
+			m_objective = Tape::read(in, m_data);
+			if (!m_types.empty())
+				m_constraints = Tape::read(in, m_data);
+			check(m_objective, 1);
+			check(m_constraints, m_types.size());
+		}
+
+		// Write the problem (Tapes compiled for dimension lb.size()), an existing file is replaced atomically
+		static void write(const std::string& file, const std::vector<double>& lb, const std::vector<double>& ub,
+		                  const std::vector<ConstraintType>& types, const Tape& objective, const Tape& constraints)
+		{
+			if (lb.size() != ub.size())
+				throw std::invalid_argument("ModelFile: bounds of different dimension");
+
+			// processes that mapped the old file keep it; the temporary file has a name of its own, so
+			// processes writing the same file at the same time do not write into each other's
+			std::string tmp = file + ".XXXXXX";
+			const int fd = mkstemp(&tmp[0]);
+			if (fd < 0)
+				throw std::runtime_error("ModelFile: can not write " + tmp);
+			// the permissions std::ofstream would create the file with, mkstemp() allows the owner only
+			const mode_t mask = umask(0);
+			umask(mask);
+			fchmod(fd, 0666 & ~mask);
+			close(fd);
+
+			try
+			{
+				std::ofstream os(tmp, std::ios::binary | std::ios::trunc);
+				if (!os)
+					throw std::runtime_error("ModelFile: can not write " + tmp);
+				binary::Writer out(os);
+
+				out.write(magic, 8);
+				const uint64_t header[] = {version, byteOrderMark, Tape::formatVersion, lb.size(), types.size()};
+				out.write(header, 5);
+				out.write(lb.data(), lb.size());
+				out.write(ub.data(), ub.size());
+				const std::vector<uint8_t> t(types.begin(), types.end());
+				out.write(t.data(), t.size());
+
+				objective.write(out);
+				if (!types.empty())
+					constraints.write(out);
+
+				os.close();
+				if (!os)
+					throw std::runtime_error("ModelFile: can not write " + tmp);
+				if (std::rename(tmp.c_str(), file.c_str()) != 0)
+					throw std::runtime_error("ModelFile: can not write " + file);
+			}
+			catch (...)
+			{
+				std::remove(tmp.c_str());
+				throw;
+			}
+		}
+
+		size_t getDim() const { return m_dim; }
+		size_t getNumConstraints() const { return m_types.size(); }
+		const std::vector<double>& getLB() const { return m_lb; }
+		const std::vector<double>& getUB() const { return m_ub; }
+		const std::vector<ConstraintType>& getConstraintTypes() const { return m_types; }
+		// the Tapes share the constants in the mapped file, which stays mapped as long as they exist
+		const Tape& getObjective() const { return m_objective; }
+		const Tape& getConstraints() const { return m_constraints; }
+
+	private:
+		static constexpr char magic[8] = {'M', 'M', 'P', 'M', 'O', 'D', 'E', 'L'};
+		static constexpr uint64_t byteOrderMark = 0x0102030405060708;
+
+		std::shared_ptr<const char> m_data;
+		size_t m_size = 0;
+		size_t m_dim = 0;
+		std::vector<double> m_lb, m_ub;
+		std::vector<ConstraintType> m_types;
+		Tape m_objective, m_constraints;
+
+		void check(const Tape& tape, size_t roots) const
+		{
+			if (tape.getNumRoots() != roots || (tape.getVariableDim() != 0 && tape.getVariableDim() != m_dim))
+				throw std::runtime_error("ModelFile: inconsistent model file");
+		}
+
+		void map(const std::string& file)
+		{
+#if defined(_WIN32)
+			// no sharing, the file is read into memory
+			std::ifstream is(file, std::ios::binary);
+			if (!is)
+				throw std::runtime_error("ModelFile: can not open " + file);
+			std::vector<char> content((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+			m_size = content.size();
+			std::shared_ptr<char> data(new char[m_size + 1], std::default_delete<char[]>());
+			std::copy(content.begin(), content.end(), data.get());
+			m_data = data;
+#else
+			const int fd = ::open(file.c_str(), O_RDONLY);
+			if (fd < 0)
+				throw std::runtime_error("ModelFile: can not open " + file);
+			struct stat st;
+			if (::fstat(fd, &st) != 0 || st.st_size == 0)
+			{
+				::close(fd);
+				throw std::runtime_error("ModelFile: " + file + " is no model file");
+			}
+			m_size = st.st_size;
+			void* p = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+			::close(fd);
+			if (p == MAP_FAILED)
+				throw std::runtime_error("ModelFile: can not map " + file);
+
+			const size_t size = m_size;
+			m_data = std::shared_ptr<const char>(static_cast<const char*>(p), [size](const char* d) { ::munmap(const_cast<char*>(d), size); });
+#endif
+		}
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef _OBSERVER_H
+#define _OBSERVER_H
+
+#include <vector>
+#include <atomic>
+
+// Snapshot of the solver state handed to an Observer
+struct Progress
+{
+	double time; // seconds since start of optimize()
+	unsigned long long iter;
+	unsigned long long queueSize;
+	double optval;
+	double bound; // bound of the best box in the queue (or optval if empty)
+	std::vector<double> xopt;
+};
+
+/*
+ * Callback interface for BRB::optimize(). incumbent() is called in every
+ * iteration in which the best known solution improves, once the boxes of the
+ * iteration are queued, progress() at most once every
+ * BRB::observerInterval seconds. Both are called from the solver thread.
+ */
+class Observer
+{
+	public:
+		virtual ~Observer() {};
+
+		virtual void incumbent(const Progress&) {};
+		virtual void progress(const Progress&) {};
+};
+
+/*
+ * Cooperative cancellation. cancel() may be called from any thread (or from
+ * an Observer); the solver checks the flag once per iteration and stops with
+ * status Cancelled, keeping the best solution found so far. A cancel before
+ * optimize() stops it after the first iteration, the flag is cleared when
+ * optimize() returns. Copies start with a cleared flag, a pending cancel
+ * belongs to the solver it was requested for.
+ */
+class CancellationToken
+{
+	public:
+		CancellationToken() : flag(false) {}
+		CancellationToken(const CancellationToken&) : flag(false) {}
+		CancellationToken& operator=(const CancellationToken&) { reset(); return *this; }
+
+		void cancel() { flag.store(true, std::memory_order_relaxed); }
+		void reset() { flag.store(false, std::memory_order_relaxed); }
+		bool cancelled() const { return flag.load(std::memory_order_relaxed); }
+
+	private:
+		std::atomic<bool> flag;
+};
+
+#endif
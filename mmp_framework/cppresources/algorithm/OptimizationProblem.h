@@ -8,8 +8,11 @@
 #include <algorithm>
 #include <iostream>
 #include "MMP.h"
+#include "ModelFile.h"
 #include "../expressiontree/Function.h"
 #include "../expressiontree/Expression.h"
+#include "../expressiontree/Model.h"
+#include "../expressiontree/Tape.h"
 
 template <size_t Dim, bool propFair = false>
 class OptimizationProblem : public MMP<Dim>
@@ -17,41 +20,97 @@ class OptimizationProblem : public MMP<Dim>
 	using typename MMP<Dim>::vtypeS;
 
 	public:
-	    // Konstruktor
-		OptimizationProblem(Function* obj) : MMP<Dim>() {
-		    //m_contiguousContainer = get_variant_vector(obj);
-		    //m_root = getBasePointer(m_contiguousContainer.back());
-		    m_root = obj;
+	    // Konstruktor, dim ist nur für Dim == DynamicDim anzugeben
+		OptimizationProblem(Function* obj, const size_t dim = Dim) : MMP<Dim>(dim), useTape(true), m_model(std::vector<Expression*>{obj}), m_root(m_model.get(obj)), m_tape(m_root), m_x(dim), m_y(dim) {
+		    if (m_tape.getVariableDim() != 0 && m_tape.getVariableDim() != dim) {
+		        throw std::invalid_argument("OptimizationProblem: dimension of the variable does not match");
+		    }
+		    m_objectiveExprs = m_root->get_expression_list();
+		};
+		// Problem written by save(), without expression tree (always evaluates the Tape)
+		explicit OptimizationProblem(const ModelFile& file) : MMP<Dim>(file.getDim()), useTape(true), m_root(nullptr), m_tape(file.getObjective()), m_x(file.getDim()), m_y(file.getDim()) {
+		    if (file.getNumConstraints() != 0) {
+		        throw std::invalid_argument("OptimizationProblem: model file of a different problem type");
+		    }
+		    for (size_t i = 0; i < file.getDim(); ++i) {
+		        this->setLB(i, file.getLB()[i]);
+		        this->setUB(i, file.getUB()[i]);
+		    }
+		};
+
+		// Write the compiled objective and the bounds, see ModelFile
+		void save(const std::string& file) const {
+		    ModelFile::write(file, std::vector<double>(this->lb.begin(), this->lb.end()), std::vector<double>(this->ub.begin(), this->ub.end()), {}, m_tape, Tape());
 		};
 
         // Helperfunktion zum Debuggen, die vom Python-Interface aufgerufen werden kann
-		void printObjective(){m_root->printFunction();};
+		void printObjective(){if (m_root) {m_root->printFunction();} else {m_tape.print();}};
+		void printTape() const {m_tape.print();};
+		// number of evaluations the Tape keeps for incremental evaluation, 0 disables it
+		void setTapeCache(size_t n) {m_tape.setCacheSize(n);};
+		// widen the logs of the Tape so that the bounds stay valid despite their rounding errors (recompiles the Tape)
+		void setOutwardRounding(bool on) {
+		    if (!m_root) {
+		        throw std::logic_error("OptimizationProblem: a loaded problem keeps the rounding it was saved with");
+		    }
+		    const size_t cache = m_tape.getCacheSize();
+		    m_tape = Tape(m_root, on);
+		    m_tape.setCacheSize(cache);
+		};
+		// also bound boxes by the natural interval extension of the objective (see intervalObj()), needs the expression tree
+		void setIntervalBounds(bool on) {
+		    if (on && !m_root) {
+		        throw std::logic_error("OptimizationProblem: a loaded problem has no expression tree for interval bounds");
+		    }
+		    this->useIntervals = on;
+		};
+
+		// evaluate the compiled Tape (default) or walk the expression tree
+		bool useTape;
 
 	private:
 	    // Membervariable für die Objective-Function im zusammenhängenden Speicherbereich
-	    std::vector<variant_expression> m_contiguousContainer;
+	    Model m_model;
 	    // Membervariable, speichert Pointer zu der Root-Funktion
 	    Expression* m_root;
+	    // Objective compiled into a flat instruction list
+	    mutable Tape m_tape;
+	    // x and y for the expression tree, reused to avoid allocations per evaluation
+	    mutable std::vector<double> m_x, m_y;
+	    // expressions of the objective, arguments first, for the interval evaluation
+	    std::vector<Expression*> m_objectiveExprs;
 
 		double MMPobj(const vtypeS& x_in, const vtypeS& y_in) const override;
-		double evaluate(const std::vector<double>& x, const std::vector<double>& y) const override;
+		double intervalObj(const vtypeS& lb, const vtypeS& ub) const override;
 };
 
 template <size_t D, bool propFair>
 double OptimizationProblem<D,propFair>::MMPobj(const vtypeS& x_in, const vtypeS& y_in) const
 // overridden function MMPobj()
 {
-    std::vector<double> x(std::begin(x_in), std::end(x_in));
-    std::vector<double> y(std::begin(y_in), std::end(y_in));
-    return m_root->evaluate_me(x, y);
+    if (useTape || !m_root) {
+        return m_tape.evaluate_me(x_in.data(), y_in.data());
+    }
+
+    std::copy(std::begin(x_in), std::end(x_in), m_x.begin());
+    std::copy(std::begin(y_in), std::end(y_in), m_y.begin());
+    return m_root->evaluate_me(m_x, m_y);
 }
 
 template <size_t D, bool propFair>
-double OptimizationProblem<D,propFair>::evaluate(const std::vector<double>& x, const std::vector<double>& y) const
-// overridden function MMPobj()
+double OptimizationProblem<D,propFair>::intervalObj(const vtypeS& lb, const vtypeS& ub) const
+// natural interval extension of the objective, evaluated on the expression tree
 {
-    return m_root->evaluate_me(x, y);
-}
+    if (!m_root) {
+        return std::numeric_limits<double>::infinity();
+    }
 
+    std::copy(std::begin(lb), std::end(lb), m_x.begin());
+    std::copy(std::begin(ub), std::end(ub), m_y.begin());
+    for (auto e : m_objectiveExprs) {
+        e->evaluate_interval(m_x, m_y);
+    }
+    return m_root->getUpper().at(0);
+}
 
 #endif
\ No newline at end of file
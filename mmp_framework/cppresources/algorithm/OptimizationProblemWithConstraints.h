@@ -8,9 +8,12 @@
 #include <algorithm>
 #include <iostream>
 #include "MMP.h"
+#include "ModelFile.h"
 #include "../expressiontree/Function.h"
 #include "../expressiontree/Expression.h"
 #include "../expressiontree/Constraint.h"
+#include "../expressiontree/Model.h"
+#include "../expressiontree/Tape.h"
 
 template <size_t Dim>
 class OptimizationProblemWithConstraints : public MMPconstraints<Dim>
@@ -19,27 +22,98 @@ class OptimizationProblemWithConstraints : public MMPconstraints<Dim>
 	using typename MMPconstraints<Dim>::RBox;
 
 	public:
-	    // Konstruktor
-		OptimizationProblemWithConstraints(Function* obj, std::vector<Constraint*> constraints) : MMPconstraints<Dim>()
+	    // Konstruktor, dim ist nur für Dim == DynamicDim anzugeben
+		OptimizationProblemWithConstraints(Function* obj, std::vector<Constraint*> constraints, const size_t dim = Dim) : MMPconstraints<Dim>(dim), useTape(true), m_x(dim), m_y(dim)
 		{
-		    m_contiguousContainer = get_variant_vector();
-		    m_root = getBasePointer(m_contiguousContainer.at(findElementGetIndex(m_contiguousContainer, obj->getID())));
-		    m_constraints = get_variant_vector_constraints(constraints, m_contiguousContainer);
+		    // nur die vom Objective und den Constraints erreichbaren Ausdrücke werden kopiert
+		    std::vector<Expression*> roots = {obj};
+		    for (auto c : constraints) {
+		        roots.push_back(c->getConstraint());
+		    }
+		    m_model = Model(roots);
+		    m_root = m_model.get(obj);
+		    m_constraints = get_variant_vector_constraints(constraints, m_model);
+
+		    // alle Constraints teilen sich ein Tape, gemeinsame Teilausdrücke werden nur einmal ausgewertet
+		    std::vector<Expression*> constraintRoots;
+		    for (auto& c : m_constraints) {
+		        constraintRoots.push_back(std::visit([](auto&& c) -> Expression* {return c.getConstraint();}, c));
+		    }
+		    m_tape = Tape(m_root);
+		    m_constraintTape = Tape(constraintRoots);
+		    m_objectiveExprs = m_root->get_expression_list();
+		    for (auto& c : m_constraints) {
+		        m_constraintTypes.push_back(getConstraintType(c));
+		    }
+		    for (const Tape* t : {&m_tape, &m_constraintTape}) {
+		        if (t->getVariableDim() != 0 && t->getVariableDim() != dim) {
+		            throw std::invalid_argument("OptimizationProblemWithConstraints: dimension of the variable does not match");
+		        }
+		    }
+		};
+		// Problem written by save(), without expression trees (always evaluates the Tapes)
+		explicit OptimizationProblemWithConstraints(const ModelFile& file) : MMPconstraints<Dim>(file.getDim()), useTape(true), m_root(nullptr),
+		    m_constraintTypes(file.getConstraintTypes()), m_tape(file.getObjective()), m_constraintTape(file.getConstraints()), m_x(file.getDim()), m_y(file.getDim())
+		{
+		    if (file.getNumConstraints() == 0) {
+		        throw std::invalid_argument("OptimizationProblemWithConstraints: model file of a different problem type");
+		    }
+		    for (size_t i = 0; i < file.getDim(); ++i) {
+		        this->setLB(i, file.getLB()[i]);
+		        this->setUB(i, file.getUB()[i]);
+		    }
+		};
+
+		// Write the compiled objective and constraints and the bounds, see ModelFile
+		void save(const std::string& file) const {
+		    ModelFile::write(file, std::vector<double>(this->lb.begin(), this->lb.end()), std::vector<double>(this->ub.begin(), this->ub.end()),
+		                     m_constraintTypes, m_tape, m_constraintTape);
 		};
 
         // Helperfunktion zum Debuggen, die vom Python-Interface aufgerufen werden kann
-		void printObjective(){m_root->printFunction();};
+		void printObjective(){if (m_root) {m_root->printFunction();} else {m_tape.print();}};
+		void printTape() const {m_tape.print(); m_constraintTape.print();};
+		// number of evaluations the Tapes keep for incremental evaluation, 0 disables it
+		void setTapeCache(size_t n) {m_tape.setCacheSize(n); m_constraintTape.setCacheSize(n);};
+		// widen the logs of the objective Tape so that the bounds stay valid despite their rounding errors (recompiles the Tape)
+		void setOutwardRounding(bool on) {
+		    if (!m_root) {
+		        throw std::logic_error("OptimizationProblemWithConstraints: a loaded problem keeps the rounding it was saved with");
+		    }
+		    const size_t cache = m_tape.getCacheSize();
+		    m_tape = Tape(m_root, on);
+		    m_tape.setCacheSize(cache);
+		};
+		// also bound boxes by the natural interval extension of the objective (see intervalObj()), needs the expression tree
+		void setIntervalBounds(bool on) {
+		    if (on && !m_root) {
+		        throw std::logic_error("OptimizationProblemWithConstraints: a loaded problem has no expression tree for interval bounds");
+		    }
+		    this->useIntervals = on;
+		};
+
+		// evaluate the compiled Tapes (default) or walk the expression trees
+		bool useTape;
 
 	private:
-	    // Membervariable für die Objective-Function im zusammenhängenden Speicherbereich
-	    std::vector<variant_expression> m_contiguousContainer;
+	    // Membervariable für Objective und Constraints im zusammenhängenden Speicherbereich
+	    Model m_model;
 	    // Membervariable, speichert Pointer zu der Root-Funktion
 	    Expression* m_root;
 	    // Membervariablen für die gegebenen constraints
 	    std::vector<variant_constraint> m_constraints;
+	    std::vector<ConstraintType> m_constraintTypes;
+	    // Objective und Constraints als flache Instruktionslisten
+	    mutable Tape m_tape;
+	    mutable Tape m_constraintTape;
+	    // x and y for the expression trees, reused to avoid allocations per evaluation
+	    mutable std::vector<double> m_x, m_y;
+	    // expressions of the objective, arguments first, for the interval evaluation
+	    std::vector<Expression*> m_objectiveExprs;
 
 		// virtuelle Funktionen der Elternklassen, die hier implementiert werden
 		double MMPobj(const vtypeS& x, const vtypeS& y) const override;
+		double intervalObj(const vtypeS& lb, const vtypeS& ub) const override;
 		bool constraints(const vtypeS& x, const vtypeS& y) const override;
 
         // muss evtl. auch noch generalisiert werden?
@@ -51,20 +125,49 @@ template <size_t D>
 double OptimizationProblemWithConstraints<D>::MMPobj(const vtypeS& x, const vtypeS& y) const
 // overridden function MMPobj()
 {
-    std::vector<double> x_in(std::begin(x), std::end(x));
-    std::vector<double> y_in(std::begin(y), std::end(y));
-    return m_root->evaluate_me(x_in, y_in);
+    if (useTape || !m_root) {
+        return m_tape.evaluate_me(x.data(), y.data());
+    }
+
+    std::copy(std::begin(x), std::end(x), m_x.begin());
+    std::copy(std::begin(y), std::end(y), m_y.begin());
+    return m_root->evaluate_me(m_x, m_y);
+}
+
+template <size_t D>
+double OptimizationProblemWithConstraints<D>::intervalObj(const vtypeS& lb, const vtypeS& ub) const
+// natural interval extension of the objective, evaluated on the expression tree
+{
+    if (!m_root) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    std::copy(std::begin(lb), std::end(lb), m_x.begin());
+    std::copy(std::begin(ub), std::end(ub), m_y.begin());
+    for (auto e : m_objectiveExprs) {
+        e->evaluate_interval(m_x, m_y);
+    }
+    return m_root->getUpper().at(0);
 }
 
 template <size_t D>
 bool OptimizationProblemWithConstraints<D>::constraints(const vtypeS& x, const vtypeS& y) const
 {
-    std::vector<double> x_in(std::begin(x), std::end(x));
-    std::vector<double> y_in(std::begin(y), std::end(y));
+    if (useTape || !m_root) {
+        m_constraintTape.evaluate(x.data(), y.data());
+        for (size_t i = 0; i < m_constraintTypes.size(); ++i)
+        {
+            if (!fulfilled(m_constraintTypes[i], m_constraintTape.getValue(i), m_constraintTape.getDim(i))){return false;}
+        }
+        return true;
+    }
+
+    std::copy(std::begin(x), std::end(x), m_x.begin());
+    std::copy(std::begin(y), std::end(y), m_y.begin());
 
-    for (auto constraint: m_constraints)
+    for (auto& constraint: m_constraints)
     {
-        if (!fulfilledVisitor(constraint, x_in, y_in)){return false;}
+        if (!fulfilledVisitor(constraint, m_x, m_y)){return false;}
     }
 	return true;
 }
@@ -0,0 +1,105 @@
+#ifndef _PROFILER_H
+#define _PROFILER_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*
+ * Time stamp counter. Falls back to a steady clock on architectures without
+ * rdtsc. Ticks are converted to seconds by Profiler::stop() with a factor
+ * calibrated against the wall clock over the profiled interval.
+ */
+inline uint64_t
+readTSC()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+/*
+ * Per-phase call counts and tick counters for BRB::optimize().
+ * Always compiled in; while disabled, a measurement costs one branch.
+ */
+class Profiler
+{
+	public:
+		enum Phase { Bound, Reduction, IsEmpty, Feasible, Obj, Push, Pop, Branch, NumPhases };
+
+		struct Counter
+		{
+			unsigned long long calls = 0;
+			unsigned long long ticks = 0;
+		};
+
+		class Scope
+		{
+			public:
+				Scope(Counter* c) : c_(c), t0_(c ? readTSC() : 0) {}
+				~Scope() { if (c_) { c_->ticks += readTSC() - t0_; ++c_->calls; } }
+
+				Scope(const Scope&) = delete;
+				Scope& operator=(const Scope&) = delete;
+
+			private:
+				Counter* c_;
+				uint64_t t0_;
+		};
+
+		Profiler() : enabled(false), secondsPerTick(0) {}
+
+		bool enabled;
+
+		// RAII measurement of one call to phase p
+		Scope measure(const Phase p) { return Scope(enabled ? &counter[p] : nullptr); }
+
+		void start()
+		{
+			counter = {};
+			wall0 = std::chrono::steady_clock::now();
+			tsc0 = readTSC();
+		}
+
+		void stop()
+		{
+			const uint64_t ticks = readTSC() - tsc0;
+			const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+			secondsPerTick = ticks ? wall / ticks : 0;
+		}
+
+		unsigned long long calls(const Phase p) const { return counter[p].calls; }
+		unsigned long long ticks(const Phase p) const { return counter[p].ticks; }
+		double seconds(const Phase p) const { return counter[p].ticks * secondsPerTick; }
+
+		static const char* name(const Phase p)
+		{
+			static const char* names[NumPhases] = { "bound", "reduction", "isEmpty", "feasible", "obj", "push", "pop", "branch" };
+			return names[p];
+		}
+
+		void print() const
+		{
+			std::printf("%-10s %14s %12s %12s\n", "phase", "calls", "time [s]", "per call [ns]");
+			for (int i = 0; i < NumPhases; ++i)
+			{
+				const Phase p = static_cast<Phase>(i);
+				std::printf("%-10s %14llu %12g %12g\n", name(p), calls(p), seconds(p), calls(p) ? 1e9 * seconds(p) / calls(p) : 0.0);
+			}
+		}
+
+	private:
+		std::array<Counter, NumPhases> counter;
+		double secondsPerTick;
+		uint64_t tsc0;
+		std::chrono::time_point<std::chrono::steady_clock> wall0;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef _MMP_STATICPROBLEM_
+#define _MMP_STATICPROBLEM_
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <vector>
+#include "MMP.h"
+#include "../expressiontree/StaticExpression.h"
+
+/*
+ * MMP problem whose objective is an expression template (see
+ * expressiontree/StaticExpression.h): the same bound as OptimizationProblem
+ * with the expression tree, but compiled into MMPobj() like the hand-written
+ * problems (TIN, ALOHA). E is the type of the objective, a scalar node
+ * depending on a variable of dimension Dim, e.g.
+ *
+ *     auto p = et::variable<4, NN>();
+ *     auto obj = et::sum(et::log2(1.0 + p));
+ *     StaticProblem<4, decltype(obj)> problem(obj);    // or makeStaticProblem<4>(obj)
+ */
+template <size_t Dim, typename E>
+class StaticProblem : public MMP<Dim>
+{
+	using typename MMP<Dim>::vtypeS;
+
+	static_assert(Dim != DynamicDim, "StaticProblem: the dimension must be known at compile time");
+	static_assert(et::isNode<E> && E::size == 1, "StaticProblem: the objective must be a scalar expression");
+	static_assert(E::dim == Dim, "StaticProblem: dimension of the variable does not match");
+
+	public:
+		explicit StaticProblem(const E& objective) : MMP<Dim>(), m_objective(objective) {};
+
+		// objective at the point x, helper for debugging
+		double evaluate(const std::vector<double>& x) const {
+		    if (x.size() != Dim) {
+		        throw std::invalid_argument("StaticProblem: dimension of the point does not match");
+		    }
+		    std::array<double, Dim> p;
+		    std::copy(x.begin(), x.end(), p.begin());
+		    return m_objective.eval(p, p)[0];
+		};
+
+	private:
+		E m_objective;
+
+		double MMPobj(const vtypeS& x, const vtypeS& y) const override
+			{ return m_objective.eval(x, y)[0]; }
+};
+
+template <size_t Dim, typename E>
+StaticProblem<Dim, E> makeStaticProblem(const E& objective)
+{
+	return StaticProblem<Dim, E>(objective);
+}
+
+#endif
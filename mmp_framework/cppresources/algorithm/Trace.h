@@ -0,0 +1,126 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+struct TraceSample
+{
+	double time; // seconds since start of optimize()
+	unsigned long long iter;
+	unsigned long long queueSize;
+	double optval;
+	double bound; // bound of the best box in the queue
+	double peakRSS; // in GB
+};
+
+/*
+ * Convergence trace of BRB::optimize(). Samples are stored in a fixed-size
+ * ring buffer, i.e., the newest `capacity` samples are kept. The time between
+ * two samples grows with the elapsed time (at least minInterval, at least
+ * relInterval times the elapsed time), so short and long runs both yield a
+ * few hundred to a few thousand samples that resolve the start of the run
+ * finely.
+ */
+class Trace
+{
+	public:
+		Trace(const size_t capacity = 4096) : enabled(false), minInterval(1e-3), relInterval(1e-2), buf(capacity), head(0), count(0), next(0) {}
+
+		bool enabled;
+		double minInterval; // in seconds
+		double relInterval;
+
+		void reset()
+		{
+			head = count = 0;
+			next = 0;
+		}
+
+		// true if a sample should be taken at time t
+		bool due(const double t) const { return t >= next; }
+
+		void record(const TraceSample& s)
+		{
+			buf[head] = s;
+			head = (head + 1) % buf.size();
+			count = std::min(count + 1, buf.size());
+			next = s.time + std::max(minInterval, relInterval * s.time);
+		}
+
+		size_t size() const { return count; }
+		size_t capacity() const { return buf.size(); }
+
+		void setCapacity(const size_t capacity)
+		{
+			if (capacity == 0)
+				throw std::invalid_argument("Trace: capacity must be positive");
+
+			buf.assign(capacity, TraceSample());
+			reset();
+		}
+
+		// samples in chronological order
+		std::vector<TraceSample> samples() const
+		{
+			std::vector<TraceSample> ret;
+			ret.reserve(count);
+
+			const size_t first = (head + buf.size() - count) % buf.size();
+			for (size_t i = 0; i < count; ++i)
+				ret.push_back(buf[(first + i) % buf.size()]);
+
+			return ret;
+		}
+
+		void writeCSV(const std::string& filename) const
+		{
+			std::ofstream out(filename);
+			if (!out)
+				throw std::runtime_error("Trace: cannot open " + filename);
+
+			out.precision(std::numeric_limits<double>::max_digits10);
+			out << "time,iter,queue_size,optval,bound,peak_rss\n";
+			for (const auto& s : samples())
+				out << s.time << ',' << s.iter << ',' << s.queueSize << ',' << s.optval << ',' << s.bound << ',' << s.peakRSS << '\n';
+		}
+
+		void writeJSON(const std::string& filename) const
+		{
+			std::ofstream out(filename);
+			if (!out)
+				throw std::runtime_error("Trace: cannot open " + filename);
+
+			out.precision(std::numeric_limits<double>::max_digits10);
+
+			// JSON has no inf/nan
+			auto num = [&out] (const double v) { if (std::isfinite(v)) out << v; else out << "null"; };
+
+			out << "[";
+			bool first = true;
+			for (const auto& s : samples())
+			{
+				out << (first ? "\n" : ",\n");
+				first = false;
+
+				out << "  {\"time\": " << s.time << ", \"iter\": " << s.iter << ", \"queue_size\": " << s.queueSize << ", \"optval\": ";
+				num(s.optval);
+				out << ", \"bound\": ";
+				num(s.bound);
+				out << ", \"peak_rss\": " << s.peakRSS << "}";
+			}
+			out << "\n]\n";
+		}
+
+	private:
+		std::vector<TraceSample> buf;
+		size_t head, count;
+		double next;
+};
+
+#endif
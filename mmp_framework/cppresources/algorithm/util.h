@@ -153,10 +153,17 @@ class MiniPool
 {
 public:
 	std::unique_ptr<T> get()
+	{
+		return get([] { return std::make_unique<T>(); });
+	}
+
+	// make() creates a new object if the pool is empty
+	template <class Make>
+	std::unique_ptr<T> get(Make make)
 	{
 		if (cache_.size() == 0)
 		{
-			return std::make_unique<T>();
+			return make();
 		}
 		auto r = std::move(cache_.back());
 		cache_.pop_back();
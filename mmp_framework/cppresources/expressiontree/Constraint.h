@@ -1,10 +1,26 @@
 #ifndef _CONSTRAINTS_
 #define _CONSTRAINTS_
 
+#include <cstdint>
 #include <variant>
 #include <vector>
 #include "Expression.h"
 #include "Function.h"
+#include "Model.h"
+
+// kind of a constraint (the order of variant_constraint), see fulfilled()
+enum ConstraintType : uint8_t {Inequality, GTOE, LTOE};
+
+// check of the value (of length dim) of a constraint function of the given type
+bool fulfilled(ConstraintType type, const double* value, int dim) {
+    for (int i=0; i<dim; ++i)
+    {
+        if (type == Inequality && value[i] == 0){return false;}
+        if (type == GTOE && value[i] > 0){return false;}
+        if (type == LTOE && value[i] < 0){return false;}
+    }
+    return true;
+}
 
 class Constraint {
   public:
@@ -24,43 +40,34 @@ class InequalityConstraint: public Constraint {
   public:
     explicit InequalityConstraint(Expression* constraint) : Constraint(constraint){};
 
-    bool fulfilled(const std::vector<double>& x_in, const std::vector<double>& y_in) {
-        m_constraint->evaluate(x_in, y_in);
-
-        for (int i=0; i<m_dim; ++i)
-        {
-            if (m_constraint->getValue()->at(i) == 0){return false;}
-        }
-        return true;
+    bool fulfilled(const std::vector<double>& x_in, const std::vector<double>& y_in) const {
+        m_constraint->evaluate_root(x_in, y_in);
+        return fulfilled(m_constraint->getValue()->data());
     };
+    // check an already evaluated constraint function (e.g., from a Tape)
+    bool fulfilled(const double* value) const {return ::fulfilled(Inequality, value, m_dim);};
 };
 
 class GTOEConstraint: public Constraint {
   public:
     explicit GTOEConstraint(Expression* constraint) : Constraint(constraint){};
 
-    bool fulfilled(const std::vector<double>& x_in, const std::vector<double>& y_in) {
-        m_constraint->evaluate(x_in, y_in);
-        for (int i=0; i<m_dim; ++i)
-        {
-            if (m_constraint->getValue()->at(i) > 0){return false;}
-        }
-        return true;
+    bool fulfilled(const std::vector<double>& x_in, const std::vector<double>& y_in) const {
+        m_constraint->evaluate_root(x_in, y_in);
+        return fulfilled(m_constraint->getValue()->data());
     };
+    bool fulfilled(const double* value) const {return ::fulfilled(GTOE, value, m_dim);};
 };
 
 class LTOEConstraint: public Constraint {
   public:
     explicit LTOEConstraint(Expression* constraint) : Constraint(constraint){};
 
-    bool fulfilled(const std::vector<double>& x_in, const std::vector<double>& y_in) {
-        m_constraint->evaluate(x_in, y_in);
-        for (int i=0; i<m_dim; ++i)
-        {
-            if (m_constraint->getValue()->at(i) < 0){return false;}
-        }
-        return true;
+    bool fulfilled(const std::vector<double>& x_in, const std::vector<double>& y_in) const {
+        m_constraint->evaluate_root(x_in, y_in);
+        return fulfilled(m_constraint->getValue()->data());
     };
+    bool fulfilled(const double* value) const {return ::fulfilled(LTOE, value, m_dim);};
 };
 
 /*  Down below are Methods for creating a contiguous storage container for Constraints in an objective
@@ -69,12 +76,19 @@ class LTOEConstraint: public Constraint {
 
 typedef std::variant<InequalityConstraint, GTOEConstraint, LTOEConstraint> variant_constraint;
 
-bool fulfilledVisitor(variant_constraint& variant, const std::vector<double>& x, const std::vector<double>& y) {
-    return std::visit([x,y](auto&& c) -> bool {return c.fulfilled(x,y);}, variant);
+bool fulfilledVisitor(const variant_constraint& variant, const std::vector<double>& x, const std::vector<double>& y) {
+    return std::visit([&x,&y](auto&& c) -> bool {return c.fulfilled(x,y);}, variant);
+}
+
+bool fulfilledVisitor(const variant_constraint& variant, const double* value) {
+    return std::visit([value](auto&& c) -> bool {return c.fulfilled(value);}, variant);
+}
+
+ConstraintType getConstraintType(const variant_constraint& variant) {
+    return static_cast<ConstraintType>(variant.index());
 }
 
-std::vector<variant_constraint> get_variant_vector_constraints(const std::vector<Constraint*>& constraints,
-                                                               std::vector<variant_expression>& list_of_expressions) {
+std::vector<variant_constraint> get_variant_vector_constraints(const std::vector<Constraint*>& constraints, Model& model) {
     // The return vector
     std::vector<variant_constraint> contiguousStorageContainer;
 
@@ -86,39 +100,21 @@ std::vector<variant_constraint> get_variant_vector_constraints(const std::vector
 
         // 1. Falls InequalityConstraint:
         if (auto iec = dynamic_cast<InequalityConstraint*>(constr)) {
-            Expression *basePointer;
-            // Suche den constr in dem variant_container aller Expressions
-            int idToFind = iec->getConstraint()->getID();
-            size_t index = findElementGetIndex(list_of_expressions, idToFind);
-            if (index != -1) {
-                // Und speichere einen Pointer zu diesem
-                basePointer = getBasePointer(list_of_expressions.at(index));
-            }
+            // Suche die Kopie des constr im Model (nullptr, falls nicht enthalten)
+            Expression *basePointer = model.get(iec->getConstraint());
             contiguousStorageContainer.push_back(InequalityConstraint(basePointer));
         }
         // 2. Falls GTOEConstraint:
         if (auto iec = dynamic_cast<GTOEConstraint*>(constr)) {
-            Expression *basePointer;
-            // Suche den constr in dem variant_container aller Expressions
-            int idToFind = iec->getConstraint()->getID();
-            size_t index = findElementGetIndex(list_of_expressions, idToFind);
-            if (index != -1) {
-                // Und speichere einen Pointer zu diesem
-                basePointer = getBasePointer(list_of_expressions.at(index));
-            }
+            // Suche die Kopie des constr im Model (nullptr, falls nicht enthalten)
+            Expression *basePointer = model.get(iec->getConstraint());
 
             contiguousStorageContainer.push_back(GTOEConstraint(basePointer));
         }
         // 3. Falls LTOEConstraint:
         if (auto iec = dynamic_cast<LTOEConstraint*>(constr)) {
-            Expression *basePointer;
-            // Suche den constr in dem variant_container aller Expressions
-            int idToFind = iec->getConstraint()->getID();
-            size_t index = findElementGetIndex(list_of_expressions, idToFind);
-            if (index != -1) {
-                // Und speichere einen Pointer zu diesem
-                basePointer = getBasePointer(list_of_expressions.at(index));
-            }
+            // Suche die Kopie des constr im Model (nullptr, falls nicht enthalten)
+            Expression *basePointer = model.get(iec->getConstraint());
 
             contiguousStorageContainer.push_back(LTOEConstraint{basePointer});
         }
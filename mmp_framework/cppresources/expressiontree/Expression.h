@@ -1,7 +1,9 @@
 #ifndef EXPRTREE_EXPRESSION_H
 #define EXPRTREE_EXPRESSION_H
 
+#include <algorithm>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -18,6 +20,25 @@ std::ostream& operator<<(std::ostream& o, sign s)
     return o;
 }
 
+class Expression;
+
+/*
+ * State of the evaluations of the expressions of one tree, see
+ * Expression::evaluate_root(): the vector passed as x to the current
+ * evaluation, which tells the orientation of an argument, the number of
+ * the evaluation, values memoized in earlier ones are stale, and the
+ * expressions whose value changed orientation (with the previous one), see
+ * evaluate_arg(). A Model binds one EvalContext to all its expressions, so
+ * problems evaluating different Models (e.g., in different threads) share
+ * nothing.
+ */
+struct EvalContext
+{
+    const std::vector<double>* x = nullptr;
+    unsigned long epoch = 0;
+    std::vector<std::pair<Expression*, int>> changed;
+};
+
 class Expression
 {
   public:
@@ -25,27 +46,131 @@ class Expression
     explicit Expression(const std::string& name) {
         this->m_id = getNewID();
         this->m_name = name;
-        expression_list.push_back(this);
     };
     // Copy-Ctor
     Expression(const Expression &old) = default;
+    // Ctor for replacing the expression with ID id in a contiguous storage container (e.g., constant folding)
+    Expression(const std::string& name, int id) : m_name(name), m_id(id) {};
+    virtual ~Expression() = default;
 
     // Evaluation function (to be called from optimization Problem class)
     double evaluate_me(const std::vector<double>& x_in, const std::vector<double>& y_in) {
-        this->evaluate(x_in, y_in);
+        this->evaluate_root(x_in, y_in);
         return m_value.at(0);
     };
 
+    // Evaluate this expression as the root of a new evaluation. Values of shared
+    // subexpressions memoized in earlier evaluations become invalid. An expression
+    // outside a Model is bound to a context for this evaluation only.
+    void evaluate_root(const std::vector<double>& x_in, const std::vector<double>& y_in) {
+        if (m_context) {
+            m_context->x = &x_in;
+            ++m_context->epoch;
+            m_context->changed.clear();
+            this->evaluate(x_in, y_in);
+            return;
+        }
+
+        EvalContext context{&x_in, 1, {}};
+        const std::vector<Expression*> list = get_expression_list();
+        struct Unbind {
+            const std::vector<Expression*>& list;
+            ~Unbind() {for (auto e : list) {e->setContext(nullptr);}};
+        } unbind{list};
+        for (auto e : list) {
+            e->setContext(&context);
+        }
+        this->evaluate(x_in, y_in);
+    };
+
+    // Evaluate this expression as argument of a Function (x_in and y_in are the
+    // vectors passed to evaluate_root(), possibly swapped). Functions and shared
+    // leaves keep their values for both orientations, (x,y) in m_memo[0] and
+    // (y,x) in m_memo[1], and compute each of them at most once per evaluation;
+    // further calls restore the memoized value. Thereby, atoms that need both
+    // orientations of their arguments (e.g., the sign unknown ones) cost linear
+    // instead of exponential time in the depth of the tree.
+    // The Functions read the values of their arguments in m_value after
+    // evaluating all of them, so evaluating an argument leaves the values of
+    // all other expressions as they were: an argument evaluated before can be
+    // part of this one in the other orientation (e.g., x and 1/x in x + 1/x).
+    void evaluate_arg(const std::vector<double>& x_in, const std::vector<double>& y_in) {
+        if (!m_context || (!m_dual && m_parents < 2)) {
+            this->evaluate(x_in, y_in);
+            return;
+        }
+
+        const int o = (&x_in == m_context->x) ? 0 : 1;
+        const bool valid = m_epoch[m_current] == m_context->epoch;
+        if (m_epoch[o] != m_context->epoch) {
+            const size_t changed = m_context->changed.size();
+            this->evaluate(x_in, y_in);
+            restore(changed);
+            m_memo[o] = m_value;
+            m_epoch[o] = m_context->epoch;
+        } else if (m_current != o) {
+            std::copy(m_memo[o].begin(), m_memo[o].end(), m_value.begin());
+        }
+        if (valid && m_current != o) {
+            m_context->changed.emplace_back(this, m_current);
+        }
+        m_current = o;
+    };
+
+    // Value for (x_in,y_in) as evaluate_arg(), for arguments of which only some
+    // elements are read (Sliced, List): a memoized value is returned in place,
+    // without restoring the whole vector into m_value.
+    virtual const std::vector<double>& evaluate_ref(const std::vector<double>& x_in, const std::vector<double>& y_in) {
+        if (!m_context || (!m_dual && m_parents < 2)) {
+            this->evaluate(x_in, y_in);
+            return m_value;
+        }
+
+        const int o = (&x_in == m_context->x) ? 0 : 1;
+        if (m_epoch[o] != m_context->epoch) {
+            const bool valid = m_epoch[m_current] == m_context->epoch;
+            const size_t changed = m_context->changed.size();
+            this->evaluate(x_in, y_in);
+            restore(changed);
+            m_memo[o] = m_value;
+            m_epoch[o] = m_context->epoch;
+            if (valid && m_current != o) {
+                m_context->changed.emplace_back(this, m_current);
+            }
+            m_current = o;
+            return m_value;
+        }
+        return m_memo[o];
+    };
+
     // Pure Virtual function evaluate, all derived classes need to implement
+    // (roots are evaluated via evaluate_root() or evaluate_me(), arguments via evaluate_arg())
     virtual void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) = 0;
 
+    // Natural interval extension: bounds of the value for all values of the Variable in the box [lb, ub],
+    // computed from the bounds of the arguments, which have to be evaluated first (e.g., in the order of
+    // get_expression_list()). The bounds are in getLower() and getUpper().
+    virtual void evaluate_interval(const std::vector<double>& lb, const std::vector<double>& ub) = 0;
+    const std::vector<double>& getLower() const {return m_lower;};
+    const std::vector<double>& getUpper() const {return m_upper;};
+
+    // Called by Functions taking this expression as argument
+    void addParent() {++m_parents;};
+    int getParents() const {return m_parents;};
+    // an expression replacing e (see rewrite()) has the parents of e
+    void inheritParents(const Expression& e) {m_parents = e.m_parents;};
+    // context of the evaluations (see evaluate_root()), the memoized values are dropped
+    void setContext(EvalContext* context) {
+        m_context = context;
+        m_epoch[0] = m_epoch[1] = 0;
+    };
+
     // Getter for private members
     std::string getName() {return m_name;};
     std::vector<double>* getValue() {return &m_value;};
     sign getSign(){return m_sign;};
     int getDim() const{return m_dim;};
     int getID() const {return m_id;};
-    static std::vector<Expression*> getExpressionList() {return expression_list;};
 
     // Helper methods to print expression
     virtual void printFunction(){printExpression();};
@@ -65,44 +190,19 @@ class Expression
         }
     };
 
-    // Helper methods to not create duplicate Parameters
-    static int getParameterId(const std::vector<double>& value) {
-        for (auto expr : Expression::expression_list) {
-            if (expr->m_dim == value.size() && expr->m_name == "Parameter") {
-                if (*expr->getValue() == value) {
-                    return expr->getID();
-                }
-            }
+    // Methods for listing all Expressions in an objective (see Model), every expression is listed once,
+    // after its arguments (visited holds the IDs already listed).
+    virtual void add_to_expr_list(std::vector<Expression*>& expr_list, std::unordered_set<int>& visited) {
+        if (visited.insert(m_id).second) {
+            expr_list.push_back(this);
         }
-        return -1;
-    };
-    static Expression* getExpression(int id) {
-        for (auto expr : Expression::expression_list) {
-            if (expr->getID() == id) {
-                return expr;
-            }
-        }
-    }
-
-    // Methods for list all created Expressions in an objective (only needed, if one does not want to utilize
-    // the static member Expression::expression_list, which is recommended.
-    virtual void add_to_expr_list(std::vector<Expression*>& expr_list) {
-        expr_list.push_back(this);
     }
     std::vector<Expression*> get_expression_list() {
         std::vector<Expression*> list_of_expressions;
+        std::unordered_set<int> visited;
 
         // recursive call to add expressions
-        this->add_to_expr_list(list_of_expressions);
-
-        // remove all duplicate elements (Parameters, Variables only need to be stored once)
-        for (int i=0; i<list_of_expressions.size(); ++i) {
-            for (int j=i+1; j<list_of_expressions.size();j++) {
-                if (list_of_expressions.at(i)->getID() == list_of_expressions.at(j)->getID()) {
-                    list_of_expressions.erase(list_of_expressions.begin() + j);
-                }
-            }
-        }
+        this->add_to_expr_list(list_of_expressions, visited);
 
         return list_of_expressions;
     }
@@ -111,16 +211,36 @@ class Expression
     //protected, so that subclasses have access to these members
     int m_dim = 0;
     std::vector<double> m_value;
+    // bounds of evaluate_interval()
+    std::vector<double> m_lower, m_upper;
     sign m_sign = unknown;
+    // memoize both orientations even if the expression has only one parent
+    bool m_dual = false;
   private:
     std::string m_name;
     static int getNewID(){++uid_counter; return uid_counter;};
     int m_id;
     static int uid_counter;
-    static std::vector<Expression*> expression_list;
+
+    // memoization of shared subexpressions, m_memo[0] for (x,y), m_memo[1] for (y,x)
+    int m_parents = 0;
+    int m_current = 0;
+    EvalContext* m_context = nullptr;
+    unsigned long m_epoch[2] = {0, 0};
+    std::vector<double> m_memo[2];
+
+    // restores the orientations of the values changed since the first n entries of m_context->changed
+    void restore(size_t n) {
+        auto& changed = m_context->changed;
+        while (changed.size() > n) {
+            Expression* e = changed.back().first;
+            e->m_current = changed.back().second;
+            std::copy(e->m_memo[e->m_current].begin(), e->m_memo[e->m_current].end(), e->m_value.begin());
+            changed.pop_back();
+        }
+    };
 };
 
 int Expression::uid_counter = 0;
-std::vector<Expression*> Expression::expression_list = {};
 
 #endif //EXPRTREE_EXPRESSION_H
\ No newline at end of file
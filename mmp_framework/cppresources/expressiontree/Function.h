@@ -6,6 +6,8 @@
 #include <utility>
 #include <variant>
 #include <vector>
+#include <unordered_map>
+#include <unordered_set>
 #include <deque>
 #include <stack>
 #include <cmath>
@@ -16,6 +18,11 @@
 #include "Expression.h"
 #include "Variable.h"
 #include "Parameter.h"
+#include "util/Gemv.h"
+#include "util/Rate.h"
+#include "util/Split.h"
+#include "util/VecMath.h"
+#include "util/Interval.h"
 
 class Function : public Expression
 {
@@ -24,16 +31,21 @@ class Function : public Expression
   public:
     // single argument constructor
     explicit Function(Expression *a, const std::string& name) : Expression(name) {
+        m_dual = true;
         m_arguments.push_back(a);
+        a->addParent();
     };
     // double argument constructor (calls the single argument constructor)
     Function(Expression *a, Expression *b, const std::string& name) : Function(a, name) {
         m_arguments.push_back(b);
+        b->addParent();
     };
     // vector constructor
     Function(std::vector<Expression*> a, const std::string& name) : Expression(name) {
+        m_dual = true;
         for (auto expr : a) {
             m_arguments.push_back(expr);
+            expr->addParent();
         }
     };
 
@@ -45,9 +57,12 @@ class Function : public Expression
     };
 
     // Helper virtual Method
-    void add_to_expr_list(std::vector<Expression*>& expr_list) override {
+    void add_to_expr_list(std::vector<Expression*>& expr_list, std::unordered_set<int>& visited) override {
+        if (!visited.insert(getID()).second) {
+            return;
+        }
         for (auto arg : m_arguments) {
-            arg->add_to_expr_list(expr_list);
+            arg->add_to_expr_list(expr_list, visited);
         }
         expr_list.push_back(this);
     }
@@ -61,7 +76,7 @@ class Function : public Expression
     }
 
     // getter for m_arguments
-    std::vector<Expression*> getArgs() { return m_arguments; };
+    const std::vector<Expression*>& getArgs() const { return m_arguments; };
 
     // This is the recursive pure virtual function
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override = 0;
@@ -96,10 +111,20 @@ class Add_vec_vec: public Function
         m_arg2val = arguments.at(1)->getValue();
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_arg2val->begin(), m_value.begin(), std::plus<>());
     };
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& a = *m_arguments[0];
+        const Expression& b = *m_arguments[1];
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        for (int i = 0; i < m_dim; ++i) {
+            m_lower[i] = a.getLower()[i] + b.getLower()[i];
+            m_upper[i] = a.getUpper()[i] + b.getUpper()[i];
+        }
+    };
   private:
     std::vector<double>* m_arg1val;
     std::vector<double>* m_arg2val;
@@ -128,10 +153,20 @@ class Add_vec_scalar: public Function
         m_arg2val = &arguments.at(1)->getValue()->at(0);
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_value.begin(), [this](const double & c){return c+*m_arg2val;});
     };
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& a = *m_arguments[0];
+        const Expression& b = *m_arguments[1];
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        for (int i = 0; i < m_dim; ++i) {
+            m_lower[i] = a.getLower()[i] + b.getLower()[0];
+            m_upper[i] = a.getUpper()[i] + b.getUpper()[0];
+        }
+    };
   private:
     std::vector<double>* m_arg1val;
     double* m_arg2val;
@@ -152,7 +187,16 @@ class Mult_vec_vec: public Function
         m_arg2val = arguments.at(1)->getValue();
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override = 0;
-
+    // the same for all sign variants
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& a = *m_arguments[0];
+        const Expression& b = *m_arguments[1];
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        for (int i = 0; i < m_dim; ++i) {
+            interval::mult(a.getLower()[i], a.getUpper()[i], b.getLower()[i], b.getUpper()[i], m_lower[i], m_upper[i]);
+        }
+    };
   protected:
     std::vector<double>* m_arg1val;
     std::vector<double>* m_arg2val;
@@ -166,8 +210,8 @@ class Mult_vecNN_vecNN: public Mult_vec_vec
     };
     Mult_vecNN_vecNN(const Mult_vecNN_vecNN &old, const std::vector<Expression*>& arguments) : Mult_vec_vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_arg2val->begin(), m_value.begin(), std::multiplies<>());
     };
 };
@@ -179,8 +223,8 @@ class Mult_vecNP_vecNP: public Mult_vec_vec
     };
     Mult_vecNP_vecNP(const Mult_vecNP_vecNP &old, const std::vector<Expression*>& arguments) : Mult_vec_vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_arg2val->begin(), m_value.begin(), std::multiplies<>());
     };
 };
@@ -192,8 +236,8 @@ class Mult_vecNN_vecNP: public Mult_vec_vec
     };
     Mult_vecNN_vecNP(const Mult_vecNN_vecNP &old, const std::vector<Expression*>& arguments) : Mult_vec_vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_arg2val->begin(), m_value.begin(), std::multiplies<>());
     };
 };
@@ -214,7 +258,7 @@ class Mult_vecU_vecNN: public Mult_vec_vec
         a_lessthan0 = old.a_lessthan0;
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
         for (size_t i=0;i<m_dim;++i) {
             if (m_arg1val->at(i) >= 0) {
                 a_greaterequalthan0.at(i) = m_arg1val->at(i);
@@ -224,9 +268,9 @@ class Mult_vecU_vecNN: public Mult_vec_vec
                 a_lessthan0.at(i) = m_arg1val->at(i);
             }
         }
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         b_swap = *m_arguments.at(1)->getValue();
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(a_greaterequalthan0.begin(), a_greaterequalthan0.end(), m_arg2val->begin(), addend1.begin(), std::multiplies<>());
         std::transform(a_lessthan0.begin(), a_lessthan0.end(), b_swap.begin(), addend2.begin(), std::multiplies<>());
         std::transform(addend1.begin(), addend1.end(), addend2.begin(), m_value.begin(), std::plus<>());
@@ -255,7 +299,7 @@ class Mult_vecU_vecNP: public Mult_vec_vec
         a_lessthan0 = old.a_lessthan0;
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
         for (size_t i=0;i<m_dim;++i) {
             if (m_arg1val->at(i) >= 0) {
                 a_greaterequalthan0.at(i) = m_arg1val->at(i);
@@ -265,9 +309,9 @@ class Mult_vecU_vecNP: public Mult_vec_vec
                 a_lessthan0.at(i) = m_arg1val->at(i);
             }
         }
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         b_swap = *m_arguments.at(1)->getValue();
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(a_greaterequalthan0.begin(), a_greaterequalthan0.end(), m_arg2val->begin(), addend1.begin(), std::multiplies<>());
         std::transform(a_lessthan0.begin(), a_lessthan0.end(), b_swap.begin(), addend2.begin(), std::multiplies<>());
         std::transform(addend1.begin(), addend1.end(), addend2.begin(), m_value.begin(), std::plus<>());
@@ -284,86 +328,32 @@ class Mult_vecU_vecU: public Mult_vec_vec
   public:
     Mult_vecU_vecU(Expression *a, Expression *b) : Mult_vec_vec(a, b) {
         this->m_sign = unknown;
-        a_greaterequalthan0.resize(m_dim);
-        a_lessthan0.resize(m_dim);
-        b_greaterequalthan0.resize(m_dim);
-        b_lessthan0.resize(m_dim);
-        a_swap_greaterequalthan0.resize(m_dim);
-        a_swap_lessthan0.resize(m_dim);
-        b_swap_greaterequalthan0.resize(m_dim);
-        b_swap_lessthan0.resize(m_dim);
-        addend1.resize(m_dim);
-        addend2.resize(m_dim);
-        addend3.resize(m_dim);
-        addend4.resize(m_dim);
+        a_value.resize(a->getDim());
+        a_swap.resize(a->getDim());
+        b_value.resize(b->getDim());
     };
     Mult_vecU_vecU(const Mult_vecU_vecU &old, const std::vector<Expression*>& arguments) : Mult_vec_vec(old, arguments) {
-        addend1 = old.addend1;
-        addend2 = old.addend2;
-        addend3 = old.addend3;
-        addend4 = old.addend4;
-        a_greaterequalthan0 = old.a_greaterequalthan0;
-        a_lessthan0 = old.a_lessthan0;
-        a_swap_greaterequalthan0 = old.a_swap_greaterequalthan0;
-        a_swap_lessthan0 = old.a_swap_lessthan0;
-        b_greaterequalthan0 = old.b_greaterequalthan0;
-        b_lessthan0 = old.b_lessthan0;
-        b_swap_greaterequalthan0 = old.b_swap_greaterequalthan0;
-        b_swap_lessthan0 = old.b_swap_lessthan0;
+        a_value = old.a_value;
+        a_swap = old.a_swap;
+        b_value = old.b_value;
     };
+    // see split::mult()
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_arg1val->at(i) >= 0) {
-                a_greaterequalthan0.at(i) = m_arg1val->at(i);
-                a_lessthan0.at(i) = 0;
-                b_greaterequalthan0.at(i) = m_arg2val->at(i);
-                b_lessthan0.at(i) = 0;
-            } else {
-                a_greaterequalthan0.at(i) = 0;
-                a_lessthan0.at(i) = m_arg1val->at(i);
-                b_greaterequalthan0.at(i) = 0;
-                b_lessthan0.at(i) = m_arg2val->at(i);
-            }
-        }
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(y_in, x_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_arg1val->at(i) >= 0) {
-                a_swap_greaterequalthan0.at(i) = m_arg1val->at(i);
-                a_swap_lessthan0.at(i) = 0;
-                b_swap_greaterequalthan0.at(i) = m_arg2val->at(i);
-                b_swap_lessthan0.at(i) = 0;
-            } else {
-                a_swap_greaterequalthan0.at(i) = 0;
-                a_swap_lessthan0.at(i) = m_arg1val->at(i);
-                b_swap_greaterequalthan0.at(i) = 0;
-                b_swap_lessthan0.at(i) = m_arg2val->at(i);
-            }
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        a_value = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        b_value = *m_arg2val;
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        a_swap = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        for (int i=0;i<m_dim;++i) {
+            m_value.at(i) = split::mult(a_value.at(i), a_swap.at(i), b_value.at(i), m_arg2val->at(i));
         }
-
-        std::transform(a_greaterequalthan0.begin(), a_greaterequalthan0.end(), b_greaterequalthan0.begin(), addend1.begin(), std::multiplies<>());
-        std::transform(a_swap_greaterequalthan0.begin(), a_swap_greaterequalthan0.end(), b_lessthan0.begin(), addend2.begin(), std::multiplies<>());
-        std::transform(a_lessthan0.begin(), a_lessthan0.end(), b_swap_greaterequalthan0.begin(), addend3.begin(), std::multiplies<>());
-        std::transform(a_swap_lessthan0.begin(), a_swap_lessthan0.end(), b_lessthan0.begin(), addend4.begin(), std::multiplies<>());
-        std::transform(addend1.begin(), addend1.end(), addend2.begin(), m_value.begin(), std::plus<>());
-        std::transform(m_value.begin(), m_value.end(), addend3.begin(), m_value.begin(), std::plus<>());
-        std::transform(m_value.begin(), m_value.end(), addend4.begin(), m_value.begin(), std::plus<>());
     };
   private:
-    std::vector<double> addend1;
-    std::vector<double> addend2;
-    std::vector<double> addend3;
-    std::vector<double> addend4;
-    std::vector<double> a_greaterequalthan0;
-    std::vector<double> a_lessthan0;
-    std::vector<double> b_greaterequalthan0;
-    std::vector<double> b_lessthan0;
-    std::vector<double> a_swap_greaterequalthan0;
-    std::vector<double> a_swap_lessthan0;
-    std::vector<double> b_swap_greaterequalthan0;
-    std::vector<double> b_swap_lessthan0;
+    std::vector<double> a_value;
+    std::vector<double> a_swap;
+    std::vector<double> b_value;
 };
 
 class Mult_vec_scalar: public Function
@@ -381,6 +371,16 @@ class Mult_vec_scalar: public Function
         m_arg2val = &arguments.at(1)->getValue()->at(0);
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override = 0;
+    // the same for all sign variants
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& a = *m_arguments[0];
+        const Expression& b = *m_arguments[1];
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        for (int i = 0; i < m_dim; ++i) {
+            interval::mult(a.getLower()[i], a.getUpper()[i], b.getLower()[0], b.getUpper()[0], m_lower[i], m_upper[i]);
+        }
+    };
   protected:
     std::vector<double>* m_arg1val;
     double* m_arg2val;
@@ -393,8 +393,8 @@ class Mult_vecNN_scalarNN: public Mult_vec_scalar
     };
     Mult_vecNN_scalarNN(const Mult_vecNN_scalarNN &old, const std::vector<Expression*>& arguments) : Mult_vec_scalar(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_value.begin(), [this](const double & c){return c * *m_arg2val;});
     };
 };
@@ -406,8 +406,8 @@ class Mult_vecNP_scalarNP: public Mult_vec_scalar
     };
     Mult_vecNP_scalarNP(const Mult_vecNP_scalarNP &old, const std::vector<Expression*>& arguments) : Mult_vec_scalar(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_value.begin(), [this](const double & c){return c * *m_arg2val;});
     };
 };
@@ -419,8 +419,8 @@ class Mult_vecNN_scalarNP: public Mult_vec_scalar
     };
     Mult_vecNN_scalarNP(const Mult_vecNN_scalarNP &old, const std::vector<Expression*>& arguments) : Mult_vec_scalar(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_value.begin(), [this](const double & c){return c * *m_arg2val;});
     };
 };
@@ -432,8 +432,8 @@ class Mult_vecNP_scalarNN: public Mult_vec_scalar
     };
     Mult_vecNP_scalarNN(const Mult_vecNP_scalarNN &old, const std::vector<Expression*>& arguments) : Mult_vec_scalar(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_value.begin(), [this](const double & c){return c * *m_arg2val;});
     };
 };
@@ -454,7 +454,7 @@ class Mult_vecU_scalarNN: public Mult_vec_scalar
         a_lessthan0 = old.a_lessthan0;
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
         for (size_t i=0;i<m_dim;++i) {
             if (m_arg1val->at(i) >= 0) {
                 a_greaterequalthan0.at(i) = m_arg1val->at(i);
@@ -464,9 +464,9 @@ class Mult_vecU_scalarNN: public Mult_vec_scalar
                 a_lessthan0.at(i) = m_arg1val->at(i);
             }
         }
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         b_swap = m_arguments.at(1)->getValue()->at(0);
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(a_greaterequalthan0.begin(), a_greaterequalthan0.end(), addend1.begin(), [this](const double & c){return c * *m_arg2val;});
         std::transform(a_lessthan0.begin(), a_lessthan0.end(), addend2.begin(), [this](const double & c){return c * b_swap;});
         std::transform(addend1.begin(), addend1.end(), addend2.begin(), m_value.begin(), std::plus<>());
@@ -486,11 +486,11 @@ class Mult_vecNN_scalarU: public Mult_vec_scalar
     };
     Mult_vecNN_scalarU(const Mult_vecNN_scalarU &old, const std::vector<Expression*>& arguments) : Mult_vec_scalar(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         if (*m_arg2val >= 0) {
-            m_arguments.at(0)->evaluate(x_in, y_in);
+            m_arguments.at(0)->evaluate_arg(x_in, y_in);
         } else {
-            m_arguments.at(0)->evaluate(y_in, x_in);
+            m_arguments.at(0)->evaluate_arg(y_in, x_in);
         }
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_value.begin(), [this](const double & c){return c * *m_arg2val;});
     };
@@ -512,7 +512,7 @@ class Mult_vecU_scalarNP: public Mult_vec_scalar
         a_lessthan0 = old.a_lessthan0;
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
         for (size_t i=0;i<m_dim;++i) {
             if (m_arg1val->at(i) >= 0) {
                 a_greaterequalthan0.at(i) = m_arg1val->at(i);
@@ -522,9 +522,9 @@ class Mult_vecU_scalarNP: public Mult_vec_scalar
                 a_lessthan0.at(i) = m_arg1val->at(i);
             }
         }
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         b_swap = m_arguments.at(1)->getValue()->at(0);
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(a_greaterequalthan0.begin(), a_greaterequalthan0.end(), addend1.begin(), [this](const double & c){return c * *m_arg2val;});
         std::transform(a_lessthan0.begin(), a_lessthan0.end(), addend2.begin(), [this](const double & c){return c * b_swap;});
         std::transform(addend1.begin(), addend1.end(), addend2.begin(), m_value.begin(), std::plus<>());
@@ -544,11 +544,11 @@ class Mult_vecNP_scalarU: public Mult_vec_scalar
     };
     Mult_vecNP_scalarU(const Mult_vecNP_scalarU &old, const std::vector<Expression*>& arguments) : Mult_vec_scalar(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         if (*m_arg2val >= 0) {
-            m_arguments.at(0)->evaluate(x_in, y_in);
+            m_arguments.at(0)->evaluate_arg(x_in, y_in);
         } else {
-            m_arguments.at(0)->evaluate(y_in, x_in);
+            m_arguments.at(0)->evaluate_arg(y_in, x_in);
         }
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_value.begin(), [this](const double & c){return c * *m_arg2val;});
     };
@@ -574,9 +574,9 @@ class Mult_vecU_scalarU: public Mult_vec_scalar
         a_swap_lessthan0 = old.a_swap_lessthan0;
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         b = *m_arg2val;
-        m_arguments.at(0)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
         for (size_t i = 0; i < m_dim; ++i) {
             if (m_arg1val->at(i) >= 0) {
                 a_greaterequalthan0.at(i) = m_arg1val->at(i);
@@ -586,8 +586,8 @@ class Mult_vecU_scalarU: public Mult_vec_scalar
                 a_lessthan0.at(i) = m_arg1val->at(i);
             }
         }
-        m_arguments.at(1)->evaluate(y_in, x_in);
-        m_arguments.at(0)->evaluate(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
         for (size_t i = 0; i < m_dim; ++i) {
             if (m_arg1val->at(i) >= 0) {
                 a_swap_greaterequalthan0.at(i) = m_arg1val->at(i);
@@ -632,9 +632,19 @@ class Div_Vec_Scalar: public Function
     };
     Div_Vec_Scalar(const Div_Vec_Scalar &old, const std::vector<Expression*>& arguments) : Function(old, arguments) {
         m_arg1val = arguments.at(0)->getValue();
-        m_arg2val = &arguments.at(0)->getValue()->at(0);
+        m_arg2val = &arguments.at(1)->getValue()->at(0);
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override = 0;
+    // the same for all sign variants
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& a = *m_arguments[0];
+        const Expression& b = *m_arguments[1];
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        for (int i = 0; i < m_dim; ++i) {
+            interval::div(a.getLower()[i], a.getUpper()[i], b.getLower()[0], b.getUpper()[0], m_lower[i], m_upper[i]);
+        }
+    };
   protected:
     std::vector<double>* m_arg1val;
     double* m_arg2val;
@@ -647,8 +657,8 @@ class Div_VecNN_ScalarNN: public Div_Vec_Scalar
     };
     Div_VecNN_ScalarNN(const Div_VecNN_ScalarNN &old, const std::vector<Expression*>& arguments) : Div_Vec_Scalar(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_value.begin(), [this](const double & c){return c / *m_arg2val;});
     };
 };
@@ -660,8 +670,8 @@ class Div_VecNP_ScalarNP: public Div_Vec_Scalar
     };
     Div_VecNP_ScalarNP(const Div_VecNP_ScalarNP &old, const std::vector<Expression*>& arguments) : Div_Vec_Scalar(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_value.begin(), [this](const double & c){return c / *m_arg2val;});
     };
 };
@@ -673,8 +683,8 @@ class Div_VecNN_ScalarNP: public Div_Vec_Scalar
     };
     Div_VecNN_ScalarNP(const Div_VecNN_ScalarNP &old, const std::vector<Expression*>& arguments) : Div_Vec_Scalar(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_value.begin(), [this](const double & c){return c / *m_arg2val;});
     };
 };
@@ -686,8 +696,8 @@ class Div_VecNP_ScalarNN: public Div_Vec_Scalar
     };
     Div_VecNP_ScalarNN(const Div_VecNP_ScalarNN &old, const std::vector<Expression*>& arguments) : Div_Vec_Scalar(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_value.begin(), [this](const double & c){return c / *m_arg2val;});
     };
 };
@@ -708,7 +718,7 @@ class Div_VecU_ScalarNN: public Div_Vec_Scalar
         a_lessthan0 = old.a_lessthan0;
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
         for (size_t i=0;i<m_dim;++i) {
             if (m_arg1val->at(i) >= 0) {
                 a_greaterequalthan0.at(i) = m_arg1val->at(i);
@@ -718,9 +728,9 @@ class Div_VecU_ScalarNN: public Div_Vec_Scalar
                 a_lessthan0.at(i) = m_arg1val->at(i);
             }
         }
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         b_swap = *m_arg2val;
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(a_greaterequalthan0.begin(), a_greaterequalthan0.end(), addend1.begin(), [this](const double & c){return c / b_swap;});
         std::transform(a_lessthan0.begin(), a_lessthan0.end(), addend2.begin(), [this](const double & c){return c / *m_arg2val;});
         std::transform(addend1.begin(), addend1.end(), addend2.begin(), m_value.begin(), std::plus<>());
@@ -749,7 +759,7 @@ class Div_VecU_ScalarNP: public Div_Vec_Scalar
         a_lessthan0 = old.a_lessthan0;
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
         for (size_t i=0;i<m_dim;++i) {
             if (m_arg1val->at(i) >= 0) {
                 a_greaterequalthan0.at(i) = m_arg1val->at(i);
@@ -759,9 +769,9 @@ class Div_VecU_ScalarNP: public Div_Vec_Scalar
                 a_lessthan0.at(i) = m_arg1val->at(i);
             }
         }
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         b_swap = *m_arg2val;
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(a_greaterequalthan0.begin(), a_greaterequalthan0.end(), addend1.begin(), [this](const double & c){return c / b_swap;});
         std::transform(a_lessthan0.begin(), a_lessthan0.end(), addend2.begin(), [this](const double & c){return c / *m_arg2val;});
         std::transform(addend1.begin(), addend1.end(), addend2.begin(), m_value.begin(), std::plus<>());
@@ -778,99 +788,93 @@ class Div_VecNN_ScalarU: public Div_Vec_Scalar
   public:
     Div_VecNN_ScalarU(Expression *a, Expression *b) : Div_Vec_Scalar(a, b) {
         this->m_sign = unknown;
+        a_value.resize(a->getDim());
+        a_swap.resize(a->getDim());
     };
-    Div_VecNN_ScalarU(const Div_VecNN_ScalarU &old, const std::vector<Expression*>& arguments) : Div_Vec_Scalar(old, arguments) {};
+    Div_VecNN_ScalarU(const Div_VecNN_ScalarU &old, const std::vector<Expression*>& arguments) : Div_Vec_Scalar(old, arguments) {
+        a_value = old.a_value;
+        a_swap = old.a_swap;
+        b_value = old.b_value;
+    };
+    // see split::div()
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(1)->evaluate(y_in, x_in);
-        if (*m_arg2val >= 0) {
-            m_arguments.at(0)->evaluate(x_in, y_in);
-        } else {
-            m_arguments.at(0)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        a_value = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        b_value = *m_arg2val;
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        a_swap = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        for (int i=0;i<m_dim;++i) {
+            m_value.at(i) = split::div(a_value.at(i), a_swap.at(i), b_value, *m_arg2val);
         }
-        std::transform(m_arg1val->begin(), m_arg1val->end(), m_value.begin(), [this](const double & c){return c / *m_arg2val;});
     };
+  private:
+    std::vector<double> a_value;
+    std::vector<double> a_swap;
+    double b_value;
 };
 class Div_VecNP_ScalarU: public Div_Vec_Scalar
 {
   public:
     Div_VecNP_ScalarU(Expression *a, Expression *b) : Div_Vec_Scalar(a, b) {
         this->m_sign = unknown;
+        a_value.resize(a->getDim());
+        a_swap.resize(a->getDim());
     };
-    Div_VecNP_ScalarU(const Div_VecNP_ScalarU &old, const std::vector<Expression*>& arguments) : Div_Vec_Scalar(old, arguments) {};
+    Div_VecNP_ScalarU(const Div_VecNP_ScalarU &old, const std::vector<Expression*>& arguments) : Div_Vec_Scalar(old, arguments) {
+        a_value = old.a_value;
+        a_swap = old.a_swap;
+        b_value = old.b_value;
+    };
+    // see split::div()
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(1)->evaluate(x_in, y_in);
-        if (*m_arg2val >= 0) {
-            m_arguments.at(0)->evaluate(x_in, y_in);
-        } else {
-            m_arguments.at(0)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        a_value = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        b_value = *m_arg2val;
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        a_swap = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        for (int i=0;i<m_dim;++i) {
+            m_value.at(i) = split::div(a_value.at(i), a_swap.at(i), b_value, *m_arg2val);
         }
-        std::transform(m_arg1val->begin(), m_arg1val->end(), m_value.begin(), [this](const double & c){return c / *m_arg2val;});
     };
+  private:
+    std::vector<double> a_value;
+    std::vector<double> a_swap;
+    double b_value;
 };
 class Div_VecU_ScalarU: public Div_Vec_Scalar
 {
   public:
     Div_VecU_ScalarU(Expression *a, Expression *b) : Div_Vec_Scalar(a, b) {
         this->m_sign = unknown;
-        addend1_2.resize(m_dim);
-        addend3_4.resize(m_dim);
-        a_greaterequalthan0.resize(m_dim);
-        a_lessthan0.resize(m_dim);
-        a_swap_greaterequalthan0.resize(m_dim);
-        a_swap_lessthan0.resize(m_dim);
+        a_value.resize(a->getDim());
+        a_swap.resize(a->getDim());
     };
     Div_VecU_ScalarU(const Div_VecU_ScalarU &old, const std::vector<Expression*>& arguments) : Div_Vec_Scalar(old, arguments) {
-        addend1_2 = old.addend1_2;
-        addend3_4 = old.addend3_4;
-        a_greaterequalthan0 = old.a_greaterequalthan0;
-        a_lessthan0 = old.a_lessthan0;
-        a_swap_greaterequalthan0 = old.a_swap_greaterequalthan0;
-        a_swap_lessthan0 = old.a_swap_lessthan0;
+        a_value = old.a_value;
+        a_swap = old.a_swap;
+        b_value = old.b_value;
     };
+    // see split::div()
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(1)->evaluate(x_in, y_in);
-        b = *m_arg2val;
-        m_arguments.at(1)->evaluate(y_in, x_in);
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_arg1val->at(i) >= 0) {
-                a_greaterequalthan0.at(i) = m_arg1val->at(i);
-                a_lessthan0.at(i) = 0;
-            } else {
-                a_greaterequalthan0.at(i) = 0;
-                a_lessthan0.at(i) = m_arg1val->at(i);
-            }
-        }
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_arg1val->at(i) >= 0) {
-                a_swap_greaterequalthan0.at(i) = m_arg1val->at(i);
-                a_swap_lessthan0.at(i) = 0;
-            } else {
-                a_swap_greaterequalthan0.at(i) = 0;
-                a_swap_lessthan0.at(i) = m_arg1val->at(i);
-            }
-        }
-        if (b >= 0) {
-            std::transform(a_lessthan0.begin(), a_lessthan0.end(), addend3_4.begin(), [this](const double & c){return c / b;});
-        } else {
-            std::transform(a_swap_lessthan0.begin(), a_swap_lessthan0.end(), addend3_4.begin(), [this](const double & c){return c / b;});
-        }
-        if (*m_arg2val >= 0) {
-            std::transform(a_greaterequalthan0.begin(), a_greaterequalthan0.end(), addend1_2.begin(), [this](const double & c){return c / *m_arg2val;});
-        } else {
-            std::transform(a_swap_greaterequalthan0.begin(), a_swap_greaterequalthan0.end(), addend1_2.begin(), [this](const double & c){return c / *m_arg2val;});
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        a_value = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        b_value = *m_arg2val;
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        a_swap = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        for (int i=0;i<m_dim;++i) {
+            m_value.at(i) = split::div(a_value.at(i), a_swap.at(i), b_value, *m_arg2val);
         }
-        std::transform(addend1_2.begin(), addend1_2.end(), addend3_4.begin(), m_value.begin(), std::plus<>());
     };
   private:
-    std::vector<double> addend1_2;
-    std::vector<double> addend3_4;
-    double b;
-    std::vector<double> a_greaterequalthan0;
-    std::vector<double> a_lessthan0;
-    std::vector<double> a_swap_greaterequalthan0;
-    std::vector<double> a_swap_lessthan0;
+    std::vector<double> a_value;
+    std::vector<double> a_swap;
+    double b_value;
 };
 
 class Div_Vec_Vec: public Function
@@ -888,6 +892,16 @@ class Div_Vec_Vec: public Function
         m_arg2val = arguments.at(1)->getValue();
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override = 0;
+    // the same for all sign variants
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& a = *m_arguments[0];
+        const Expression& b = *m_arguments[1];
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        for (int i = 0; i < m_dim; ++i) {
+            interval::div(a.getLower()[i], a.getUpper()[i], b.getLower()[i], b.getUpper()[i], m_lower[i], m_upper[i]);
+        }
+    };
   protected:
     std::vector<double>* m_arg1val;
     std::vector<double>* m_arg2val;
@@ -900,8 +914,8 @@ class Div_VecNN_VecNN: public Div_Vec_Vec
     };
     Div_VecNN_VecNN(const Div_VecNN_VecNN &old, const std::vector<Expression*>& arguments) : Div_Vec_Vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_arg2val->begin(), m_value.begin(), std::divides<>());
     };
 };
@@ -913,8 +927,8 @@ class Div_VecNP_VecNP: public Div_Vec_Vec
     };
     Div_VecNP_VecNP(const Div_VecNP_VecNP &old, const std::vector<Expression*>& arguments) : Div_Vec_Vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_arg2val->begin(), m_value.begin(), std::divides<>());
     };
 };
@@ -926,8 +940,8 @@ class Div_VecNN_VecNP: public Div_Vec_Vec
     };
     Div_VecNN_VecNP(const Div_VecNN_VecNP &old, const std::vector<Expression*>& arguments) : Div_Vec_Vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_arg2val->begin(), m_value.begin(), std::divides<>());
     };
 };
@@ -939,8 +953,8 @@ class Div_VecNP_VecNN: public Div_Vec_Vec
     };
     Div_VecNP_VecNN(const Div_VecNP_VecNN &old, const std::vector<Expression*>& arguments) : Div_Vec_Vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(m_arg1val->begin(), m_arg1val->end(), m_arg2val->begin(), m_value.begin(), std::divides<>());
     };
 };
@@ -962,7 +976,7 @@ class Div_VecU_VecNN: public Div_Vec_Vec
         a_lessthan0 = old.a_lessthan0;
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
         for (size_t i=0;i<m_dim;++i) {
             if (m_arg1val->at(i) >= 0) {
                 a_greaterequalthan0.at(i) = m_arg1val->at(i);
@@ -972,9 +986,9 @@ class Div_VecU_VecNN: public Div_Vec_Vec
                 a_lessthan0.at(i) = m_arg1val->at(i);
             }
         }
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         b_swap = *m_arg2val;
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(a_greaterequalthan0.begin(), a_greaterequalthan0.end(), b_swap.begin(),addend1.begin(), std::divides<>());
         std::transform(a_lessthan0.begin(), a_lessthan0.end(), m_arg2val->begin(), addend2.begin(),std::divides<>());
         std::transform(addend1.begin(), addend1.end(), addend2.begin(), m_value.begin(), std::plus<>());
@@ -1004,7 +1018,7 @@ class Div_VecU_VecNP: public Div_Vec_Vec
         a_lessthan0 = old.a_lessthan0;
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
         for (size_t i=0;i<m_dim;++i) {
             if (m_arg1val->at(i) >= 0) {
                 a_greaterequalthan0.at(i) = m_arg1val->at(i);
@@ -1014,9 +1028,9 @@ class Div_VecU_VecNP: public Div_Vec_Vec
                 a_lessthan0.at(i) = m_arg1val->at(i);
             }
         }
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         b_swap = *m_arg2val;
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(a_greaterequalthan0.begin(), a_greaterequalthan0.end(), b_swap.begin(),addend1.begin(), std::divides<>());
         std::transform(a_lessthan0.begin(), a_lessthan0.end(), m_arg2val->begin(), addend2.begin(),std::divides<>());
         std::transform(addend1.begin(), addend1.end(), addend2.begin(), m_value.begin(), std::plus<>());
@@ -1033,185 +1047,96 @@ class Div_VecNN_VecU: public Div_Vec_Vec
   public:
     Div_VecNN_VecU(Expression *a, Expression *b) : Div_Vec_Vec(a, b) {
         this->m_sign = unknown;
-        b_greaterequalthan0.resize(b->getDim());
-        b_lessthan0.resize(b->getDim());
+        a_value.resize(a->getDim());
         a_swap.resize(a->getDim());
-        addend1.resize(m_dim);
-        addend2.resize(m_dim);
+        b_value.resize(b->getDim());
     };
     Div_VecNN_VecU(const Div_VecNN_VecU &old, const std::vector<Expression*>& arguments) : Div_Vec_Vec(old, arguments) {
-        addend1 = old.addend1;
-        addend2 = old.addend2;
-        b_greaterequalthan0 = old.b_greaterequalthan0;
-        b_lessthan0 = old.b_lessthan0;
+        a_value = old.a_value;
+        a_swap = old.a_swap;
+        b_value = old.b_value;
     };
+    // see split::div()
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(1)->evaluate(y_in, x_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_arg2val->at(i) >= 0) {
-                b_greaterequalthan0.at(i) = m_arg2val->at(i);
-                b_lessthan0.at(i) = 0;
-            } else {
-                b_greaterequalthan0.at(i) = 0;
-                b_lessthan0.at(i) = m_arg2val->at(i);
-            }
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        a_value = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        b_value = *m_arg2val;
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        a_swap = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        for (int i=0;i<m_dim;++i) {
+            m_value.at(i) = split::div(a_value.at(i), a_swap.at(i), b_value.at(i), m_arg2val->at(i));
         }
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        a_swap = *m_arg2val;
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        std::transform(b_greaterequalthan0.begin(), b_greaterequalthan0.end(), m_arg2val->begin(),addend1.begin(), std::divides<>());
-        std::transform(b_lessthan0.begin(), b_lessthan0.end(), a_swap.begin(), addend2.begin(),std::divides<>());
-        std::transform(addend1.begin(), addend1.end(), addend2.begin(), m_value.begin(), std::plus<>());
     };
   private:
-    std::vector<double> addend1;
-    std::vector<double> addend2;
+    std::vector<double> a_value;
     std::vector<double> a_swap;
-    std::vector<double> b_greaterequalthan0;
-    std::vector<double> b_lessthan0;
+    std::vector<double> b_value;
 };
 class Div_VecNP_VecU: public Div_Vec_Vec
 {
   public:
     Div_VecNP_VecU(Expression *a, Expression *b) : Div_Vec_Vec(a, b) {
         this->m_sign = unknown;
-        b_greaterequalthan0.resize(b->getDim());
-        b_lessthan0.resize(b->getDim());
+        a_value.resize(a->getDim());
         a_swap.resize(a->getDim());
-        addend1.resize(m_dim);
-        addend2.resize(m_dim);
+        b_value.resize(b->getDim());
     };
     Div_VecNP_VecU(const Div_VecNP_VecU &old, const std::vector<Expression*>& arguments) : Div_Vec_Vec(old, arguments) {
-        addend1 = old.addend1;
-        addend2 = old.addend2;
-        b_greaterequalthan0 = old.b_greaterequalthan0;
-        b_lessthan0 = old.b_lessthan0;
+        a_value = old.a_value;
+        a_swap = old.a_swap;
+        b_value = old.b_value;
     };
+    // see split::div()
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(1)->evaluate(x_in, y_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_arg2val->at(i) >= 0) {
-                b_greaterequalthan0.at(i) = m_arg2val->at(i);
-                b_lessthan0.at(i) = 0;
-            } else {
-                b_greaterequalthan0.at(i) = 0;
-                b_lessthan0.at(i) = m_arg2val->at(i);
-            }
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        a_value = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        b_value = *m_arg2val;
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        a_swap = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        for (int i=0;i<m_dim;++i) {
+            m_value.at(i) = split::div(a_value.at(i), a_swap.at(i), b_value.at(i), m_arg2val->at(i));
         }
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        a_swap = *m_arg2val;
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        std::transform(b_greaterequalthan0.begin(), b_greaterequalthan0.end(), m_arg2val->begin(),addend1.begin(), std::divides<>());
-        std::transform(b_lessthan0.begin(), b_lessthan0.end(), a_swap.begin(), addend2.begin(),std::divides<>());
-        std::transform(addend1.begin(), addend1.end(), addend2.begin(), m_value.begin(), std::plus<>());
     };
   private:
-    std::vector<double> addend1;
-    std::vector<double> addend2;
+    std::vector<double> a_value;
     std::vector<double> a_swap;
-    std::vector<double> b_greaterequalthan0;
-    std::vector<double> b_lessthan0;
+    std::vector<double> b_value;
 };
 class Div_VecU_VecU: public Div_Vec_Vec
 {
   public:
     Div_VecU_VecU(Expression *a, Expression *b) : Div_Vec_Vec(a, b) {
         this->m_sign = unknown;
-        a_greaterequalthan0.resize(m_dim);
-        a_lessthan0.resize(m_dim);
-        a_swap_greaterequalthan0.resize(m_dim);
-        a_swap_lessthan0.resize(m_dim);
-        b_greaterequalthan0.resize(m_dim);
-        b_lessthan0.resize(m_dim);
-        b_swap_greaterequalthan0.resize(m_dim);
-        b_swap_lessthan0.resize(m_dim);
+        a_value.resize(a->getDim());
+        a_swap.resize(a->getDim());
+        b_value.resize(b->getDim());
     };
     Div_VecU_VecU(const Div_VecU_VecU &old, const std::vector<Expression*>& arguments) : Div_Vec_Vec(old, arguments) {
-        a_greaterequalthan0 = old.a_greaterequalthan0;
-        a_lessthan0 = old.a_lessthan0;
-        a_swap_greaterequalthan0 = old.a_swap_greaterequalthan0;
-        a_swap_lessthan0 = old.a_swap_lessthan0;
-        b_greaterequalthan0 = old.b_greaterequalthan0;
-        b_lessthan0 = old.b_lessthan0;
-        b_swap_greaterequalthan0 = old.b_swap_greaterequalthan0;
-        b_swap_lessthan0 = old.b_swap_lessthan0;
+        a_value = old.a_value;
+        a_swap = old.a_swap;
+        b_value = old.b_value;
     };
+    // see split::div()
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        // Construction of cases
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_arg1val->at(i) >= 0) {
-                a_greaterequalthan0.at(i) = m_arg1val->at(i);
-                a_lessthan0.at(i) = 0;
-            } else {
-                a_greaterequalthan0.at(i) = 0;
-                a_lessthan0.at(i) = m_arg1val->at(i);
-            }
-            if (m_arg2val->at(i) >= 0) {
-                b_greaterequalthan0.at(i) = m_arg2val->at(i);
-                b_lessthan0.at(i) = 0;
-            } else {
-                b_greaterequalthan0.at(i) = 0;
-                b_lessthan0.at(i) = m_arg2val->at(i);
-            }
-        }
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(y_in, x_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_arg1val->at(i) >= 0) {
-                a_swap_greaterequalthan0.at(i) = m_arg1val->at(i);
-                a_swap_lessthan0.at(i) = 0;
-            } else {
-                a_swap_greaterequalthan0.at(i) = 0;
-                a_swap_lessthan0.at(i) = m_arg1val->at(i);
-            }
-            if (m_arg2val->at(i) >= 0) {
-                b_swap_greaterequalthan0.at(i) = m_arg2val->at(i);
-                b_swap_lessthan0.at(i) = 0;
-            } else {
-                b_swap_greaterequalthan0.at(i) = 0;
-                b_swap_lessthan0.at(i) = m_arg2val->at(i);
-            }
-        }
-        double tmp1;
-        double tmp2;
-        double tmp3;
-        double tmp4;
-        // Evaluation with zeros being ignored
-        for (size_t i=0;i<m_dim;++i) {
-            if (b_swap_greaterequalthan0.at(i) == 0) {
-                tmp1 = 0;
-            } else {
-                tmp1 = a_greaterequalthan0.at(i) / b_swap_greaterequalthan0.at(i);
-            }
-            if (b_swap_lessthan0.at(i) == 0) {
-                tmp2 = 0;
-            } else {
-                tmp2 = a_swap_greaterequalthan0.at(i) / b_swap_lessthan0.at(i);
-            }
-            if (b_greaterequalthan0.at(i) == 0) {
-                tmp3 = 0;
-            } else {
-                tmp3 = a_lessthan0.at(i) / b_greaterequalthan0.at(i);
-            }
-            if (b_lessthan0.at(i) == 0) {
-                tmp4 = 0;
-            } else {
-                tmp4 = a_swap_lessthan0.at(i) / b_lessthan0.at(i);
-            }
-            m_value.at(i) = tmp1 + tmp2 + tmp3 + tmp4;
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        a_value = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        b_value = *m_arg2val;
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        a_swap = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        for (int i=0;i<m_dim;++i) {
+            m_value.at(i) = split::div(a_value.at(i), a_swap.at(i), b_value.at(i), m_arg2val->at(i));
         }
     };
   private:
-    std::vector<double> a_greaterequalthan0;
-    std::vector<double> a_lessthan0;
-    std::vector<double> a_swap_greaterequalthan0;
-    std::vector<double> a_swap_lessthan0;
-    std::vector<double> b_greaterequalthan0;
-    std::vector<double> b_lessthan0;
-    std::vector<double> b_swap_greaterequalthan0;
-    std::vector<double> b_swap_lessthan0;
+    std::vector<double> a_value;
+    std::vector<double> a_swap;
+    std::vector<double> b_value;
 };
 
 class Div_Scalar_Vec: public Function
@@ -1229,6 +1154,16 @@ class Div_Scalar_Vec: public Function
         m_arg2val = arguments.at(1)->getValue();
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {};
+    // the same for all sign variants
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& a = *m_arguments[0];
+        const Expression& b = *m_arguments[1];
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        for (int i = 0; i < m_dim; ++i) {
+            interval::div(a.getLower()[0], a.getUpper()[0], b.getLower()[i], b.getUpper()[i], m_lower[i], m_upper[i]);
+        }
+    };
   protected:
     double* m_arg1val;
     std::vector<double>* m_arg2val;
@@ -1241,8 +1176,8 @@ class Div_ScalarNN_VecNN: public Div_Scalar_Vec
     };
     Div_ScalarNN_VecNN(const Div_ScalarNN_VecNN &old, const std::vector<Expression*>& arguments) : Div_Scalar_Vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         std::transform(m_arg2val->begin(), m_arg2val->end(), m_value.begin(), [this](const double & c){return *m_arg1val / c;});
     };
 };
@@ -1254,8 +1189,8 @@ class Div_ScalarNP_VecNP: public Div_Scalar_Vec
     };
     Div_ScalarNP_VecNP(const Div_ScalarNP_VecNP &old, const std::vector<Expression*>& arguments) : Div_Scalar_Vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(m_arg2val->begin(), m_arg2val->end(), m_value.begin(), [this](const double & c){return *m_arg1val / c;});
     };
 };
@@ -1267,8 +1202,8 @@ class Div_ScalarNN_VecNP: public Div_Scalar_Vec
     };
     Div_ScalarNN_VecNP(const Div_ScalarNN_VecNP &old, const std::vector<Expression*>& arguments) : Div_Scalar_Vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         std::transform(m_arg2val->begin(), m_arg2val->end(), m_value.begin(), [this](const double & c){return *m_arg1val / c;});
     };
 };
@@ -1280,8 +1215,8 @@ class Div_ScalarNP_VecNN: public Div_Scalar_Vec
     };
     Div_ScalarNP_VecNN(const Div_ScalarNP_VecNN &old, const std::vector<Expression*>& arguments) : Div_Scalar_Vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         std::transform(m_arg2val->begin(), m_arg2val->end(), m_value.begin(), [this](const double & c){return *m_arg1val / c;});
     };
 };
@@ -1292,14 +1227,16 @@ class Div_ScalarU_VecNN: public Div_Scalar_Vec
         this->m_sign = unknown;
     };
     Div_ScalarU_VecNN(const Div_ScalarU_VecNN &old, const std::vector<Expression*>& arguments) : Div_Scalar_Vec(old, arguments) {};
+    // a/b is nondecreasing in a, and in b nonincreasing for a >= 0 and nondecreasing otherwise
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        if (*m_arg1val >= 0) {
-            m_arguments.at(0)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        const double a = *m_arg1val;
+        if (a >= 0) {
+            m_arguments.at(1)->evaluate_arg(y_in, x_in);
         } else {
-            m_arguments.at(0)->evaluate(x_in, y_in);
+            m_arguments.at(1)->evaluate_arg(x_in, y_in);
         }
-        std::transform(m_arg2val->begin(), m_arg2val->end(), m_value.begin(), [this](const double & c){return *m_arg1val / c;});
+        std::transform(m_arg2val->begin(), m_arg2val->end(), m_value.begin(), [a](const double & c){return a / c;});
     };
 };
 class Div_ScalarU_VecNP: public Div_Scalar_Vec
@@ -1309,14 +1246,16 @@ class Div_ScalarU_VecNP: public Div_Scalar_Vec
         this->m_sign = unknown;
     };
     Div_ScalarU_VecNP(const Div_ScalarU_VecNP &old, const std::vector<Expression*>& arguments) : Div_Scalar_Vec(old, arguments) {};
+    // a/b is nonincreasing in a, and in b nonincreasing for a >= 0 and nondecreasing otherwise
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        if (*m_arg1val >= 0) {
-            m_arguments.at(0)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        const double a = *m_arg1val;
+        if (a >= 0) {
+            m_arguments.at(1)->evaluate_arg(y_in, x_in);
         } else {
-            m_arguments.at(0)->evaluate(x_in, y_in);
+            m_arguments.at(1)->evaluate_arg(x_in, y_in);
         }
-        std::transform(m_arg2val->begin(), m_arg2val->end(), m_value.begin(), [this](const double & c){return *m_arg1val / c;});
+        std::transform(m_arg2val->begin(), m_arg2val->end(), m_value.begin(), [a](const double & c){return a / c;});
     };
 };
 class Div_ScalarNN_VecU: public Div_Scalar_Vec
@@ -1324,163 +1263,90 @@ class Div_ScalarNN_VecU: public Div_Scalar_Vec
   public:
     Div_ScalarNN_VecU(Expression *a, Expression *b) : Div_Scalar_Vec(a, b) {
         this->m_sign = unknown;
-        b_greaterequalthan0.resize(b->getDim());
-        b_lessthan0.resize(b->getDim());
-        addend1.resize(m_dim);
-        addend2.resize(m_dim);
+        b_value.resize(b->getDim());
     };
     Div_ScalarNN_VecU(const Div_ScalarNN_VecU &old, const std::vector<Expression*>& arguments) : Div_Scalar_Vec(old, arguments) {
-        addend1 = old.addend1;
-        addend2 = old.addend2;
-        b_greaterequalthan0 = old.b_greaterequalthan0;
-        b_lessthan0 = old.b_lessthan0;
+        a_value = old.a_value;
+        a_swap = old.a_swap;
+        b_value = old.b_value;
     };
+    // see split::div()
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(1)->evaluate(y_in, x_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_arg2val->at(i) >= 0) {
-                b_greaterequalthan0.at(i) = m_arg2val->at(i);
-                b_lessthan0.at(i) = 0;
-            } else {
-                b_greaterequalthan0.at(i) = 0;
-                b_lessthan0.at(i) = m_arg2val->at(i);
-            }
-        }
-        m_arguments.at(0)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        a_value = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        b_value = *m_arg2val;
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
         a_swap = *m_arg1val;
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        std::transform(b_greaterequalthan0.begin(), b_greaterequalthan0.end(), addend1.begin(), [this](const double & c){return *m_arg1val / c;});
-        std::transform(b_lessthan0.begin(), b_lessthan0.end(), addend2.begin(),[this](const double & c){return a_swap / c;});
-        std::transform(addend1.begin(), addend1.end(), addend2.begin(), m_value.begin(), std::plus<>());
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        for (int i=0;i<m_dim;++i) {
+            m_value.at(i) = split::div(a_value, a_swap, b_value.at(i), m_arg2val->at(i));
+        }
     };
   private:
-    std::vector<double> addend1;
-    std::vector<double> addend2;
+    double a_value;
     double a_swap;
-    std::vector<double> b_greaterequalthan0;
-    std::vector<double> b_lessthan0;
+    std::vector<double> b_value;
 };
 class Div_ScalarNP_VecU: public Div_Scalar_Vec
 {
   public:
     Div_ScalarNP_VecU(Expression *a, Expression *b) : Div_Scalar_Vec(a, b) {
         this->m_sign = unknown;
-        b_greaterequalthan0.resize(b->getDim());
-        b_lessthan0.resize(b->getDim());
-        addend1.resize(m_dim);
-        addend2.resize(m_dim);
+        b_value.resize(b->getDim());
     };
     Div_ScalarNP_VecU(const Div_ScalarNP_VecU &old, const std::vector<Expression*>& arguments) : Div_Scalar_Vec(old, arguments) {
-        addend1 = old.addend1;
-        addend2 = old.addend2;
-        b_greaterequalthan0 = old.b_greaterequalthan0;
-        b_lessthan0 = old.b_lessthan0;
+        a_value = old.a_value;
+        a_swap = old.a_swap;
+        b_value = old.b_value;
     };
+    // see split::div()
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(1)->evaluate(x_in, y_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_arg2val->at(i) >= 0) {
-                b_greaterequalthan0.at(i) = m_arg2val->at(i);
-                b_lessthan0.at(i) = 0;
-            } else {
-                b_greaterequalthan0.at(i) = 0;
-                b_lessthan0.at(i) = m_arg2val->at(i);
-            }
-        }
-        m_arguments.at(0)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        a_value = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        b_value = *m_arg2val;
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
         a_swap = *m_arg1val;
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        std::transform(b_greaterequalthan0.begin(), b_greaterequalthan0.end(), addend1.begin(), [this](const double & c){return *m_arg1val / c;});
-        std::transform(b_lessthan0.begin(), b_lessthan0.end(), addend2.begin(),[this](const double & c){return a_swap / c;});
-        std::transform(addend1.begin(), addend1.end(), addend2.begin(), m_value.begin(), std::plus<>());
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        for (int i=0;i<m_dim;++i) {
+            m_value.at(i) = split::div(a_value, a_swap, b_value.at(i), m_arg2val->at(i));
+        }
     };
   private:
-    std::vector<double> addend1;
-    std::vector<double> addend2;
+    double a_value;
     double a_swap;
-    std::vector<double> b_greaterequalthan0;
-    std::vector<double> b_lessthan0;
+    std::vector<double> b_value;
 };
 class Div_ScalarU_VecU: public Div_Scalar_Vec
 {
   public:
     Div_ScalarU_VecU(Expression *a, Expression *b) : Div_Scalar_Vec(a, b) {
         this->m_sign = unknown;
-        b_greaterequalthan0.resize(m_dim);
-        b_lessthan0.resize(m_dim);
-        b_swap_greaterequalthan0.resize(m_dim);
-        b_swap_lessthan0.resize(m_dim);
+        b_value.resize(b->getDim());
     };
     Div_ScalarU_VecU(const Div_ScalarU_VecU &old, const std::vector<Expression*>& arguments) : Div_Scalar_Vec(old, arguments) {
-        b_greaterequalthan0 = old.b_greaterequalthan0;
-        b_lessthan0 = old.b_lessthan0;
-        b_swap_greaterequalthan0 = old.b_swap_greaterequalthan0;
-        b_swap_lessthan0 = old.b_swap_lessthan0;
+        a_value = old.a_value;
+        a_swap = old.a_swap;
+        b_value = old.b_value;
     };
+    // see split::div()
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        // Construction of cases
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        a = *m_arg1val;
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_arg2val->at(i) >= 0) {
-                b_greaterequalthan0.at(i) = m_arg2val->at(i);
-                b_lessthan0.at(i) = 0;
-            } else {
-                b_greaterequalthan0.at(i) = 0;
-                b_lessthan0.at(i) = m_arg2val->at(i);
-            }
-        }
-        m_arguments.at(1)->evaluate(y_in, x_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_arg2val->at(i) >= 0) {
-                b_swap_greaterequalthan0.at(i) = m_arg2val->at(i);
-                b_swap_lessthan0.at(i) = 0;
-            } else {
-                b_swap_greaterequalthan0.at(i) = 0;
-                b_swap_lessthan0.at(i) = m_arg2val->at(i);
-            }
-        }
-        double tmp1_3;
-        double tmp2_4;
-        // Evaluation with zeros being ignored
-        for (size_t i=0;i<m_dim;++i) {
-            if (a >= 0) {
-                if (b_swap_greaterequalthan0.at(i) == 0) {
-                    tmp1_3 = 0;
-                } else {
-                    tmp1_3 = a / b_swap_greaterequalthan0.at(i);
-                }
-            } else {
-                if (b_greaterequalthan0.at(i) == 0) {
-                    tmp1_3 = 0;
-                } else {
-                    tmp1_3 = a / b_greaterequalthan0.at(i);
-                }
-            }
-            if (*m_arg1val >= 0) {
-                if (b_swap_lessthan0.at(i) == 0) {
-                    tmp2_4 = 0;
-                } else {
-                    tmp2_4 = *m_arg1val / b_swap_lessthan0.at(i);
-                }
-            } else {
-                if (b_lessthan0.at(i) == 0) {
-                    tmp2_4 = 0;
-                } else {
-                    tmp2_4 = *m_arg1val / b_lessthan0.at(i);
-                }
-            }
-            m_value.at(i) = tmp1_3 + tmp2_4;
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        a_value = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        b_value = *m_arg2val;
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        a_swap = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        for (int i=0;i<m_dim;++i) {
+            m_value.at(i) = split::div(a_value, a_swap, b_value.at(i), m_arg2val->at(i));
         }
     };
   private:
-    double a;
-    std::vector<double> b_greaterequalthan0;
-    std::vector<double> b_lessthan0;
-    std::vector<double> b_swap_greaterequalthan0;
-    std::vector<double> b_swap_lessthan0;
+    double a_value;
+    double a_swap;
+    std::vector<double> b_value;
 };
 
 class Dot: public Function
@@ -1498,6 +1364,21 @@ class Dot: public Function
         m_arg2val = arguments.at(1)->getValue();
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override = 0;
+    // the same for all sign variants
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& a = *m_arguments[0];
+        const Expression& b = *m_arguments[1];
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        m_lower[0] = 0;
+        m_upper[0] = 0;
+        for (size_t i = 0; i < a.getLower().size(); ++i) {
+            double lo, hi;
+            interval::mult(a.getLower()[i], a.getUpper()[i], b.getLower()[i], b.getUpper()[i], lo, hi);
+            m_lower[0] += lo;
+            m_upper[0] += hi;
+        }
+    };
   protected:
     std::vector<double>* m_arg1val;
     std::vector<double>* m_arg2val;
@@ -1510,8 +1391,8 @@ class Dot_NN_NN: public Dot
     };
     Dot_NN_NN(const Dot_NN_NN &old, const std::vector<Expression*>& arguments) : Dot(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         m_value.at(0) = std::inner_product(m_arg1val->begin(), m_arg1val->end(), m_arg2val->begin(), (double)0);
     };
 };
@@ -1523,8 +1404,8 @@ class Dot_NP_NP: public Dot
     };
     Dot_NP_NP(const Dot_NP_NP &old, const std::vector<Expression*>& arguments) : Dot(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         m_value.at(0) = std::inner_product(m_arg1val->begin(), m_arg1val->end(), m_arg2val->begin(), (double)0);
     };
 };
@@ -1536,8 +1417,8 @@ class Dot_NN_NP: public Dot
     };
     Dot_NN_NP(const Dot_NN_NP &old, const std::vector<Expression*>& arguments) : Dot(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         m_value.at(0) = std::inner_product(m_arg1val->begin(), m_arg1val->end(), m_arg2val->begin(), (double)0);
     };
 };
@@ -1554,7 +1435,7 @@ class Dot_U_NN: public Dot
         a_lessthan0 = old.a_lessthan0;
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
         for (size_t i=0;i<m_arg1val->size();++i) {
             if (m_arg1val->at(i) >= 0) {
                 a_greaterequalthan0.at(i) = m_arg1val->at(i);
@@ -1564,9 +1445,9 @@ class Dot_U_NN: public Dot
                 a_lessthan0.at(i) = m_arg1val->at(i);
             }
         }
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         b_swap = *m_arguments.at(1)->getValue();
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         m_value.at(0) = std::inner_product(a_greaterequalthan0.begin(), a_greaterequalthan0.end(), m_arg2val->begin(), (double)0);
         m_value.at(0) += std::inner_product(a_lessthan0.begin(), a_lessthan0.end(), b_swap.begin(), (double)0);
     };
@@ -1588,8 +1469,8 @@ class Dot_U_NP: public Dot
         a_lessthan0 = old.a_lessthan0;
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        for (size_t i=0;i<m_dim;++i) {
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        for (size_t i=0;i<m_arg1val->size();++i) {
             if (m_arg1val->at(i) >= 0) {
                 a_greaterequalthan0.at(i) = m_arg1val->at(i);
                 a_lessthan0.at(i) = 0;
@@ -1598,9 +1479,9 @@ class Dot_U_NP: public Dot
                 a_lessthan0.at(i) = m_arg1val->at(i);
             }
         }
-        m_arguments.at(1)->evaluate(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
         b_swap = *m_arguments.at(1)->getValue();
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         m_value.at(0) = std::inner_product(a_greaterequalthan0.begin(), a_greaterequalthan0.end(), m_arg2val->begin(), (double)0);
         m_value.at(0) = std::inner_product(a_lessthan0.begin(), a_lessthan0.end(), b_swap.begin(), m_value.at(0));
     };
@@ -1614,102 +1495,85 @@ class Dot_U_U: public Dot
   public:
     Dot_U_U(Expression *a, Expression *b) : Dot(a, b) {
         this->m_sign = unknown;
-        a_greaterequalthan0.resize(m_dim);
-        a_lessthan0.resize(m_dim);
-        b_greaterequalthan0.resize(m_dim);
-        b_lessthan0.resize(m_dim);
-        a_swap_greaterequalthan0.resize(m_dim);
-        a_swap_lessthan0.resize(m_dim);
-        b_swap_greaterequalthan0.resize(m_dim);
-        b_swap_lessthan0.resize(m_dim);
-        addend1.resize(m_dim);
-        addend2.resize(m_dim);
-        addend3.resize(m_dim);
-        addend4.resize(m_dim);
+        a_value.resize(a->getDim());
+        a_swap.resize(a->getDim());
+        b_value.resize(b->getDim());
     };
     Dot_U_U(const Dot_U_U &old, const std::vector<Expression*>& arguments) : Dot(old, arguments) {
-        addend1 = old.addend1;
-        addend2 = old.addend2;
-        addend3 = old.addend3;
-        addend4 = old.addend4;
-        a_greaterequalthan0 = old.a_greaterequalthan0;
-        a_lessthan0 = old.a_lessthan0;
-        a_swap_greaterequalthan0 = old.a_swap_greaterequalthan0;
-        a_swap_lessthan0 = old.a_swap_lessthan0;
-        b_greaterequalthan0 = old.b_greaterequalthan0;
-        b_lessthan0 = old.b_lessthan0;
-        b_swap_greaterequalthan0 = old.b_swap_greaterequalthan0;
-        b_swap_lessthan0 = old.b_swap_lessthan0;
+        a_value = old.a_value;
+        a_swap = old.a_swap;
+        b_value = old.b_value;
     };
+    // see split::mult()
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_arg1val->at(i) >= 0) {
-                a_greaterequalthan0.at(i) = m_arg1val->at(i);
-                a_lessthan0.at(i) = 0;
-                b_greaterequalthan0.at(i) = m_arg2val->at(i);
-                b_lessthan0.at(i) = 0;
-            } else {
-                a_greaterequalthan0.at(i) = 0;
-                a_lessthan0.at(i) = m_arg1val->at(i);
-                b_greaterequalthan0.at(i) = 0;
-                b_lessthan0.at(i) = m_arg2val->at(i);
-            }
-        }
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(y_in, x_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_arg1val->at(i) >= 0) {
-                a_swap_greaterequalthan0.at(i) = m_arg1val->at(i);
-                a_swap_lessthan0.at(i) = 0;
-                b_swap_greaterequalthan0.at(i) = m_arg2val->at(i);
-                b_swap_lessthan0.at(i) = 0;
-            } else {
-                a_swap_greaterequalthan0.at(i) = 0;
-                a_swap_lessthan0.at(i) = m_arg1val->at(i);
-                b_swap_greaterequalthan0.at(i) = 0;
-                b_swap_lessthan0.at(i) = m_arg2val->at(i);
-            }
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        a_value = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        b_value = *m_arg2val;
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        a_swap = *m_arg1val;
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        double r = 0;
+        for (size_t i=0;i<a_value.size();++i) {
+            r += split::mult(a_value.at(i), a_swap.at(i), b_value.at(i), m_arg2val->at(i));
         }
-        m_value.at(0) = std::inner_product(a_greaterequalthan0.begin(), a_greaterequalthan0.end(), b_greaterequalthan0.begin(), (double)0);
-        m_value.at(0) = std::inner_product(a_swap_greaterequalthan0.begin(), a_swap_greaterequalthan0.end(), b_lessthan0.begin(), m_value.at(0));
-        m_value.at(0) = std::inner_product(a_lessthan0.begin(), a_lessthan0.end(), b_swap_greaterequalthan0.begin(), m_value.at(0));
-        m_value.at(0) = std::inner_product(a_swap_lessthan0.begin(), a_swap_lessthan0.end(), b_swap_lessthan0.begin(), m_value.at(0));
+        m_value.at(0) = r;
     };
   private:
-    std::vector<double> addend1;
-    std::vector<double> addend2;
-    std::vector<double> addend3;
-    std::vector<double> addend4;
-    std::vector<double> a_greaterequalthan0;
-    std::vector<double> a_lessthan0;
-    std::vector<double> b_greaterequalthan0;
-    std::vector<double> b_lessthan0;
-    std::vector<double> a_swap_greaterequalthan0;
-    std::vector<double> a_swap_lessthan0;
-    std::vector<double> b_swap_greaterequalthan0;
-    std::vector<double> b_swap_lessthan0;
+    std::vector<double> a_value;
+    std::vector<double> a_swap;
+    std::vector<double> b_value;
 };
 
 class Mult_Mat_Vec: public Function
 {
   public:
     Mult_Mat_Vec(MultiDimParameter *mat, Expression *a) : Function(mat, a, "dot_mat") {
-        this->m_dim = mat->getValue()->getDim().at(0);
+        this->m_dim = mat->getValue()->getRows();
         this->m_value.resize(m_dim);
 
         this->m_vecval = a->getValue();
         this->m_matval = mat->getValue();
+        this->m_mat = gemv::columnMajor(m_matval->getRows(), m_matval->getCols(), m_matval->getData());
     };
     Mult_Mat_Vec(const Mult_Mat_Vec &old, const std::vector<Expression*>& arguments) : Function(old, arguments) {
         m_matval = dynamic_cast<MultiDimParameter*>(arguments.at(0))->getValue();
         m_vecval = arguments.at(1)->getValue();
+        m_mat = old.m_mat;
+        a_greaterequalthan0 = old.a_greaterequalthan0;
+        a_lessthan0 = old.a_lessthan0;
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override = 0;
+    // the same for all sign variants, the matrix is constant
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& a = *m_arguments[1];
+        const size_t cols = m_matval->getCols();
+        m_lower.assign(m_dim, 0);
+        m_upper.assign(m_dim, 0);
+        for (size_t j = 0; j < cols; ++j) {
+            const double* c = m_mat.data() + j * m_dim;
+            const double lo = a.getLower()[j], hi = a.getUpper()[j];
+            for (int r = 0; r < m_dim; ++r) {
+                m_lower[r] += c[r] * (c[r] >= 0 ? lo : hi);
+                m_upper[r] += c[r] * (c[r] >= 0 ? hi : lo);
+            }
+        }
+    };
   protected:
+    // m_value = matrix * vec
+    void multiply(const std::vector<double>& vec) {
+        gemv::mult(m_dim, m_matval->getCols(), m_mat.data(), vec.data(), m_value.data());
+    };
+    // m_value = pos(matrix) * b + neg(matrix) * bs, the parts are split once in the constructor
+    void multiplySplit(const std::vector<double>& b, const std::vector<double>& bs) {
+        gemv::multSplit(m_dim, m_matval->getCols(), a_greaterequalthan0.data(), a_lessthan0.data(), b.data(), bs.data(), m_value.data());
+    };
     std::vector<double>* m_vecval;
     Matrix* m_matval;
+    // the (constant) matrix column-major, and its parts >= 0 and < 0 for the variants MatU
+    std::vector<double> m_mat;
+    std::vector<double> a_greaterequalthan0;
+    std::vector<double> a_lessthan0;
 };
 class Mult_MatNN_VecNN: public Mult_Mat_Vec
 {
@@ -1719,11 +1583,9 @@ class Mult_MatNN_VecNN: public Mult_Mat_Vec
     };
     Mult_MatNN_VecNN(const Mult_MatNN_VecNN &old, const std::vector<Expression*>& arguments) : Mult_Mat_Vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
-        for (int row=0; row < m_dim; ++row) {
-            m_value.at(row) = std::inner_product(m_matval->getRowIt(row), m_matval->getRowIt(row) + m_matval->getDim().at(1), m_vecval->begin(), (double)0);
-        }
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        multiply(*m_vecval);
     };
 };
 class Mult_MatNP_VecNP: public Mult_Mat_Vec
@@ -1734,11 +1596,9 @@ class Mult_MatNP_VecNP: public Mult_Mat_Vec
     };
     Mult_MatNP_VecNP(const Mult_MatNP_VecNP &old, const std::vector<Expression*>& arguments) : Mult_Mat_Vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(y_in, x_in);
-        for (int row=0; row < m_dim; ++row) {
-            m_value.at(row) = std::inner_product(m_matval->getRowIt(row), m_matval->getRowIt(row) + m_matval->getDim().at(1), m_vecval->begin(), (double)0);
-        }
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        multiply(*m_vecval);
     };
 };
 class Mult_MatNN_VecNP: public Mult_Mat_Vec
@@ -1749,11 +1609,9 @@ class Mult_MatNN_VecNP: public Mult_Mat_Vec
     };
     Mult_MatNN_VecNP(const Mult_MatNN_VecNP &old, const std::vector<Expression*>& arguments) : Mult_Mat_Vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        m_arguments.at(1)->evaluate(x_in, y_in);
-        for (int row=0; row < m_dim; ++row) {
-            m_value.at(row) = std::inner_product(m_matval->getRowIt(row), m_matval->getRowIt(row) + m_matval->getDim().at(1), m_vecval->begin(), (double)0);
-        }
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        multiply(*m_vecval);
     };
 };
 class Mult_MatNP_VecNN: public Mult_Mat_Vec
@@ -1764,11 +1622,9 @@ class Mult_MatNP_VecNN: public Mult_Mat_Vec
     };
     Mult_MatNP_VecNN(const Mult_MatNP_VecNN &old, const std::vector<Expression*>& arguments) : Mult_Mat_Vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_arguments.at(1)->evaluate(y_in, x_in);
-        for (int row=0; row < m_dim; ++row) {
-            m_value.at(row) = std::inner_product(m_matval->getRowIt(row), m_matval->getRowIt(row) + m_matval->getDim().at(1), m_vecval->begin(), (double)0);
-        }
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        multiply(*m_vecval);
     };
 };
 class Mult_MatU_VecNN: public Mult_Mat_Vec
@@ -1776,29 +1632,17 @@ class Mult_MatU_VecNN: public Mult_Mat_Vec
   public:
     Mult_MatU_VecNN(MultiDimParameter *mat, Expression *a) : Mult_Mat_Vec(mat, a) {
         this->m_sign = unknown;
-        a_greaterequalthan0 = Matrix(*mat->getValue());
-        a_lessthan0 = Matrix(*mat->getValue());
-    };
-    Mult_MatU_VecNN(const Mult_MatU_VecNN &old, const std::vector<Expression*>& arguments) : Mult_Mat_Vec(old, arguments) {
-        a_greaterequalthan0 = old.a_greaterequalthan0;
-        a_lessthan0 = old.a_lessthan0;
+        gemv::split(m_mat, a_greaterequalthan0, a_lessthan0);
     };
+    Mult_MatU_VecNN(const Mult_MatU_VecNN &old, const std::vector<Expression*>& arguments) : Mult_Mat_Vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        a_greaterequalthan0 = m_matval->getGreaterEqualThan0();
-        a_lessthan0 = m_matval->getLessThan0();
-
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         b = *m_vecval;
-        m_arguments.at(1)->evaluate(y_in, x_in);
-        for (int row=0; row < m_dim; ++row) {
-            m_value.at(row) = std::inner_product(a_greaterequalthan0.getRowIt(row), a_greaterequalthan0.getRowIt(row) + m_matval->getDim().at(1), b.begin(), (double)0);
-            m_value.at(row) = std::inner_product(a_lessthan0.getRowIt(row), a_lessthan0.getRowIt(row) + m_matval->getDim().at(1), m_vecval->begin(), m_value.at(row));
-        }
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        multiplySplit(b, *m_vecval);
     };
   private:
-    Matrix a_greaterequalthan0;
-    Matrix a_lessthan0;
     std::vector<double> b;
 };
 class Mult_MatU_VecNP: public Mult_Mat_Vec
@@ -1806,29 +1650,17 @@ class Mult_MatU_VecNP: public Mult_Mat_Vec
   public:
     Mult_MatU_VecNP(MultiDimParameter *mat, Expression *a) : Mult_Mat_Vec(mat, a) {
         this->m_sign = unknown;
-        a_greaterequalthan0 = Matrix(*mat->getValue());
-        a_lessthan0 = Matrix(*mat->getValue());
-    };
-    Mult_MatU_VecNP(const Mult_MatU_VecNP &old, const std::vector<Expression*>& arguments) : Mult_Mat_Vec(old, arguments) {
-        a_greaterequalthan0 = old.a_greaterequalthan0;
-        a_lessthan0 = old.a_lessthan0;
+        gemv::split(m_mat, a_greaterequalthan0, a_lessthan0);
     };
+    Mult_MatU_VecNP(const Mult_MatU_VecNP &old, const std::vector<Expression*>& arguments) : Mult_Mat_Vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        a_greaterequalthan0 = m_matval->getGreaterEqualThan0();
-        a_lessthan0 = m_matval->getLessThan0();
-
-        m_arguments.at(1)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
         b = *m_vecval;
-        m_arguments.at(1)->evaluate(y_in, x_in);
-        for (int row=0; row < m_dim; ++row) {
-            m_value.at(row) = std::inner_product(a_greaterequalthan0.getRowIt(row), a_greaterequalthan0.getRowIt(row) + m_matval->getDim().at(1), b.begin(), (double)0);
-            m_value.at(row) = std::inner_product(a_lessthan0.getRowIt(row), a_lessthan0.getRowIt(row) + m_matval->getDim().at(1), m_vecval->begin(), m_value.at(row));
-        }
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        multiplySplit(b, *m_vecval);
     };
   private:
-    Matrix a_greaterequalthan0;
-    Matrix a_lessthan0;
     std::vector<double> b;
 };
 class Mult_MatNN_VecU: public Mult_Mat_Vec
@@ -1836,142 +1668,219 @@ class Mult_MatNN_VecU: public Mult_Mat_Vec
   public:
     Mult_MatNN_VecU(MultiDimParameter *mat, Expression *a) : Mult_Mat_Vec(mat, a) {
         this->m_sign = unknown;
-        b_greaterequalthan0.resize(m_vecval->size());
-        b_lessthan0.resize(m_vecval->size());
-    };
-    Mult_MatNN_VecU(const Mult_MatNN_VecU &old, const std::vector<Expression*>& arguments) : Mult_Mat_Vec(old, arguments) {
-        b_greaterequalthan0 = old.b_greaterequalthan0;
-        b_lessthan0 = old.b_lessthan0;
     };
+    Mult_MatNN_VecU(const Mult_MatNN_VecU &old, const std::vector<Expression*>& arguments) : Mult_Mat_Vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        a = *m_matval;
-        m_arguments.at(0)->evaluate(y_in, x_in);
-
-        m_arguments.at(1)->evaluate(x_in, y_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_vecval->at(i) >= 0) {
-                b_greaterequalthan0.at(i) = m_vecval->at(i);
-                b_lessthan0.at(i) = 0;
-            } else {
-                b_greaterequalthan0.at(i) = 0;
-                b_lessthan0.at(i) = m_vecval->at(i);
-            }
-        }
-        for (int row=0; row < m_dim; ++row) {
-            m_value.at(row) = std::inner_product(a.getRowIt(row), a.getRowIt(row) + m_matval->getDim().at(1), b_greaterequalthan0.begin(), (double)0);
-            m_value.at(row) = std::inner_product(m_matval->getRowIt(row), m_matval->getRowIt(row) + m_matval->getDim().at(1), b_lessthan0.begin(), m_value.at(row));
-        }
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        multiply(*m_vecval);
     };
-  private:
-    Matrix a;
-    std::vector<double> b_greaterequalthan0;
-    std::vector<double> b_lessthan0;
 };
 class Mult_MatNP_VecU: public Mult_Mat_Vec
 {
   public:
     Mult_MatNP_VecU(MultiDimParameter *mat, Expression *a) : Mult_Mat_Vec(mat, a) {
         this->m_sign = unknown;
-        b_greaterequalthan0.resize(m_vecval->size());
-        b_lessthan0.resize(m_vecval->size());
-    };
-    Mult_MatNP_VecU(const Mult_MatNP_VecU &old, const std::vector<Expression*>& arguments) : Mult_Mat_Vec(old, arguments) {
-        b_greaterequalthan0 = old.b_greaterequalthan0;
-        b_lessthan0 = old.b_lessthan0;
     };
+    Mult_MatNP_VecU(const Mult_MatNP_VecU &old, const std::vector<Expression*>& arguments) : Mult_Mat_Vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        a = *m_matval;
-        m_arguments.at(0)->evaluate(y_in, x_in);
-
-        m_arguments.at(1)->evaluate(y_in, x_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_vecval->at(i) >= 0) {
-                b_greaterequalthan0.at(i) = m_vecval->at(i);
-                b_lessthan0.at(i) = 0;
-            } else {
-                b_greaterequalthan0.at(i) = 0;
-                b_lessthan0.at(i) = m_vecval->at(i);
-            }
-        }
-        for (int row=0; row < m_dim; ++row) {
-            m_value.at(row) = std::inner_product(a.getRowIt(row), a.getRowIt(row) + m_matval->getDim().at(1), b_greaterequalthan0.begin(), (double)0);
-            m_value.at(row) = std::inner_product(m_matval->getRowIt(row), m_matval->getRowIt(row) + m_matval->getDim().at(1), b_lessthan0.begin(), m_value.at(row));
-        }
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        multiply(*m_vecval);
     };
-  private:
-    Matrix a;
-    std::vector<double> b_greaterequalthan0;
-    std::vector<double> b_lessthan0;
 };
 class Mult_MatU_VecU: public Mult_Mat_Vec
 {
   public:
     Mult_MatU_VecU(MultiDimParameter *mat, Expression *a) : Mult_Mat_Vec(mat, a) {
         this->m_sign = unknown;
-        a_greaterequalthan0 = Matrix(*mat->getValue());
-        a_lessthan0 = Matrix(*mat->getValue());
-        a_swap_greaterequalthan0 = Matrix(*mat->getValue());
-        a_swap_lessthan0 = Matrix(*mat->getValue());
-        b_greaterequalthan0.resize(m_vecval->size());
-        b_lessthan0.resize(m_vecval->size());
-        b_swap_greaterequalthan0.resize(m_vecval->size());
-        b_swap_lessthan0.resize(m_vecval->size());
-    };
-    Mult_MatU_VecU(const Mult_MatU_VecU &old, const std::vector<Expression*>& arguments) : Mult_Mat_Vec(old, arguments) {
-        a_greaterequalthan0 = old.a_greaterequalthan0;
-        a_lessthan0 = old.a_lessthan0;
-        a_swap_greaterequalthan0 = old.a_swap_greaterequalthan0;
-        a_swap_lessthan0 = old.a_swap_lessthan0;
-        b_greaterequalthan0 = old.b_greaterequalthan0;
-        b_lessthan0 = old.b_lessthan0;
-        b_swap_greaterequalthan0 = old.b_swap_greaterequalthan0;
-        b_swap_lessthan0 = old.b_swap_lessthan0;
+        gemv::split(m_mat, a_greaterequalthan0, a_lessthan0);
     };
+    Mult_MatU_VecU(const Mult_MatU_VecU &old, const std::vector<Expression*>& arguments) : Mult_Mat_Vec(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        a_greaterequalthan0 = m_matval->getGreaterEqualThan0();
-        a_lessthan0 = m_matval->getLessThan0();
-        m_arguments.at(1)->evaluate(x_in, y_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_vecval->at(i) >= 0) {
-                b_greaterequalthan0.at(i) = m_vecval->at(i);
-                b_lessthan0.at(i) = 0;
-            } else {
-                b_greaterequalthan0.at(i) = 0;
-                b_lessthan0.at(i) = m_vecval->at(i);
-            }
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        b = *m_vecval;
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        multiplySplit(b, *m_vecval);
+    };
+  private:
+    std::vector<double> b;
+};
+
+/*  Sparse variants of Mult_Mat_Vec: the matrix is a SparseMultiDimParameter, so the cost of an
+ *  evaluation is O(nnz) instead of O(rows*cols). The non-zeros are summed in the same order as
+ *  in the dense classes.
+ */
+class Mult_SpMat_Vec: public Function
+{
+  public:
+    Mult_SpMat_Vec(SparseMultiDimParameter *mat, Expression *a) : Function(mat, a, "dot_spmat") {
+        this->m_dim = mat->getValue()->getRows();
+        this->m_value.resize(m_dim);
+
+        this->m_vecval = a->getValue();
+        this->m_matval = mat->getValue();
+    };
+    Mult_SpMat_Vec(const Mult_SpMat_Vec &old, const std::vector<Expression*>& arguments) : Function(old, arguments) {
+        m_matval = dynamic_cast<SparseMultiDimParameter*>(arguments.at(0))->getValue();
+        m_vecval = arguments.at(1)->getValue();
+    };
+    void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override = 0;
+    // the same for all sign variants, the matrix is constant
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& a = *m_arguments[1];
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        for (int row = 0; row < m_dim; ++row) {
+            m_lower[row] = m_matval->rowProductSplit(row, a.getLower().data(), a.getUpper().data(), 0);
+            m_upper[row] = m_matval->rowProductSplit(row, a.getUpper().data(), a.getLower().data(), 0);
         }
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        a_swap_greaterequalthan0 = m_matval->getGreaterEqualThan0();
-        a_swap_lessthan0 = m_matval->getLessThan0();
-        m_arguments.at(1)->evaluate(y_in, x_in);
-        for (size_t i=0;i<m_dim;++i) {
-            if (m_vecval->at(i) >= 0) {
-                b_swap_greaterequalthan0.at(i) = m_vecval->at(i);
-                b_swap_lessthan0.at(i) = 0;
-            } else {
-                b_swap_greaterequalthan0.at(i) = 0;
-                b_swap_lessthan0.at(i) = m_vecval->at(i);
-            }
+    };
+  protected:
+    // m_value = matrix * vec
+    void multiply(const std::vector<double>& vec) {
+        for (int row=0; row < m_dim; ++row) {
+            m_value[row] = m_matval->rowProduct(row, vec.data(), 0);
         }
+    };
+    // m_value = pos(matrix) * b + neg(matrix) * bs
+    void multiplySplit(const std::vector<double>& b, const std::vector<double>& bs) {
         for (int row=0; row < m_dim; ++row) {
-            m_value.at(row) = std::inner_product(a_greaterequalthan0.getRowIt(row), a_greaterequalthan0.getRowIt(row) + m_matval->getDim().at(1), b_greaterequalthan0.begin(), (double)0);
-            m_value.at(row) = std::inner_product(a_swap_greaterequalthan0.getRowIt(row), a_swap_greaterequalthan0.getRowIt(row) + m_matval->getDim().at(1), b_lessthan0.begin(), m_value.at(row));
-            m_value.at(row) = std::inner_product(a_lessthan0.getRowIt(row), a_lessthan0.getRowIt(row) + m_matval->getDim().at(1), b_swap_greaterequalthan0.begin(), m_value.at(row));
-            m_value.at(row) = std::inner_product(a_swap_lessthan0.getRowIt(row), a_swap_lessthan0.getRowIt(row) + m_matval->getDim().at(1), b_swap_lessthan0.begin(), m_value.at(row));
+            m_value[row] = m_matval->rowProductSplit(row, b.data(), bs.data(), 0);
         }
     };
+    std::vector<double>* m_vecval;
+    SparseMatrix* m_matval;
+};
+class Mult_SpMatNN_VecNN: public Mult_SpMat_Vec
+{
+  public:
+    Mult_SpMatNN_VecNN(SparseMultiDimParameter *mat, Expression *a) : Mult_SpMat_Vec(mat, a) {
+        this->m_sign = NN;
+    };
+    Mult_SpMatNN_VecNN(const Mult_SpMatNN_VecNN &old, const std::vector<Expression*>& arguments) : Mult_SpMat_Vec(old, arguments) {};
+    void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        multiply(*m_vecval);
+    };
+};
+class Mult_SpMatNP_VecNP: public Mult_SpMat_Vec
+{
+  public:
+    Mult_SpMatNP_VecNP(SparseMultiDimParameter *mat, Expression *a) : Mult_SpMat_Vec(mat, a) {
+        this->m_sign = NN;
+    };
+    Mult_SpMatNP_VecNP(const Mult_SpMatNP_VecNP &old, const std::vector<Expression*>& arguments) : Mult_SpMat_Vec(old, arguments) {};
+    void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        multiply(*m_vecval);
+    };
+};
+class Mult_SpMatNN_VecNP: public Mult_SpMat_Vec
+{
+  public:
+    Mult_SpMatNN_VecNP(SparseMultiDimParameter *mat, Expression *a) : Mult_SpMat_Vec(mat, a) {
+        this->m_sign = NP;
+    };
+    Mult_SpMatNN_VecNP(const Mult_SpMatNN_VecNP &old, const std::vector<Expression*>& arguments) : Mult_SpMat_Vec(old, arguments) {};
+    void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        multiply(*m_vecval);
+    };
+};
+class Mult_SpMatNP_VecNN: public Mult_SpMat_Vec
+{
+  public:
+    Mult_SpMatNP_VecNN(SparseMultiDimParameter *mat, Expression *a) : Mult_SpMat_Vec(mat, a) {
+        this->m_sign = NP;
+    };
+    Mult_SpMatNP_VecNN(const Mult_SpMatNP_VecNN &old, const std::vector<Expression*>& arguments) : Mult_SpMat_Vec(old, arguments) {};
+    void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        multiply(*m_vecval);
+    };
+};
+class Mult_SpMatU_VecNN: public Mult_SpMat_Vec
+{
+  public:
+    Mult_SpMatU_VecNN(SparseMultiDimParameter *mat, Expression *a) : Mult_SpMat_Vec(mat, a) {
+        this->m_sign = unknown;
+    };
+    Mult_SpMatU_VecNN(const Mult_SpMatU_VecNN &old, const std::vector<Expression*>& arguments) : Mult_SpMat_Vec(old, arguments) {};
+    void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        b = *m_vecval;
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        multiplySplit(b, *m_vecval);
+    };
+  private:
+    std::vector<double> b;
+};
+class Mult_SpMatU_VecNP: public Mult_SpMat_Vec
+{
+  public:
+    Mult_SpMatU_VecNP(SparseMultiDimParameter *mat, Expression *a) : Mult_SpMat_Vec(mat, a) {
+        this->m_sign = unknown;
+    };
+    Mult_SpMatU_VecNP(const Mult_SpMatU_VecNP &old, const std::vector<Expression*>& arguments) : Mult_SpMat_Vec(old, arguments) {};
+    void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        b = *m_vecval;
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        multiplySplit(b, *m_vecval);
+    };
+  private:
+    std::vector<double> b;
+};
+class Mult_SpMatNN_VecU: public Mult_SpMat_Vec
+{
+  public:
+    Mult_SpMatNN_VecU(SparseMultiDimParameter *mat, Expression *a) : Mult_SpMat_Vec(mat, a) {
+        this->m_sign = unknown;
+    };
+    Mult_SpMatNN_VecU(const Mult_SpMatNN_VecU &old, const std::vector<Expression*>& arguments) : Mult_SpMat_Vec(old, arguments) {};
+    void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        multiply(*m_vecval);
+    };
+};
+class Mult_SpMatNP_VecU: public Mult_SpMat_Vec
+{
+  public:
+    Mult_SpMatNP_VecU(SparseMultiDimParameter *mat, Expression *a) : Mult_SpMat_Vec(mat, a) {
+        this->m_sign = unknown;
+    };
+    Mult_SpMatNP_VecU(const Mult_SpMatNP_VecU &old, const std::vector<Expression*>& arguments) : Mult_SpMat_Vec(old, arguments) {};
+    void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        multiply(*m_vecval);
+    };
+};
+class Mult_SpMatU_VecU: public Mult_SpMat_Vec
+{
+  public:
+    Mult_SpMatU_VecU(SparseMultiDimParameter *mat, Expression *a) : Mult_SpMat_Vec(mat, a) {
+        this->m_sign = unknown;
+    };
+    Mult_SpMatU_VecU(const Mult_SpMatU_VecU &old, const std::vector<Expression*>& arguments) : Mult_SpMat_Vec(old, arguments) {};
+    void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        b = *m_vecval;
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        multiplySplit(b, *m_vecval);
+    };
   private:
-    Matrix a_greaterequalthan0;
-    Matrix a_lessthan0;
-    Matrix a_swap_greaterequalthan0;
-    Matrix a_swap_lessthan0;
-    std::vector<double> b_greaterequalthan0;
-    std::vector<double> b_lessthan0;
-    std::vector<double> b_swap_greaterequalthan0;
-    std::vector<double> b_swap_lessthan0;
+    std::vector<double> b;
 };
 
 class Inv: public Function
@@ -1996,8 +1905,16 @@ class Inv: public Function
         m_argval = arguments.at(0)->getValue();
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(y_in, x_in);
-        std::transform(m_argval->begin(), m_argval->end(), m_value.begin(), [](const double & c){return std::log2(c);});
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        std::transform(m_argval->begin(), m_argval->end(), m_value.begin(), [](const double & c){return 1 / c;});
+    };
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& a = *m_arguments[0];
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        for (int i = 0; i < m_dim; ++i) {
+            interval::div(1, 1, a.getLower()[i], a.getUpper()[i], m_lower[i], m_upper[i]);
+        }
     };
   private:
     std::vector<double>* m_argval;
@@ -2017,8 +1934,15 @@ class Log2: public Function
         m_argval = arguments.at(0)->getValue();
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        std::transform(m_argval->begin(), m_argval->end(), m_value.begin(), [](const double & c){return std::log2(c);});
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        vecmath::log2(m_dim, m_argval->data(), m_value.data());
+    };
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& a = *m_arguments[0];
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        vecmath::log2(m_dim, a.getLower().data(), m_lower.data());
+        vecmath::log2(m_dim, a.getUpper().data(), m_upper.data());
     };
   private:
     std::vector<double>* m_argval;
@@ -2038,8 +1962,15 @@ class LogN: public Function
         m_argval = arguments.at(0)->getValue();
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        std::transform(m_argval->begin(), m_argval->end(), m_value.begin(), [](const double & c){return std::log(c);});
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        vecmath::ln(m_dim, m_argval->data(), m_value.data());
+    };
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& a = *m_arguments[0];
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        vecmath::ln(m_dim, a.getLower().data(), m_lower.data());
+        vecmath::ln(m_dim, a.getUpper().data(), m_upper.data());
     };
   private:
     std::vector<double>* m_argval;
@@ -2067,9 +1998,18 @@ class Neg: public Function
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
         // In a negated Expression, the nonincreasing and nondecreasing variables change!
-        m_arguments.at(0)->evaluate(y_in, x_in);
+        m_arguments.at(0)->evaluate_arg(y_in, x_in);
         std::transform(m_argval->begin(), m_argval->end(), m_value.begin(), [](const double & c){return -c;});
     };
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& a = *m_arguments[0];
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        for (int i = 0; i < m_dim; ++i) {
+            m_lower[i] = -a.getUpper()[i];
+            m_upper[i] = -a.getLower()[i];
+        }
+    };
   private:
     std::vector<double>* m_argval;
 };
@@ -2089,9 +2029,19 @@ class Prod: public Function
         m_argval = arguments.at(0)->getValue();
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
         m_value.at(0) = std::accumulate(m_argval->begin(), m_argval->end(), static_cast<double>(1), std::multiplies<>());
     };
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& a = *m_arguments[0];
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        m_lower[0] = 1;
+        m_upper[0] = 1;
+        for (size_t i = 0; i < a.getLower().size(); ++i) {
+            interval::mult(m_lower[0], m_upper[0], a.getLower()[i], a.getUpper()[i], m_lower[0], m_upper[0]);
+        }
+    };
   private:
     std::vector<double>* m_argval;
 };
@@ -2112,9 +2062,16 @@ class Sum: public Function
         m_argval = arguments.at(0)->getValue();
     };
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
+        m_arguments.at(0)->evaluate_arg(x_in, y_in);
         m_value.at(0) = std::accumulate(m_argval->begin(), m_argval->end(), static_cast<double>(0), std::plus<>());
     };
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& a = *m_arguments[0];
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        m_lower[0] = std::accumulate(a.getLower().begin(), a.getLower().end(), static_cast<double>(0), std::plus<>());
+        m_upper[0] = std::accumulate(a.getUpper().begin(), a.getUpper().end(), static_cast<double>(0), std::plus<>());
+    };
   private:
     std::vector<double>* m_argval;
 };
@@ -2123,10 +2080,6 @@ class List : public Function
 {
   public:
     explicit List(std::vector<Expression*> a) : Function(a, "list_of_expressions") {
-        for (auto arg : a) {
-            m_valuepointer.push_back(arg->getValue());
-        }
-
         this->m_dim = a.size();
         this->m_value.resize(m_dim);
 
@@ -2144,27 +2097,30 @@ class List : public Function
             }
         }
     };
-    List(const List &old, const std::vector<Expression*>& arguments) : Function(old, arguments) {
-        for (auto arg : arguments) {
-            m_valuepointer.push_back(arg->getValue());
-        }
-    };
+    List(const List &old, const std::vector<Expression*>& arguments) : Function(old, arguments) {};
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
         for (int i=0; i<m_dim; ++i) {
-            m_arguments.at(i)->evaluate(x_in, y_in);
-            m_value.at(i) = m_valuepointer.at(i)->at(0);
+            m_value[i] = m_arguments[i]->evaluate_ref(x_in, y_in)[0];
+        }
+    };
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        for (int i = 0; i < m_dim; ++i) {
+            m_lower[i] = m_arguments[i]->getLower()[0];
+            m_upper[i] = m_arguments[i]->getUpper()[0];
         }
     };
-  private:
-     std::vector<std::vector<double>*> m_valuepointer;
 };
 
 class Sliced : public Function
 {
   public:
     explicit Sliced(Expression *a, int index) : Function(a, "sliced_expressions") {
+        if (index < 0 || index >= a->getDim()) {
+            throw std::out_of_range("Sliced: index " + std::to_string(index) + " out of range");
+        }
         this->m_index = index;
-        this->m_valuepointer = &a->getValue()->at(index);
 
         this->m_dim = 1;
         this->m_value.resize(m_dim);
@@ -2173,15 +2129,155 @@ class Sliced : public Function
     };
     Sliced(const Sliced &old, const std::vector<Expression*>& arguments) : Function(old, arguments) {
             this->m_index = old.m_index;
-            this->m_valuepointer = &arguments.at(0)->getValue()->at(m_index);
     };
+    int getIndex() const {return m_index;};
+    // reads the element from the (memoized) value of the argument, see Expression::evaluate_ref()
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_arguments.at(0)->evaluate(x_in, y_in);
-        m_value.at(0) = *m_valuepointer;
+        m_value[0] = m_arguments[0]->evaluate_ref(x_in, y_in)[m_index];
+    };
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        m_lower.assign(1, m_arguments[0]->getLower()[m_index]);
+        m_upper.assign(1, m_arguments[0]->getUpper()[m_index]);
     };
   private:
     int m_index;
-    double* m_valuepointer;
+};
+
+/* Rate of the K users of an interference channel, i.e., log2(1 + alpha p / (sigma + beta p)) with the
+ * interference evaluated for the swapped orientation, as one node instead of the tree of
+ * Mult/Add/Div/Log2 nodes (see util/Rate.h). With rate::Sum resp. rate::PropFair the node is the
+ * sum resp. the product of the rates (proportional fairness) and has dimension 1.
+ * alpha (K), beta (K x K) and sigma (1 or K) are constants, the power p (K) is nonnegative.
+ */
+class Rate : public Function
+{
+  public:
+    Rate(Parameter *alpha, Expression *p, MultiDimParameter *beta, Parameter *sigma, rate::Kind kind)
+        : Function(std::vector<Expression*>{alpha, p, beta, sigma}, "rate") {
+        const size_t k = p->getDim();
+        const Matrix* mat = beta->getValue();
+        if (alpha->getDim() != static_cast<int>(k) || mat->getRows() != k || mat->getCols() != k
+                || (sigma->getDim() != 1 && sigma->getDim() != static_cast<int>(k))) {
+            throw std::invalid_argument("Rate: dimensions of alpha, beta and sigma do not match the power");
+        }
+        if (alpha->getSign() != NN || p->getSign() != NN || beta->getSign() != NN || sigma->getSign() != NN) {
+            throw std::invalid_argument("Rate: alpha, beta, sigma and the power have to be nonnegative");
+        }
+        if (kind > rate::PropFair) {
+            throw std::invalid_argument("Rate: invalid kind");
+        }
+        this->m_kind = kind;
+        this->m_k = k;
+
+        // alpha | sigma | diag(beta) | beta column-major, see rate::evaluate()
+        const std::vector<double>& a = *alpha->getValue();
+        const std::vector<double>& s = *sigma->getValue();
+        m_constants.reserve(rate::constants(k));
+        m_constants.insert(m_constants.end(), a.begin(), a.end());
+        for (size_t i = 0; i < k; ++i) {m_constants.push_back(s[s.size() == 1 ? 0 : i]);}
+        for (size_t i = 0; i < k; ++i) {m_constants.push_back((*mat)(i, i));}
+        const std::vector<double> cm = gemv::columnMajor(k, k, mat->getData());
+        m_constants.insert(m_constants.end(), cm.begin(), cm.end());
+
+        this->m_dim = (kind == rate::PerUser) ? k : 1;
+        this->m_value.resize(m_dim);
+        this->m_sign = NN;
+        this->m_swap.resize(k);
+    };
+    Rate(const Rate &old, const std::vector<Expression*>& arguments) : Function(old, arguments) {
+        m_kind = old.m_kind;
+        m_k = old.m_k;
+        m_constants = old.m_constants;
+        m_swap.resize(m_k);
+    };
+    rate::Kind getKind() const {return m_kind;};
+    // alpha | sigma | diag(beta) | beta column-major
+    const std::vector<double>& getConstants() const {return m_constants;};
+    void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
+        const std::vector<double>& p = *m_arguments.at(1)->getValue();
+        m_arguments.at(1)->evaluate_arg(y_in, x_in);
+        std::copy(p.begin(), p.end(), m_swap.begin());
+        m_arguments.at(1)->evaluate_arg(x_in, y_in);
+        rate::evaluate(m_kind, m_k, m_constants.data(), p.data(), m_swap.data(), m_value.data());
+    };
+    // the MMP bounds of the rates for the interval of the power
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& p = *m_arguments[1];
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        rate::evaluate(m_kind, m_k, m_constants.data(), p.getUpper().data(), p.getLower().data(), m_upper.data());
+        rate::evaluate(m_kind, m_k, m_constants.data(), p.getLower().data(), p.getUpper().data(), m_lower.data());
+    };
+  private:
+    rate::Kind m_kind;
+    size_t m_k;
+    std::vector<double> m_constants;
+    // the power for (y,x)
+    std::vector<double> m_swap;
+};
+
+/* offset + scale * a with constants scale != 0 (scalar) and offset (scalar or vector), created by rewrite()
+ * for chains of Neg and additions of constants. For scale < 0, a is evaluated for (y,x) as in Neg.
+ */
+class Affine : public Function
+{
+  public:
+    Affine(Expression *a, double scale, const std::vector<double>& offset) : Function(a, "affine") {
+        if (scale == 0 || (offset.size() != 1 && offset.size() != static_cast<size_t>(a->getDim()))) {
+            throw std::invalid_argument("Affine: invalid scale or offset");
+        }
+        this->m_argval = a->getValue();
+        this->m_scale = scale;
+        this->m_offset = offset;
+
+        this->m_dim = a->getDim();
+        this->m_value.resize(m_dim);
+
+        sign term = a->getSign();
+        if (scale < 0 && term != unknown) {
+            term = (term == NN) ? NP : NN;
+        }
+        const sign s = Parameter::signOf(offset);
+        if (term != unknown && (s == term || std::all_of(offset.begin(), offset.end(), [](double v){return v == 0;}))) {
+            this->m_sign = term;
+        } else {
+            this->m_sign = unknown;
+        }
+    };
+    Affine(const Affine &old, const std::vector<Expression*>& arguments) : Function(old, arguments) {
+        m_argval = arguments.at(0)->getValue();
+        m_scale = old.m_scale;
+        m_offset = old.m_offset;
+    };
+    double getScale() const {return m_scale;};
+    const std::vector<double>& getOffset() const {return m_offset;};
+    void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
+        if (m_scale < 0) {
+            m_arguments.at(0)->evaluate_arg(y_in, x_in);
+        } else {
+            m_arguments.at(0)->evaluate_arg(x_in, y_in);
+        }
+        const size_t step = m_offset.size() == 1 ? 0 : 1;
+        for (size_t i = 0; i < m_value.size(); ++i) {
+            m_value[i] = m_scale * (*m_argval)[i] + m_offset[i * step];
+        }
+    };
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        const Expression& a = *m_arguments[0];
+        m_lower.resize(m_dim);
+        m_upper.resize(m_dim);
+        const std::vector<double>& from = m_scale < 0 ? a.getUpper() : a.getLower();
+        const std::vector<double>& to = m_scale < 0 ? a.getLower() : a.getUpper();
+        const size_t step = m_offset.size() == 1 ? 0 : 1;
+        for (int i = 0; i < m_dim; ++i) {
+            m_lower[i] = m_scale * from[i] + m_offset[i * step];
+            m_upper[i] = m_scale * to[i] + m_offset[i * step];
+        }
+    };
+  private:
+    std::vector<double>* m_argval;
+    double m_scale;
+    std::vector<double> m_offset;
 };
 
 /*  Down below are Methods for creating a contiguous storage container for all Functions in an objective
@@ -2214,6 +2310,16 @@ typedef std::variant<
         Mult_MatNP_VecU,
         Mult_MatU_VecU,
 
+        Mult_SpMatNN_VecNN,
+        Mult_SpMatNP_VecNP,
+        Mult_SpMatNN_VecNP,
+        Mult_SpMatNP_VecNN,
+        Mult_SpMatU_VecNN,
+        Mult_SpMatU_VecNP,
+        Mult_SpMatNN_VecU,
+        Mult_SpMatNP_VecU,
+        Mult_SpMatU_VecU,
+
         Mult_vecNN_vecNN,
         Mult_vecNP_vecNP,
         Mult_vecNN_vecNP,
@@ -2263,8 +2369,9 @@ typedef std::variant<
         Neg,
         Prod, Sum,
         List, Sliced,
+        Rate, Affine,
 
-        Parameter, MultiDimParameter, Variable> variant_expression;
+        Parameter, MultiDimParameter, SparseMultiDimParameter, Variable> variant_expression;
 
 Expression* getBasePointer(variant_expression& variant) {
     if (variant.index() == 0) {return &std::get<Add_vec_scalar>(variant);}
@@ -2290,62 +2397,75 @@ Expression* getBasePointer(variant_expression& variant) {
     else if (variant.index() == 18) {return &std::get<Mult_MatNP_VecU>(variant);}
     else if (variant.index() == 19) {return &std::get<Mult_MatU_VecU>(variant);}
 
-    else if (variant.index() == 20) {return &std::get<Mult_vecNN_vecNN>(variant);}
-    else if (variant.index() == 21) {return &std::get<Mult_vecNP_vecNP>(variant);}
-    else if (variant.index() == 22) {return &std::get<Mult_vecNN_vecNP>(variant);}
-    else if (variant.index() == 23) {return &std::get<Mult_vecU_vecNN>(variant);}
-    else if (variant.index() == 24) {return &std::get<Mult_vecU_vecNP>(variant);}
-    else if (variant.index() == 25) {return &std::get<Mult_vecU_vecU>(variant);}
-
-    else if (variant.index() == 26) {return &std::get<Dot_NN_NN>(variant);}
-    else if (variant.index() == 27) {return &std::get<Dot_NP_NP>(variant);}
-    else if (variant.index() == 28) {return &std::get<Dot_NN_NP>(variant);}
-    else if (variant.index() == 29) {return &std::get<Dot_U_NN>(variant);}
-    else if (variant.index() == 30) {return &std::get<Dot_U_NP>(variant);}
-    else if (variant.index() == 31) {return &std::get<Dot_U_U>(variant);}
-
-    else if (variant.index() == 32) {return &std::get<Div_VecNN_VecNN>(variant);}
-    else if (variant.index() == 33) {return &std::get<Div_VecNP_VecNP>(variant);}
-    else if (variant.index() == 34) {return &std::get<Div_VecNN_VecNP>(variant);}
-    else if (variant.index() == 35) {return &std::get<Div_VecNP_VecNN>(variant);}
-    else if (variant.index() == 36) {return &std::get<Div_VecU_VecNN>(variant);}
-    else if (variant.index() == 37) {return &std::get<Div_VecU_VecNP>(variant);}
-    else if (variant.index() == 38) {return &std::get<Div_VecNN_VecU>(variant);}
-    else if (variant.index() == 39) {return &std::get<Div_VecNP_VecU>(variant);}
-    else if (variant.index() == 40) {return &std::get<Div_VecU_VecU>(variant);}
-
-    else if (variant.index() == 41) {return &std::get<Div_VecNN_ScalarNN>(variant);}
-    else if (variant.index() == 42) {return &std::get<Div_VecNP_ScalarNP>(variant);}
-    else if (variant.index() == 43) {return &std::get<Div_VecNN_ScalarNP>(variant);}
-    else if (variant.index() == 44) {return &std::get<Div_VecNP_ScalarNN>(variant);}
-    else if (variant.index() == 45) {return &std::get<Div_VecU_ScalarNN>(variant);}
-    else if (variant.index() == 46) {return &std::get<Div_VecU_ScalarNP>(variant);}
-    else if (variant.index() == 47) {return &std::get<Div_VecNN_ScalarU>(variant);}
-    else if (variant.index() == 48) {return &std::get<Div_VecNP_ScalarU>(variant);}
-    else if (variant.index() == 49) {return &std::get<Div_VecU_ScalarU>(variant);}
-
-    else if (variant.index() == 50) {return &std::get<Div_ScalarNN_VecNN>(variant);}
-    else if (variant.index() == 51) {return &std::get<Div_ScalarNP_VecNP>(variant);}
-    else if (variant.index() == 52) {return &std::get<Div_ScalarNN_VecNP>(variant);}
-    else if (variant.index() == 53) {return &std::get<Div_ScalarNP_VecNN>(variant);}
-    else if (variant.index() == 54) {return &std::get<Div_ScalarU_VecNN>(variant);}
-    else if (variant.index() == 55) {return &std::get<Div_ScalarU_VecNP>(variant);}
-    else if (variant.index() == 56) {return &std::get<Div_ScalarNN_VecU>(variant);}
-    else if (variant.index() == 57) {return &std::get<Div_ScalarNP_VecU>(variant);}
-    else if (variant.index() == 58) {return &std::get<Div_ScalarU_VecU>(variant);}
-
-    else if (variant.index() == 59) {return &std::get<Log2>(variant);}
-    else if (variant.index() == 60) {return &std::get<LogN>(variant);}
-    else if (variant.index() == 61) {return &std::get<Inv>(variant);}
-    else if (variant.index() == 62) {return &std::get<Neg>(variant);}
-    else if (variant.index() == 63) {return &std::get<Prod>(variant);}
-    else if (variant.index() == 64) {return &std::get<Sum>(variant);}
-    else if (variant.index() == 65) {return &std::get<List>(variant);}
-    else if (variant.index() == 66) {return &std::get<Sliced>(variant);}
-
-    else if (variant.index() == 67) {return &std::get<Parameter>(variant);}
-    else if (variant.index() == 68) {return &std::get<MultiDimParameter>(variant);}
-    else if (variant.index() == 69) {return &std::get<Variable>(variant);}
+    else if (variant.index() == 20) {return &std::get<Mult_SpMatNN_VecNN>(variant);}
+    else if (variant.index() == 21) {return &std::get<Mult_SpMatNP_VecNP>(variant);}
+    else if (variant.index() == 22) {return &std::get<Mult_SpMatNN_VecNP>(variant);}
+    else if (variant.index() == 23) {return &std::get<Mult_SpMatNP_VecNN>(variant);}
+    else if (variant.index() == 24) {return &std::get<Mult_SpMatU_VecNN>(variant);}
+    else if (variant.index() == 25) {return &std::get<Mult_SpMatU_VecNP>(variant);}
+    else if (variant.index() == 26) {return &std::get<Mult_SpMatNN_VecU>(variant);}
+    else if (variant.index() == 27) {return &std::get<Mult_SpMatNP_VecU>(variant);}
+    else if (variant.index() == 28) {return &std::get<Mult_SpMatU_VecU>(variant);}
+
+    else if (variant.index() == 29) {return &std::get<Mult_vecNN_vecNN>(variant);}
+    else if (variant.index() == 30) {return &std::get<Mult_vecNP_vecNP>(variant);}
+    else if (variant.index() == 31) {return &std::get<Mult_vecNN_vecNP>(variant);}
+    else if (variant.index() == 32) {return &std::get<Mult_vecU_vecNN>(variant);}
+    else if (variant.index() == 33) {return &std::get<Mult_vecU_vecNP>(variant);}
+    else if (variant.index() == 34) {return &std::get<Mult_vecU_vecU>(variant);}
+
+    else if (variant.index() == 35) {return &std::get<Dot_NN_NN>(variant);}
+    else if (variant.index() == 36) {return &std::get<Dot_NP_NP>(variant);}
+    else if (variant.index() == 37) {return &std::get<Dot_NN_NP>(variant);}
+    else if (variant.index() == 38) {return &std::get<Dot_U_NN>(variant);}
+    else if (variant.index() == 39) {return &std::get<Dot_U_NP>(variant);}
+    else if (variant.index() == 40) {return &std::get<Dot_U_U>(variant);}
+
+    else if (variant.index() == 41) {return &std::get<Div_VecNN_VecNN>(variant);}
+    else if (variant.index() == 42) {return &std::get<Div_VecNP_VecNP>(variant);}
+    else if (variant.index() == 43) {return &std::get<Div_VecNN_VecNP>(variant);}
+    else if (variant.index() == 44) {return &std::get<Div_VecNP_VecNN>(variant);}
+    else if (variant.index() == 45) {return &std::get<Div_VecU_VecNN>(variant);}
+    else if (variant.index() == 46) {return &std::get<Div_VecU_VecNP>(variant);}
+    else if (variant.index() == 47) {return &std::get<Div_VecNN_VecU>(variant);}
+    else if (variant.index() == 48) {return &std::get<Div_VecNP_VecU>(variant);}
+    else if (variant.index() == 49) {return &std::get<Div_VecU_VecU>(variant);}
+
+    else if (variant.index() == 50) {return &std::get<Div_VecNN_ScalarNN>(variant);}
+    else if (variant.index() == 51) {return &std::get<Div_VecNP_ScalarNP>(variant);}
+    else if (variant.index() == 52) {return &std::get<Div_VecNN_ScalarNP>(variant);}
+    else if (variant.index() == 53) {return &std::get<Div_VecNP_ScalarNN>(variant);}
+    else if (variant.index() == 54) {return &std::get<Div_VecU_ScalarNN>(variant);}
+    else if (variant.index() == 55) {return &std::get<Div_VecU_ScalarNP>(variant);}
+    else if (variant.index() == 56) {return &std::get<Div_VecNN_ScalarU>(variant);}
+    else if (variant.index() == 57) {return &std::get<Div_VecNP_ScalarU>(variant);}
+    else if (variant.index() == 58) {return &std::get<Div_VecU_ScalarU>(variant);}
+
+    else if (variant.index() == 59) {return &std::get<Div_ScalarNN_VecNN>(variant);}
+    else if (variant.index() == 60) {return &std::get<Div_ScalarNP_VecNP>(variant);}
+    else if (variant.index() == 61) {return &std::get<Div_ScalarNN_VecNP>(variant);}
+    else if (variant.index() == 62) {return &std::get<Div_ScalarNP_VecNN>(variant);}
+    else if (variant.index() == 63) {return &std::get<Div_ScalarU_VecNN>(variant);}
+    else if (variant.index() == 64) {return &std::get<Div_ScalarU_VecNP>(variant);}
+    else if (variant.index() == 65) {return &std::get<Div_ScalarNN_VecU>(variant);}
+    else if (variant.index() == 66) {return &std::get<Div_ScalarNP_VecU>(variant);}
+    else if (variant.index() == 67) {return &std::get<Div_ScalarU_VecU>(variant);}
+
+    else if (variant.index() == 68) {return &std::get<Log2>(variant);}
+    else if (variant.index() == 69) {return &std::get<LogN>(variant);}
+    else if (variant.index() == 70) {return &std::get<Inv>(variant);}
+    else if (variant.index() == 71) {return &std::get<Neg>(variant);}
+    else if (variant.index() == 72) {return &std::get<Prod>(variant);}
+    else if (variant.index() == 73) {return &std::get<Sum>(variant);}
+    else if (variant.index() == 74) {return &std::get<List>(variant);}
+    else if (variant.index() == 75) {return &std::get<Sliced>(variant);}
+    else if (variant.index() == 76) {return &std::get<Rate>(variant);}
+    else if (variant.index() == 77) {return &std::get<Affine>(variant);}
+
+    else if (variant.index() == 78) {return &std::get<Parameter>(variant);}
+    else if (variant.index() == 79) {return &std::get<MultiDimParameter>(variant);}
+    else if (variant.index() == 80) {return &std::get<SparseMultiDimParameter>(variant);}
+    else if (variant.index() == 81) {return &std::get<Variable>(variant);}
     return nullptr;
 }
 
@@ -2361,279 +2481,302 @@ int findElementGetIndex(const std::vector<variant_expression>& vec_of_different_
     return -1;
 }
 
-std::vector<variant_expression> get_variant_vector() {
+// Position of every expression (by ID) in a contiguous storage container
+std::unordered_map<int, size_t> indexByID(const std::vector<variant_expression>& vec_of_different_types) {
+    std::unordered_map<int, size_t> ret;
+    ret.reserve(vec_of_different_types.size());
+    for (size_t i=0; i<vec_of_different_types.size(); ++i) {
+        ret.emplace(std::visit([](auto&& v) {return v.getID();}, vec_of_different_types[i]), i);
+    }
+    return ret;
+}
 
-    // The return vector
-    std::vector<variant_expression> contiguousStorageContainer;
+/*  Constant folding: a Function whose arguments are all constants (Parameters or (Sparse)MultiDimParameters,
+ *  possibly folded themselves) does not depend on the variable. It is evaluated once and replaced
+ *  by a Parameter with the same ID and the exact sign of its value; its parents become the variants for that
+ *  sign (see exactVariant()).
+ */
+bool isConstant(Expression* e) {
+    if (dynamic_cast<Parameter*>(e) || dynamic_cast<MultiDimParameter*>(e) || dynamic_cast<SparseMultiDimParameter*>(e)) {
+        return true;
+    }
+    if (auto f = dynamic_cast<Function*>(e)) {
+        for (auto arg : f->getArgs()) {
+            if (!isConstant(arg)) {return false;}
+        }
+        return true;
+    }
+    return false;
+}
 
-    // Reserve Space, so pointers do not misbehave
-    contiguousStorageContainer.reserve(Expression::getExpressionList().size());
+// Returns true and adds the folded Parameter to the container if func has only constant arguments
+// (args are the arguments of the copy of func in the container)
+bool foldConstant(Function* func, const std::vector<Expression*>& args, std::vector<variant_expression>& container) {
+    for (auto arg : args) {
+        if (!dynamic_cast<Parameter*>(arg) && !dynamic_cast<MultiDimParameter*>(arg) && !dynamic_cast<SparseMultiDimParameter*>(arg)) {return false;}
+    }
 
-    // Für JEDE Expression des gegebenen Objectives
-    for (auto expr: Expression::getExpressionList()) {
+    const std::vector<double> none;
+    func->evaluate_root(none, none);
+    container.push_back(Parameter{*func->getValue(), func->getID()});
+    return true;
+}
 
-        // 1. Falls Parameter:
-        if (auto param = dynamic_cast<Parameter *>(expr)) {
-            // Füge Kopie zur zusammenhängenden Container hinzu
-            contiguousStorageContainer.push_back(Parameter{*param});
-        }
-        // 2. Falls MultiDimParameter:
-        if (auto param = dynamic_cast<MultiDimParameter *>(expr)) {
-            // Füge Kopie zur zusammenhängenden Container hinzu
-            contiguousStorageContainer.push_back(MultiDimParameter{*param});
-        }
-        // 3. Falls Variable:
-        if (auto var = dynamic_cast<Variable *>(expr)) {
-            // Füge Kopie zur zusammenhängenden Container hinzu
-            contiguousStorageContainer.push_back(Variable{*var});
-        }
+/*  Algebraic rewrites: chains of atoms that are built naively (e.g., by atoms.py) are replaced by fewer nodes
+ *  with the same value for every orientation (x,y), so the tree and the Tape evaluate less:
+ *    neg(neg(a))                              -> a
+ *    neg(c + s*a)                             -> -c + (-s)*a                 (Affine)
+ *    c + neg(a), c + (c' + s*a)               -> c + (-1)*a, (c' + c) + s*a  (Affine)
+ *    sum(mult(a, b))                          -> dot(a, b)                   (sign variant of the mult)
+ *  where c, c' are constants and (c' + s*a) stands for an Affine, an addition of a constant or a Neg. Merged nodes
+ *  have to have a single parent, they become unused and are removed by compact(); shared ones are kept. Merging
+ *  constants and the dot products with an argument of unknown sign change the order of the floating point
+ *  operations, the other rewrites give identical values. sum(mult(a, b)) for a and b both of unknown sign is not
+ *  rewritten: Dot_U_U has the same values in the tree (see split::mult()), but the Tape specializes the signs per
+ *  box and would sum the products in another order than the tree.
+ *  ----------------------------------------------------------------------------------------------------
+ */
 
-        // 4. Falls Funktion:
-        if (auto func = dynamic_cast<Function *>(expr)) {
-            // Erstelle temporären argument-Vektor:
-            std::vector<Expression *> tmp;
+// value of e if it is a (possibly folded) constant vector, nullptr otherwise
+const std::vector<double>* constantValue(Expression* e) {
+    auto p = dynamic_cast<Parameter*>(e);
+    return p ? p->getValue() : nullptr;
+}
 
-            // für JEDES Argument:
-            for (auto arg: func->getArgs()) {
-                // Suche in dem neuen variant_container nach der passenden Expression
-                int idToFind = arg->getID();
-                int vectorIndexOfArgument = findElementGetIndex(contiguousStorageContainer, idToFind);
-                Expression *parsedBasePointerCorrect = getBasePointer(
-                        contiguousStorageContainer.at(vectorIndexOfArgument));
+// elementwise a + b, a scalar is broadcast
+std::vector<double> addOffsets(const std::vector<double>& a, const std::vector<double>& b) {
+    std::vector<double> ret(std::max(a.size(), b.size()));
+    for (size_t i = 0; i < ret.size(); ++i) {
+        ret[i] = a[a.size() == 1 ? 0 : i] + b[b.size() == 1 ? 0 : i];
+    }
+    return ret;
+}
 
-                // Und speichere diesen gefunden Pointer/Adresse zu dem Argument.
-                tmp.push_back(parsedBasePointerCorrect);
+// Returns true if e = offset + scale * base, i.e., e is a Neg, or an Affine or an addition of a constant
+// with a single parent, and base has the dimension of e (not a scalar broadcast to a constant vector)
+bool affineView(Expression* e, Expression*& base, double& scale, std::vector<double>& offset) {
+    if (auto n = dynamic_cast<Neg*>(e)) {
+        base = n->getArgs().at(0);
+        scale = -1;
+        offset = {0};
+        return true;
+    }
+    if (e->getParents() != 1) {
+        return false;
+    }
+    if (auto a = dynamic_cast<Affine*>(e)) {
+        base = a->getArgs().at(0);
+        scale = a->getScale();
+        offset = a->getOffset();
+        return true;
+    }
+    if (dynamic_cast<Add_vec_scalar*>(e) || dynamic_cast<Add_vec_vec*>(e)) {
+        const auto& args = dynamic_cast<Function*>(e)->getArgs();
+        for (size_t i = 0; i < 2; ++i) {
+            auto c = constantValue(args[i]);
+            if (c && args[1 - i]->getDim() == e->getDim()) {
+                base = args[1 - i];
+                scale = 1;
+                offset = *c;
+                return true;
             }
+        }
+    }
+    return false;
+}
 
-            // Schließlich kopiere diese Funktion mit den gefunden Argumenten --> Hier Fallunterscheidung, je nach Funktionstyp (wg. unt. copy-Konstruktor)
-            if (auto old = dynamic_cast<Add_vec_scalar *>(func)) {
-                Add_vec_scalar copy_of_old = Add_vec_scalar{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Add_vec_vec *>(func)) {
-                Add_vec_vec copy_of_old = Add_vec_vec{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            }
+// Adds the dot product of the arguments of m if m is a MultT, returns false otherwise
+template <class MultT, class DotT>
+bool pushDot(Function* m, std::vector<variant_expression>& container) {
+    if (!dynamic_cast<MultT*>(m)) {
+        return false;
+    }
+    container.push_back(DotT{m->getArgs().at(0), m->getArgs().at(1)});
+    return true;
+}
 
-            else if (auto old = dynamic_cast<Mult_vecNN_scalarNN *>(func)) {
-                Mult_vecNN_scalarNN copy_of_old = Mult_vecNN_scalarNN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_vecNP_scalarNP *>(func)) {
-                Mult_vecNP_scalarNP copy_of_old = Mult_vecNP_scalarNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_vecNN_scalarNP *>(func)) {
-                Mult_vecNN_scalarNP copy_of_old = Mult_vecNN_scalarNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_vecNP_scalarNN *>(func)) {
-                Mult_vecNP_scalarNN copy_of_old = Mult_vecNP_scalarNN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_vecU_scalarNN *>(func)) {
-                Mult_vecU_scalarNN copy_of_old = Mult_vecU_scalarNN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_vecNN_scalarU *>(func)) {
-                Mult_vecNN_scalarU copy_of_old = Mult_vecNN_scalarU{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_vecU_scalarNP *>(func)) {
-                Mult_vecU_scalarNP copy_of_old = Mult_vecU_scalarNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_vecNP_scalarU *>(func)) {
-                Mult_vecNP_scalarU copy_of_old = Mult_vecNP_scalarU{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_vecU_scalarU *>(func)) {
-                Mult_vecU_scalarU copy_of_old = Mult_vecU_scalarU{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            }
+// Returns the expression replacing func (args are the arguments of the copy of func in the container), an
+// existing one or a new one added to the container, nullptr if no rewrite applies
+Expression* rewrite(Function* func, const std::vector<Expression*>& args, std::vector<variant_expression>& container) {
+    Expression* base;
+    double scale;
+    std::vector<double> offset;
 
-            else if (auto old = dynamic_cast<Mult_vecNN_vecNN *>(func)) {
-                Mult_vecNN_vecNN copy_of_old = Mult_vecNN_vecNN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_vecNP_vecNP *>(func)) {
-                Mult_vecNP_vecNP copy_of_old = Mult_vecNP_vecNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_vecNN_vecNP *>(func)) {
-                Mult_vecNN_vecNP copy_of_old = Mult_vecNN_vecNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_vecU_vecNN *>(func)) {
-                Mult_vecU_vecNN copy_of_old = Mult_vecU_vecNN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_vecU_vecNP *>(func)) {
-                Mult_vecU_vecNP copy_of_old = Mult_vecU_vecNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_vecU_vecU *>(func)) {
-                Mult_vecU_vecU copy_of_old = Mult_vecU_vecU{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            }
+    if (dynamic_cast<Neg*>(func)) {
+        if (auto n = dynamic_cast<Neg*>(args[0])) {
+            return n->getArgs().at(0);
+        }
+        if (affineView(args[0], base, scale, offset)) {
+            std::transform(offset.begin(), offset.end(), offset.begin(), [](double c){return -c;});
+            container.push_back(Affine{base, -scale, offset});
+            return getBasePointer(container.back());
+        }
+        return nullptr;
+    }
 
-            else if (auto old = dynamic_cast<Mult_MatNN_VecNN *>(func)) {
-                Mult_MatNN_VecNN copy_of_old = Mult_MatNN_VecNN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_MatNP_VecNP *>(func)) {
-                Mult_MatNP_VecNP copy_of_old = Mult_MatNP_VecNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_MatNN_VecNP *>(func)) {
-                Mult_MatNN_VecNP copy_of_old = Mult_MatNN_VecNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_MatNP_VecNN *>(func)) {
-                Mult_MatNP_VecNN copy_of_old = Mult_MatNP_VecNN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_MatU_VecNN *>(func)) {
-                Mult_MatU_VecNN copy_of_old = Mult_MatU_VecNN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_MatU_VecNP *>(func)) {
-                Mult_MatU_VecNP copy_of_old = Mult_MatU_VecNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_MatNN_VecU *>(func)) {
-                Mult_MatNN_VecU copy_of_old = Mult_MatNN_VecU{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_MatNP_VecU *>(func)) {
-                Mult_MatNP_VecU copy_of_old = Mult_MatNP_VecU{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Mult_MatU_VecU *>(func)) {
-                Mult_MatU_VecU copy_of_old = Mult_MatU_VecU{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
+    if (dynamic_cast<Add_vec_scalar*>(func) || dynamic_cast<Add_vec_vec*>(func)) {
+        for (size_t i = 0; i < 2; ++i) {
+            const std::vector<double>* c = constantValue(args[1 - i]);
+            if (c && args[i]->getDim() == func->getDim() && affineView(args[i], base, scale, offset)) {
+                container.push_back(Affine{base, scale, addOffsets(offset, *c)});
+                return getBasePointer(container.back());
             }
+        }
+        return nullptr;
+    }
 
-            else if (auto old = dynamic_cast<Dot_NN_NN *>(func)) {
-                Dot_NN_NN copy_of_old = Dot_NN_NN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Dot_NP_NP *>(func)) {
-                Dot_NP_NP copy_of_old = Dot_NP_NP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Dot_NN_NP *>(func)) {
-                Dot_NN_NP copy_of_old = Dot_NN_NP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Dot_U_NN *>(func)) {
-                Dot_U_NN copy_of_old = Dot_U_NN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Dot_U_NP *>(func)) {
-                Dot_U_NP copy_of_old = Dot_U_NP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Dot_U_U *>(func)) {
-                Dot_U_U copy_of_old = Dot_U_U{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            }
+    if (dynamic_cast<Sum*>(func)) {
+        auto m = dynamic_cast<Mult_vec_vec*>(args[0]);
+        if (!m || m->getParents() != 1) {
+            return nullptr;
+        }
+        if (pushDot<Mult_vecNN_vecNN, Dot_NN_NN>(m, container) || pushDot<Mult_vecNP_vecNP, Dot_NP_NP>(m, container)
+                || pushDot<Mult_vecNN_vecNP, Dot_NN_NP>(m, container) || pushDot<Mult_vecU_vecNN, Dot_U_NN>(m, container)
+                || pushDot<Mult_vecU_vecNP, Dot_U_NP>(m, container)) {
+            return getBasePointer(container.back());
+        }
+        return nullptr;
+    }
 
-            else if (auto old = dynamic_cast<Div_VecNN_VecNN *>(func)) {
-                Div_VecNN_VecNN copy_of_old = Div_VecNN_VecNN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_VecNP_VecNP *>(func)) {
-                Div_VecNP_VecNP copy_of_old = Div_VecNP_VecNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_VecNN_VecNP *>(func)) {
-                Div_VecNN_VecNP copy_of_old = Div_VecNN_VecNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_VecNP_VecNN *>(func)) {
-                Div_VecNP_VecNN copy_of_old = Div_VecNP_VecNN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_VecU_VecNN *>(func)) {
-                Div_VecU_VecNN copy_of_old = Div_VecU_VecNN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_VecU_VecNP *>(func)) {
-                Div_VecU_VecNP copy_of_old = Div_VecU_VecNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_VecNN_VecU *>(func)) {
-                Div_VecNN_VecU copy_of_old = Div_VecNN_VecU{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_VecNP_VecU *>(func)) {
-                Div_VecNP_VecU copy_of_old = Div_VecNP_VecU{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_VecU_VecU *>(func)) {
-                Div_VecU_VecU copy_of_old = Div_VecU_VecU{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            }
+    return nullptr;
+}
 
-            else if (auto old = dynamic_cast<Div_VecNN_ScalarNN *>(func)) {
-                Div_VecNN_ScalarNN copy_of_old = Div_VecNN_ScalarNN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_VecNP_ScalarNP *>(func)) {
-                Div_VecNP_ScalarNP copy_of_old = Div_VecNP_ScalarNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_VecNN_ScalarNP *>(func)) {
-                Div_VecNN_ScalarNP copy_of_old = Div_VecNN_ScalarNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_VecNP_ScalarNN *>(func)) {
-                Div_VecNP_ScalarNN copy_of_old = Div_VecNP_ScalarNN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_VecU_ScalarNN *>(func)) {
-                Div_VecU_ScalarNN copy_of_old = Div_VecU_ScalarNN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_VecU_ScalarNP *>(func)) {
-                Div_VecU_ScalarNP copy_of_old = Div_VecU_ScalarNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_VecNN_ScalarU *>(func)) {
-                Div_VecNN_ScalarU copy_of_old = Div_VecNN_ScalarU{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_VecNP_ScalarU *>(func)) {
-                Div_VecNP_ScalarU copy_of_old = Div_VecNP_ScalarU{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_VecU_ScalarU *>(func)) {
-                Div_VecU_ScalarU copy_of_old = Div_VecU_ScalarU{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            }
+/*  Sign variants of folded constants: a constant argument has the exact sign of its value (see foldConstant()),
+ *  which can be tighter than the sign the atom was built for (e.g., mult(a, c) of unknown a and a constant c that
+ *  only folds to a nonnegative value in the Model). The copy of such an atom is the variant for the exact signs.
+ *  ----------------------------------------------------------------------------------------------------
+ */
 
-            else if (auto old = dynamic_cast<Div_ScalarNN_VecNN *>(func)) {
-                Div_ScalarNN_VecNN copy_of_old = Div_ScalarNN_VecNN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_ScalarNP_VecNP *>(func)) {
-                Div_ScalarNP_VecNP copy_of_old = Div_ScalarNP_VecNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_ScalarNN_VecNP *>(func)) {
-                Div_ScalarNN_VecNP copy_of_old = Div_ScalarNN_VecNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_ScalarNP_VecNN *>(func)) {
-                Div_ScalarNP_VecNN copy_of_old = Div_ScalarNP_VecNN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_ScalarU_VecNN *>(func)) {
-                Div_ScalarU_VecNN copy_of_old = Div_ScalarU_VecNN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_ScalarU_VecNP *>(func)) {
-                Div_ScalarU_VecNP copy_of_old = Div_ScalarU_VecNP{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_ScalarNN_VecU *>(func)) {
-                Div_ScalarNN_VecU copy_of_old = Div_ScalarNN_VecU{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_ScalarNP_VecU *>(func)) {
-                Div_ScalarNP_VecU copy_of_old = Div_ScalarNP_VecU{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Div_ScalarU_VecU *>(func)) {
-                Div_ScalarU_VecU copy_of_old = Div_ScalarU_VecU{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            }
+// placeholder for a sign variant without a class of its own: T with the arguments in reverse order
+template <class T>
+struct Swapped {};
+
+template <class T>
+bool isVariant(Function* func, T*) {return dynamic_cast<T*>(func) != nullptr;}
+template <class T>
+bool isVariant(Function*, Swapped<T>*) {return false;}
+
+template <class T>
+void pushVariant(T*, Expression* a, Expression* b, std::vector<variant_expression>& container) {container.push_back(T{a, b});}
+template <class T>
+void pushVariant(Swapped<T>*, Expression* a, Expression* b, std::vector<variant_expression>& container) {container.push_back(T{b, a});}
+
+// V are the variants of an atom for the signs of the arguments (NN,NN), (NN,NP), (NN,U), (NP,NN), ... (U,U). Adds
+// the variant for the exact signs of the constant arguments if func is one of V and returns true, false otherwise
+template <class... V>
+bool pushExactVariant(Function* func, const std::vector<Expression*>& args, std::vector<variant_expression>& container) {
+    static_assert(sizeof...(V) == 9, "one variant per pair of signs");
+    const bool is[] = {isVariant(func, static_cast<V*>(nullptr))...};
+    const size_t i = std::find(is, is + 9, true) - is;
+    if (i == 9) {
+        return false;
+    }
 
-            else if (auto old = dynamic_cast<Log2 *>(func)) {
-                Log2 copy_of_old = Log2{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<LogN *>(func)) {
-                LogN copy_of_old = LogN{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Inv *>(func)) {
-                Inv copy_of_old = Inv{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Neg *>(func)) {
-                Neg copy_of_old = Neg{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Prod *>(func)) {
-                Prod copy_of_old = Prod{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Sum *>(func)) {
-                Sum copy_of_old = Sum{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<List *>(func)) {
-                List copy_of_old = List{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            } else if (auto old = dynamic_cast<Sliced *>(func)) {
-                Sliced copy_of_old = Sliced{*old, tmp};
-                contiguousStorageContainer.push_back(copy_of_old);
-            }
+    sign s[] = {static_cast<sign>(i / 3), static_cast<sign>(i % 3)};
+    for (size_t k = 0; k < 2; ++k) {
+        if (s[k] == unknown && dynamic_cast<Parameter*>(args[k])) {
+            s[k] = args[k]->getSign();
         }
     }
-    return contiguousStorageContainer;
+    const size_t j = 3 * s[0] + s[1];
+    if (j == i) {
+        return false;
+    }
+    size_t k = 0;
+    ((k++ == j ? pushVariant(static_cast<V*>(nullptr), args[0], args[1], container) : void()), ...);
+    return true;
 }
 
+// Returns the variant of func (args are the arguments of the copy of func in the container) for the exact signs
+// of its constant arguments, added to the container, nullptr if func already is that variant
+Expression* exactVariant(Function* func, const std::vector<Expression*>& args, std::vector<variant_expression>& container) {
+    if (pushExactVariant<Mult_vecNN_scalarNN, Mult_vecNN_scalarNP, Mult_vecNN_scalarU, Mult_vecNP_scalarNN, Mult_vecNP_scalarNP,
+                         Mult_vecNP_scalarU, Mult_vecU_scalarNN, Mult_vecU_scalarNP, Mult_vecU_scalarU>(func, args, container)
+            || pushExactVariant<Mult_vecNN_vecNN, Mult_vecNN_vecNP, Swapped<Mult_vecU_vecNN>, Swapped<Mult_vecNN_vecNP>, Mult_vecNP_vecNP,
+                                Swapped<Mult_vecU_vecNP>, Mult_vecU_vecNN, Mult_vecU_vecNP, Mult_vecU_vecU>(func, args, container)
+            || pushExactVariant<Div_VecNN_VecNN, Div_VecNN_VecNP, Div_VecNN_VecU, Div_VecNP_VecNN, Div_VecNP_VecNP,
+                                Div_VecNP_VecU, Div_VecU_VecNN, Div_VecU_VecNP, Div_VecU_VecU>(func, args, container)
+            || pushExactVariant<Div_VecNN_ScalarNN, Div_VecNN_ScalarNP, Div_VecNN_ScalarU, Div_VecNP_ScalarNN, Div_VecNP_ScalarNP,
+                                Div_VecNP_ScalarU, Div_VecU_ScalarNN, Div_VecU_ScalarNP, Div_VecU_ScalarU>(func, args, container)
+            || pushExactVariant<Div_ScalarNN_VecNN, Div_ScalarNN_VecNP, Div_ScalarNN_VecU, Div_ScalarNP_VecNN, Div_ScalarNP_VecNP,
+                                Div_ScalarNP_VecU, Div_ScalarU_VecNN, Div_ScalarU_VecNP, Div_ScalarU_VecU>(func, args, container)
+            || pushExactVariant<Dot_NN_NN, Dot_NN_NP, Swapped<Dot_U_NN>, Swapped<Dot_NN_NP>, Dot_NP_NP,
+                                Swapped<Dot_U_NP>, Dot_U_NN, Dot_U_NP, Dot_U_U>(func, args, container)) {
+        return getBasePointer(container.back());
+    }
+    return nullptr;
+}
 
-std::vector<variant_expression> get_variant_vector(Expression* objective) {
+// Removes the expressions of the container no root depends on (merged by rewrite(), arguments of folded constants)
+// and updates the positions in index, the ones of removed expressions are erased. The container has every
+// expression after its arguments, so has the result.
+void compact(std::vector<variant_expression>& container, const std::vector<size_t>& roots, std::unordered_map<int, size_t>& index) {
+    std::unordered_map<const Expression*, size_t> position;
+    for (size_t i = 0; i < container.size(); ++i) {
+        position[getBasePointer(container[i])] = i;
+    }
+    std::vector<bool> used(container.size(), false);
+    for (auto r : roots) {
+        used[r] = true;
+    }
+    for (size_t i = container.size(); i-- > 0;) {
+        if (auto f = dynamic_cast<Function*>(getBasePointer(container[i])); f && used[i]) {
+            for (auto arg : f->getArgs()) {
+                used[position.at(arg)] = true;
+            }
+        }
+    }
+    if (std::find(used.begin(), used.end(), false) == used.end()) {
+        return;
+    }
+
+    // the copies point to their arguments, so they are copied again with the arguments in the new container
+    std::vector<variant_expression> compacted;
+    compacted.reserve(std::count(used.begin(), used.end(), true));
+    std::vector<size_t> newPosition(container.size());
+    for (size_t i = 0; i < container.size(); ++i) {
+        if (!used[i]) {
+            continue;
+        }
+        std::visit([&](auto& e) {
+            using T = std::decay_t<decltype(e)>;
+            if constexpr (std::is_base_of_v<Function, T>) {
+                std::vector<Expression*> args;
+                for (auto arg : e.getArgs()) {
+                    args.push_back(getBasePointer(compacted[newPosition[position.at(arg)]]));
+                }
+                compacted.push_back(T{e, args});
+            } else {
+                compacted.push_back(e);
+            }
+        }, container[i]);
+        newPosition[i] = compacted.size() - 1;
+    }
+
+    for (auto it = index.begin(); it != index.end();) {
+        if (used[it->second]) {
+            it->second = newPosition[it->second];
+            ++it;
+        } else {
+            it = index.erase(it);
+        }
+    }
+    container = std::move(compacted);
+}
 
-    // Get a vector with all expressions from the objective
-    std::vector<Expression*> list_of_expressions_in_objective = objective->get_expression_list();
+// Copies of all expressions reachable from the roots (e.g., objective and constraint functions), every
+// expression after its arguments; shared subexpressions are copied once. With simplify, the copies are
+// rewritten (see rewrite()), so an expression may be replaced by another one; index (if given) receives the
+// position of the copy of (or replacing) every expression (by ID) a root still depends on, see compact().
+std::vector<variant_expression> get_variant_vector(const std::vector<Expression*>& roots,
+                                                   std::unordered_map<int, size_t>* index = nullptr, bool simplify = true) {
+
+    // Get a vector with all expressions from the roots
+    std::vector<Expression*> list_of_expressions_in_objective;
+    std::unordered_set<int> visited;
+    for (auto root : roots) {
+        root->add_to_expr_list(list_of_expressions_in_objective, visited);
+    }
 
     // The return vector
     std::vector<variant_expression> contiguousStorageContainer;
@@ -2641,8 +2784,14 @@ std::vector<variant_expression> get_variant_vector(Expression* objective) {
     // Reserve Space, so pointers do not misbehave
     contiguousStorageContainer.reserve(list_of_expressions_in_objective.size());
 
+    // Position of the copy of every expression (by ID) in the container
+    std::unordered_map<int, size_t> indexOf;
+    indexOf.reserve(list_of_expressions_in_objective.size());
+
     // Für JEDE Expression des gegebenen Objectives
     for (auto expr : list_of_expressions_in_objective) {
+        const size_t sizeBefore = contiguousStorageContainer.size();
+
 
         // 1. Falls Parameter:
         if (auto param = dynamic_cast<Parameter*>(expr)) {
@@ -2654,6 +2803,11 @@ std::vector<variant_expression> get_variant_vector(Expression* objective) {
             // Füge Kopie zur zusammenhängenden Container hinzu
             contiguousStorageContainer.push_back(MultiDimParameter{*param});
         }
+        // 2b. Falls SparseMultiDimParameter:
+        if (auto param = dynamic_cast<SparseMultiDimParameter*>(expr)) {
+            // Füge Kopie zur zusammenhängenden Container hinzu
+            contiguousStorageContainer.push_back(SparseMultiDimParameter{*param});
+        }
         // 3. Falls Variable:
         if (auto var = dynamic_cast<Variable*>(expr)) {
             // Füge Kopie zur zusammenhängenden Container hinzu
@@ -2669,13 +2823,39 @@ std::vector<variant_expression> get_variant_vector(Expression* objective) {
             for (auto arg : func->getArgs()) {
                 // Suche in dem neuen variant_container nach der passenden Expression
                 int idToFind = arg->getID();
-                int vectorIndexOfArgument = findElementGetIndex(contiguousStorageContainer, idToFind);
+                size_t vectorIndexOfArgument = indexOf.at(idToFind);
                 Expression* parsedBasePointerCorrect = getBasePointer(contiguousStorageContainer.at(vectorIndexOfArgument));
 
                 // Und speichere diesen gefunden Pointer/Adresse zu dem Argument.
                 tmp.push_back(parsedBasePointerCorrect);
             }
 
+            // Teilbäume ohne Variable werden durch einen Parameter ersetzt
+            if (foldConstant(func, tmp, contiguousStorageContainer)) {
+                indexOf[expr->getID()] = contiguousStorageContainer.size() - 1;
+                continue;
+            }
+
+            // Atome mit gefalteten Argumenten werden durch die Variante für deren exaktes Vorzeichen ersetzt
+            if (Expression* variant = exactVariant(func, tmp, contiguousStorageContainer)) {
+                variant->inheritParents(*func);
+                indexOf[variant->getID()] = contiguousStorageContainer.size() - 1;
+                indexOf[expr->getID()] = contiguousStorageContainer.size() - 1;
+                continue;
+            }
+
+            // Ketten von Atomen werden zusammengefasst, neue Ausdrücke werden auch unter ihrer eigenen ID eingetragen
+            if (simplify) {
+                if (Expression* replacement = rewrite(func, tmp, contiguousStorageContainer)) {
+                    if (contiguousStorageContainer.size() > sizeBefore) {
+                        replacement->inheritParents(*func);
+                        indexOf[replacement->getID()] = contiguousStorageContainer.size() - 1;
+                    }
+                    indexOf[expr->getID()] = indexOf.at(replacement->getID());
+                    continue;
+                }
+            }
+
             // Schließlich kopiere diese Funktion mit den gefunden Argumenten --> Hier Fallunterscheidung, je nach Funktionstyp (wg. unt. copy-Konstruktor)
             if (auto old = dynamic_cast<Add_vec_scalar *>(func)) {
                 Add_vec_scalar copy_of_old = Add_vec_scalar{*old, tmp};
@@ -2763,6 +2943,35 @@ std::vector<variant_expression> get_variant_vector(Expression* objective) {
                 contiguousStorageContainer.push_back(copy_of_old);
             }
 
+            else if (auto old = dynamic_cast<Mult_SpMatNN_VecNN *>(func)) {
+                Mult_SpMatNN_VecNN copy_of_old = Mult_SpMatNN_VecNN{*old, tmp};
+                contiguousStorageContainer.push_back(copy_of_old);
+            } else if (auto old = dynamic_cast<Mult_SpMatNP_VecNP *>(func)) {
+                Mult_SpMatNP_VecNP copy_of_old = Mult_SpMatNP_VecNP{*old, tmp};
+                contiguousStorageContainer.push_back(copy_of_old);
+            } else if (auto old = dynamic_cast<Mult_SpMatNN_VecNP *>(func)) {
+                Mult_SpMatNN_VecNP copy_of_old = Mult_SpMatNN_VecNP{*old, tmp};
+                contiguousStorageContainer.push_back(copy_of_old);
+            } else if (auto old = dynamic_cast<Mult_SpMatNP_VecNN *>(func)) {
+                Mult_SpMatNP_VecNN copy_of_old = Mult_SpMatNP_VecNN{*old, tmp};
+                contiguousStorageContainer.push_back(copy_of_old);
+            } else if (auto old = dynamic_cast<Mult_SpMatU_VecNN *>(func)) {
+                Mult_SpMatU_VecNN copy_of_old = Mult_SpMatU_VecNN{*old, tmp};
+                contiguousStorageContainer.push_back(copy_of_old);
+            } else if (auto old = dynamic_cast<Mult_SpMatU_VecNP *>(func)) {
+                Mult_SpMatU_VecNP copy_of_old = Mult_SpMatU_VecNP{*old, tmp};
+                contiguousStorageContainer.push_back(copy_of_old);
+            } else if (auto old = dynamic_cast<Mult_SpMatNN_VecU *>(func)) {
+                Mult_SpMatNN_VecU copy_of_old = Mult_SpMatNN_VecU{*old, tmp};
+                contiguousStorageContainer.push_back(copy_of_old);
+            } else if (auto old = dynamic_cast<Mult_SpMatNP_VecU *>(func)) {
+                Mult_SpMatNP_VecU copy_of_old = Mult_SpMatNP_VecU{*old, tmp};
+                contiguousStorageContainer.push_back(copy_of_old);
+            } else if (auto old = dynamic_cast<Mult_SpMatU_VecU *>(func)) {
+                Mult_SpMatU_VecU copy_of_old = Mult_SpMatU_VecU{*old, tmp};
+                contiguousStorageContainer.push_back(copy_of_old);
+            }
+
             else if (auto old = dynamic_cast<Dot_NN_NN *>(func)) {
                 Dot_NN_NN copy_of_old = Dot_NN_NN{*old, tmp};
                 contiguousStorageContainer.push_back(copy_of_old);
@@ -2894,10 +3103,35 @@ std::vector<variant_expression> get_variant_vector(Expression* objective) {
             } else if (auto old = dynamic_cast<Sliced *>(func)) {
                 Sliced copy_of_old = Sliced{*old, tmp};
                 contiguousStorageContainer.push_back(copy_of_old);
+            } else if (auto old = dynamic_cast<Rate *>(func)) {
+                Rate copy_of_old = Rate{*old, tmp};
+                contiguousStorageContainer.push_back(copy_of_old);
+            } else if (auto old = dynamic_cast<Affine *>(func)) {
+                Affine copy_of_old = Affine{*old, tmp};
+                contiguousStorageContainer.push_back(copy_of_old);
             }
         }
+
+        if (contiguousStorageContainer.size() > sizeBefore) {
+            indexOf[expr->getID()] = contiguousStorageContainer.size() - 1;
+        }
+    }
+
+    // Zusammengefasste und gefaltete Ausdrücke werden entfernt
+    std::vector<size_t> rootPositions;
+    for (auto root : roots) {
+        rootPositions.push_back(indexOf.at(root->getID()));
+    }
+    compact(contiguousStorageContainer, rootPositions, indexOf);
+
+    if (index) {
+        *index = std::move(indexOf);
     }
     return contiguousStorageContainer;
 }
 
+std::vector<variant_expression> get_variant_vector(Expression* objective) {
+    return get_variant_vector(std::vector<Expression*>{objective});
+}
+
 #endif //EXPRTREE_FUNCTION_H
\ No newline at end of file
@@ -9,8 +9,17 @@ class Leaf: public Expression
 {
   public:
     explicit Leaf(const std::string& name) : Expression(name){};
+    Leaf(const std::string& name, int id) : Expression(name, id){};
     Leaf(const Leaf & old) = default;
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {};
+    // constant value
+    void evaluate_interval(const std::vector<double>&, const std::vector<double>&) override {
+        m_lower = m_value;
+        m_upper = m_value;
+    };
+    const std::vector<double>& evaluate_ref(const std::vector<double>&, const std::vector<double>&) override {
+        return m_value;
+    };
 };
 
 #endif //EXPRTREE_LEAF_H
@@ -0,0 +1,55 @@
+#ifndef EXPRTREE_MODEL_H
+#define EXPRTREE_MODEL_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Expression.h"
+#include "Function.h"
+
+/*
+ * Storage of the expressions of one optimization problem.
+ *
+ * The expressions reachable from the given roots (objective and constraint
+ * functions) are copied into one contiguous container, see
+ * get_variant_vector(); expressions of other models are not touched. The
+ * Model owns the copies: they do not depend on the expressions they were
+ * copied from and are freed all at once together with the Model. The copies
+ * are simplified by the algebraic rewrites (see rewrite()) unless disabled,
+ * so get() may return a copy replacing the expression. The copies share one
+ * EvalContext for the memoization of their values, see evaluate_root().
+ */
+class Model
+{
+  public:
+    Model() = default;
+    explicit Model(const std::vector<Expression*>& roots, bool simplify = true) {
+        m_nodes = get_variant_vector(roots, &m_indexOf, simplify);
+        for (auto& node : m_nodes) {
+            getBasePointer(node)->setContext(m_context.get());
+        }
+    };
+    // the copies point to each other, so a Model can be moved but not copied
+    Model(const Model &old) = delete;
+    Model& operator=(const Model &old) = delete;
+    Model(Model &&old) = default;
+    Model& operator=(Model &&old) = default;
+
+    // copy of (or replacing) the expression e (a root or an expression a root depends on), nullptr if e is not in the Model
+    // (also if it was merged into another expression or folded into a constant, see compact())
+    Expression* get(const Expression* e) {
+        auto it = m_indexOf.find(e->getID());
+        return it == m_indexOf.end() ? nullptr : getBasePointer(m_nodes[it->second]);
+    };
+    std::vector<variant_expression>& getNodes() {return m_nodes;};
+    size_t size() const {return m_nodes.size();};
+
+  private:
+    std::vector<variant_expression> m_nodes;
+    // position of the copy of (or replacing) every expression (by ID) in m_nodes
+    std::unordered_map<int, size_t> m_indexOf;
+    // owned by pointer, the copies keep it when the Model is moved
+    std::unique_ptr<EvalContext> m_context = std::make_unique<EvalContext>();
+};
+
+#endif //EXPRTREE_MODEL_H
@@ -3,6 +3,7 @@
 
 #include "Leaf.h"
 #include "util/Matrix.h"
+#include "util/SparseMatrix.h"
 
 class Parameter: public Leaf
 {
@@ -10,18 +11,26 @@ class Parameter: public Leaf
     explicit Parameter(const std::vector<double>& valuein = {} ) : Leaf("Parameter") {
         this->m_dim = valuein.size();
         this->m_value = valuein;
-        for (int i=0; i<m_dim; ++i) {
-            if (m_value.at(i) >= 0) {
-                this->m_sign = NN;
-            } else if (m_value.at(i) <= 0) {
-                this->m_sign = NP;
-            } else {
-                this->m_sign = unknown;
-            }
-        }
+        this->m_sign = signOf(valuein);
+    };
+    // Parameter replacing the (constant) expression with ID id, see foldConstant()
+    Parameter(const std::vector<double>& valuein, int id) : Leaf("Parameter", id) {
+        this->m_dim = valuein.size();
+        this->m_value = valuein;
+        this->m_sign = signOf(valuein);
     };
     Parameter(const Parameter & old) = default;
     static bool isExisting(std::vector<double>* value){};
+
+    // exact sign of a constant: NN if all elements are >= 0, NP if all are <= 0
+    static sign signOf(const std::vector<double>& value) {
+        if (std::all_of(value.begin(), value.end(), [](double v){return v >= 0;})) {
+            return NN;
+        } else if (std::all_of(value.begin(), value.end(), [](double v){return v <= 0;})) {
+            return NP;
+        }
+        return unknown;
+    };
 };
 
 class MultiDimParameter: public Leaf
@@ -30,15 +39,7 @@ class MultiDimParameter: public Leaf
     explicit MultiDimParameter(int rows, int cols, const std::vector<double>& valuein) : Leaf("MultDimParameter") {
         this->m_dim = 0;
         this->m_matrix = Matrix(rows, cols, valuein);
-        for (int i=0; i<valuein.size(); ++i) {
-            if (valuein.at(i) >= 0) {
-                this->m_sign = NN;
-            } else if (valuein.at(i) <= 0) {
-                this->m_sign = NP;
-            } else {
-                this->m_sign = unknown;
-            }
-        }
+        this->m_sign = Parameter::signOf(valuein);
     };
     MultiDimParameter(const MultiDimParameter & old) : Leaf(old) {
         m_matrix = old.m_matrix;
@@ -49,4 +50,29 @@ class MultiDimParameter: public Leaf
   private:
     Matrix m_matrix;
 };
+
+class SparseMultiDimParameter: public Leaf
+{
+  public:
+    // from a dense row-major matrix, zeros are not stored
+    explicit SparseMultiDimParameter(int rows, int cols, const std::vector<double>& valuein) : Leaf("SparseMultDimParameter") {
+        this->m_dim = 0;
+        this->m_matrix = SparseMatrix(rows, cols, valuein);
+        this->m_sign = Parameter::signOf(m_matrix.getValues());
+    };
+    // from CSR arrays
+    SparseMultiDimParameter(int rows, int cols, const std::vector<size_t>& rowPtr, const std::vector<size_t>& colIdx, const std::vector<double>& valuein) : Leaf("SparseMultDimParameter") {
+        this->m_dim = 0;
+        this->m_matrix = SparseMatrix(rows, cols, rowPtr, colIdx, valuein);
+        this->m_sign = Parameter::signOf(m_matrix.getValues());
+    };
+    SparseMultiDimParameter(const SparseMultiDimParameter & old) : Leaf(old) {
+        m_matrix = old.m_matrix;
+    };
+    SparseMatrix* getValue() {return &m_matrix;};
+    void printValue() override {m_matrix.print();};
+    std::vector<size_t> getDim() const {return m_matrix.getDim();};
+  private:
+    SparseMatrix m_matrix;
+};
 #endif //EXPRTREE_PARAMETER_H
\ No newline at end of file
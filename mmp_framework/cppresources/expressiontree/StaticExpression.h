@@ -0,0 +1,528 @@
+#ifndef EXPRTREE_STATICEXPRESSION_H
+#define EXPRTREE_STATICEXPRESSION_H
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "Expression.h"
+#include "util/VecMath.h"
+
+/*
+ * Expression templates for MMP objectives known at compile time, the C++
+ * counterpart of atoms.py (add, mult, div, dot, log2, ln, inv, neg, prod,
+ * sum, and the operators + - * /). An objective is a type built from the
+ * nodes below, e.g. for the sum rate of 4 users
+ *
+ *     auto p = et::variable<4, NN>();
+ *     auto obj = et::sum(et::log2(1.0 + et::constant<NN>(alpha) * p
+ *                                     / (et::constant<NN>(sigma) + et::mult(et::matrix<NN>(beta), p))));
+ *
+ * and StaticProblem<4, decltype(obj)> (algorithm/StaticProblem.h) is the MMP
+ * problem with this objective. Every node has
+ *
+ *   size  the length of its value (Dim for variables, 1 for scalars),
+ *   dim   the dimension of the variable it depends on (0 for constants),
+ *   sgn   its sign on the box, NN, NP or unknown, as the sign variants of
+ *         Function.h,
+ *   eval(x, y)  its MMP bound for the arguments (x, y) as std::array.
+ *
+ * The sign of a node selects at compile time in which orientations, (x,y)
+ * or the swapped (y,x), it evaluates its operands, so the type of the
+ * objective fixes the whole evaluation. With the lengths known as well, the
+ * compiler inlines it into one function without allocations or virtual
+ * calls and vectorizes the loops. A node of unknown sign splits its operand
+ * into the positive and the negative part, which needs both orientations;
+ * operands shared by several nodes are evaluated once per use.
+ *
+ * Variables take their sign from the user (as Variable in Python), constants
+ * may declare one, checked when they are created: constant<NN>(v),
+ * matrix<NN>(m). Plain numbers in an expression are constants of unknown
+ * sign. Divisions need a denominator of known sign (checked by the compiler),
+ * zeros in the denominator give infinite bounds. The logs are those of
+ * util/VecMath.h, as in the expression tree and the Tape.
+ */
+namespace et
+{
+
+// base of all nodes, the operators only take nodes (and numbers)
+class Node {};
+
+template <typename T>
+constexpr bool isNode = std::is_base_of_v<Node, T>;
+
+namespace detail
+{
+
+constexpr sign multSign(sign a, sign b) {return a == unknown || b == unknown ? unknown : (a == b ? NN : NP);}
+constexpr sign addSign(sign a, sign b) {return a == b ? a : unknown;}
+constexpr sign flip(sign a) {return a == NN ? NP : (a == NP ? NN : unknown);}
+
+// length of the result of an element-wise operation, one operand may be a scalar
+constexpr size_t broadcast(size_t a, size_t b) {return a == 1 ? b : a;}
+
+template <size_t N>
+inline double at(const std::array<double, N>& v, size_t i) {return v[N == 1 ? 0 : i];}
+
+template <sign S>
+inline double pos(double v) {
+    if constexpr (S == NN) {
+        return v;
+    } else {
+        return v >= 0 ? v : 0;
+    }
+}
+template <sign S>
+inline double neg(double v) {
+    if constexpr (S == NP) {
+        return v;
+    } else {
+        return v >= 0 ? 0 : v;
+    }
+}
+
+// MMP bound of a*b from the operands in the orientation of the product (a, b)
+// and in the swapped one (as, bs): with a = pos(a) + neg(a) and b likewise,
+// each of the four products of the parts is monotone in both of them. The
+// parts that vanish for the known signs are left out.
+template <sign Sa, sign Sb>
+inline double mult(double a, double as, double b, double bs) {
+    double r = 0;
+    if constexpr (Sa != NP && Sb != NP) {r += pos<Sa>(a) * pos<Sb>(b);}
+    if constexpr (Sa != NP && Sb != NN) {r += pos<Sa>(as) * neg<Sb>(b);}
+    if constexpr (Sa != NN && Sb != NP) {r += neg<Sa>(a) * pos<Sb>(bs);}
+    if constexpr (Sa != NN && Sb != NN) {r += neg<Sa>(as) * neg<Sb>(bs);}
+    return r;
+}
+// orientations read by mult<Sa, Sb>()
+template <sign Sa, sign Sb> constexpr bool multReadsA = Sb != NP;
+template <sign Sa, sign Sb> constexpr bool multReadsAs = Sb != NN;
+template <sign Sa, sign Sb> constexpr bool multReadsB = Sa != NP;
+template <sign Sa, sign Sb> constexpr bool multReadsBs = Sa != NN;
+
+// MMP bound of a/b, as mult() with 1/b, which is nonincreasing in b and has its sign
+template <sign Sa, sign Sb>
+inline double div(double a, double as, double b, double bs) {
+    static_assert(Sb != unknown, "et::div: the sign of the denominator must be known");
+    const double x = Sb == NN ? a : as;
+    double r = 0;
+    if constexpr (Sa != NP) {r += pos<Sa>(x) / bs;}
+    if constexpr (Sa != NN) {r += neg<Sa>(x) / b;}
+    return r;
+}
+template <sign Sa, sign Sb> constexpr bool divReadsA = Sb == NN;
+template <sign Sa, sign Sb> constexpr bool divReadsAs = Sb == NP;
+template <sign Sa, sign Sb> constexpr bool divReadsB = Sa != NN;
+template <sign Sa, sign Sb> constexpr bool divReadsBs = Sa != NP;
+
+template <sign S>
+inline void checkSign(double v, const char* what) {
+    if ((S == NN && !(v >= 0)) || (S == NP && !(v <= 0))) {
+        throw std::invalid_argument(std::string(what) + ": value does not have the given sign");
+    }
+}
+
+// value of e for (x,y) if it is read, zeros otherwise
+template <bool Read, typename E, typename V>
+inline std::array<double, E::size> evalIf(const E& e, const V& x, const V& y) {
+    if constexpr (Read) {
+        return e.eval(x, y);
+    } else {
+        return {};
+    }
+}
+
+} // namespace detail
+
+template <size_t Dim, sign S>
+class Variable : public Node
+{
+  public:
+    static constexpr size_t size = Dim, dim = Dim;
+    static constexpr sign sgn = S;
+
+    template <typename V>
+    std::array<double, size> eval(const V& x, const V&) const {
+        std::array<double, size> r;
+        for (size_t i = 0; i < size; ++i) {r[i] = static_cast<double>(x[i]);}
+        return r;
+    };
+};
+
+template <size_t N, sign S>
+class Constant : public Node
+{
+  public:
+    static constexpr size_t size = N, dim = 0;
+    static constexpr sign sgn = S;
+
+    explicit Constant(const std::array<double, N>& value) : m_value(value) {
+        for (double v : value) {detail::checkSign<S>(v, "et::constant");}
+    };
+
+    template <typename V>
+    std::array<double, size> eval(const V&, const V&) const {return m_value;};
+
+  private:
+    std::array<double, N> m_value;
+};
+
+// constant matrix (row-major), only as first operand of mult()
+template <size_t R, size_t C, sign S>
+class Matrix
+{
+  public:
+    using Rows = std::array<std::array<double, C>, R>;
+
+    explicit Matrix(const Rows& m) : m_rows(m) {
+        for (const auto& row : m) {
+            for (double v : row) {detail::checkSign<S>(v, "et::matrix");}
+        }
+    };
+    const Rows& rows() const {return m_rows;};
+
+  private:
+    Rows m_rows;
+};
+
+// base of the nodes with two operands
+template <typename A, typename B>
+class Binary : public Node
+{
+    static_assert(A::dim == 0 || B::dim == 0 || A::dim == B::dim, "et: variables of different dimensions");
+
+  public:
+    static constexpr size_t dim = A::dim == 0 ? B::dim : A::dim;
+
+  protected:
+    Binary(const A& a, const B& b) : m_a(a), m_b(b) {};
+    A m_a;
+    B m_b;
+};
+
+template <typename A, typename B>
+class Add : public Binary<A, B>
+{
+    static_assert(A::size == B::size || A::size == 1 || B::size == 1, "et::add: lengths do not match");
+
+  public:
+    static constexpr size_t size = detail::broadcast(A::size, B::size);
+    static constexpr sign sgn = detail::addSign(A::sgn, B::sgn);
+
+    Add(const A& a, const B& b) : Binary<A, B>(a, b) {};
+
+    template <typename V>
+    std::array<double, size> eval(const V& x, const V& y) const {
+        const auto a = this->m_a.eval(x, y);
+        const auto b = this->m_b.eval(x, y);
+        std::array<double, size> r;
+        for (size_t i = 0; i < size; ++i) {r[i] = detail::at(a, i) + detail::at(b, i);}
+        return r;
+    };
+};
+
+template <typename A, typename B>
+class Mult : public Binary<A, B>
+{
+    static_assert(A::size == B::size || A::size == 1 || B::size == 1, "et::mult: lengths do not match");
+    static constexpr sign Sa = A::sgn, Sb = B::sgn;
+
+  public:
+    static constexpr size_t size = detail::broadcast(A::size, B::size);
+    static constexpr sign sgn = detail::multSign(Sa, Sb);
+
+    Mult(const A& a, const B& b) : Binary<A, B>(a, b) {};
+
+    template <typename V>
+    std::array<double, size> eval(const V& x, const V& y) const {
+        const auto a = detail::evalIf<detail::multReadsA<Sa, Sb>>(this->m_a, x, y);
+        const auto as = detail::evalIf<detail::multReadsAs<Sa, Sb>>(this->m_a, y, x);
+        const auto b = detail::evalIf<detail::multReadsB<Sa, Sb>>(this->m_b, x, y);
+        const auto bs = detail::evalIf<detail::multReadsBs<Sa, Sb>>(this->m_b, y, x);
+        std::array<double, size> r;
+        for (size_t i = 0; i < size; ++i) {
+            r[i] = detail::mult<Sa, Sb>(detail::at(a, i), detail::at(as, i), detail::at(b, i), detail::at(bs, i));
+        }
+        return r;
+    };
+};
+
+template <typename A, typename B>
+class Div : public Binary<A, B>
+{
+    static_assert(A::size == B::size || A::size == 1 || B::size == 1, "et::div: lengths do not match");
+    static constexpr sign Sa = A::sgn, Sb = B::sgn;
+
+  public:
+    static constexpr size_t size = detail::broadcast(A::size, B::size);
+    static constexpr sign sgn = detail::multSign(Sa, Sb);
+
+    Div(const A& a, const B& b) : Binary<A, B>(a, b) {};
+
+    template <typename V>
+    std::array<double, size> eval(const V& x, const V& y) const {
+        const auto a = detail::evalIf<detail::divReadsA<Sa, Sb>>(this->m_a, x, y);
+        const auto as = detail::evalIf<detail::divReadsAs<Sa, Sb>>(this->m_a, y, x);
+        const auto b = detail::evalIf<detail::divReadsB<Sa, Sb>>(this->m_b, x, y);
+        const auto bs = detail::evalIf<detail::divReadsBs<Sa, Sb>>(this->m_b, y, x);
+        std::array<double, size> r;
+        for (size_t i = 0; i < size; ++i) {
+            r[i] = detail::div<Sa, Sb>(detail::at(a, i), detail::at(as, i), detail::at(b, i), detail::at(bs, i));
+        }
+        return r;
+    };
+};
+
+template <typename A, typename B>
+class Dot : public Binary<A, B>
+{
+    static_assert(A::size == B::size, "et::dot: lengths do not match");
+    static constexpr sign Sa = A::sgn, Sb = B::sgn;
+
+  public:
+    static constexpr size_t size = 1;
+    static constexpr sign sgn = detail::multSign(Sa, Sb);
+
+    Dot(const A& a, const B& b) : Binary<A, B>(a, b) {};
+
+    template <typename V>
+    std::array<double, size> eval(const V& x, const V& y) const {
+        const auto a = detail::evalIf<detail::multReadsA<Sa, Sb>>(this->m_a, x, y);
+        const auto as = detail::evalIf<detail::multReadsAs<Sa, Sb>>(this->m_a, y, x);
+        const auto b = detail::evalIf<detail::multReadsB<Sa, Sb>>(this->m_b, x, y);
+        const auto bs = detail::evalIf<detail::multReadsBs<Sa, Sb>>(this->m_b, y, x);
+        double r = 0;
+        for (size_t i = 0; i < A::size; ++i) {r += detail::mult<Sa, Sb>(a[i], as[i], b[i], bs[i]);}
+        return {r};
+    };
+};
+
+// constant matrix times a vector, each element of the matrix selects the orientation of its product
+template <size_t R, size_t C, sign Sm, typename B>
+class MatVec : public Node
+{
+    static_assert(B::size == C, "et::mult: the length of the vector does not match the matrix");
+    static constexpr sign Sb = B::sgn;
+
+  public:
+    static constexpr size_t size = R, dim = B::dim;
+    static constexpr sign sgn = detail::multSign(Sm, Sb);
+
+    MatVec(const Matrix<R, C, Sm>& m, const B& b) : m_m(m), m_b(b) {};
+
+    template <typename V>
+    std::array<double, size> eval(const V& x, const V& y) const {
+        const auto b = detail::evalIf<detail::multReadsB<Sm, Sb>>(m_b, x, y);
+        const auto bs = detail::evalIf<detail::multReadsBs<Sm, Sb>>(m_b, y, x);
+        std::array<double, size> r;
+        for (size_t i = 0; i < R; ++i) {
+            const auto& row = m_m.rows()[i];
+            double acc = 0;
+            for (size_t j = 0; j < C; ++j) {acc += detail::mult<Sm, Sb>(row[j], row[j], b[j], bs[j]);}
+            r[i] = acc;
+        }
+        return r;
+    };
+
+  private:
+    Matrix<R, C, Sm> m_m;
+    B m_b;
+};
+
+// base of the nodes with one operand
+template <typename A>
+class Unary : public Node
+{
+  public:
+    static constexpr size_t dim = A::dim;
+
+  protected:
+    explicit Unary(const A& a) : m_a(a) {};
+    A m_a;
+};
+
+template <typename A>
+class Neg : public Unary<A>
+{
+  public:
+    static constexpr size_t size = A::size;
+    static constexpr sign sgn = detail::flip(A::sgn);
+
+    explicit Neg(const A& a) : Unary<A>(a) {};
+
+    template <typename V>
+    std::array<double, size> eval(const V& x, const V& y) const {
+        auto r = this->m_a.eval(y, x);
+        for (size_t i = 0; i < size; ++i) {r[i] = -r[i];}
+        return r;
+    };
+};
+
+template <typename A>
+class Inv : public Unary<A>
+{
+    static_assert(A::sgn != unknown, "et::inv: the sign of the argument must be known");
+
+  public:
+    static constexpr size_t size = A::size;
+    static constexpr sign sgn = A::sgn;
+
+    explicit Inv(const A& a) : Unary<A>(a) {};
+
+    template <typename V>
+    std::array<double, size> eval(const V& x, const V& y) const {
+        auto r = this->m_a.eval(y, x);
+        for (size_t i = 0; i < size; ++i) {r[i] = 1 / r[i];}
+        return r;
+    };
+};
+
+template <typename A, bool Base2>
+class Log : public Unary<A>
+{
+  public:
+    static constexpr size_t size = A::size;
+    static constexpr sign sgn = unknown;
+
+    explicit Log(const A& a) : Unary<A>(a) {};
+
+    template <typename V>
+    std::array<double, size> eval(const V& x, const V& y) const {
+        auto r = this->m_a.eval(x, y);
+        if constexpr (Base2) {
+            vecmath::log2(size, r.data(), r.data());
+        } else {
+            vecmath::ln(size, r.data(), r.data());
+        }
+        return r;
+    };
+};
+
+template <typename A>
+class Sum : public Unary<A>
+{
+  public:
+    static constexpr size_t size = 1;
+    static constexpr sign sgn = A::sgn;
+
+    explicit Sum(const A& a) : Unary<A>(a) {};
+
+    template <typename V>
+    std::array<double, size> eval(const V& x, const V& y) const {
+        const auto a = this->m_a.eval(x, y);
+        double r = 0;
+        for (size_t i = 0; i < A::size; ++i) {r += a[i];}
+        return {r};
+    };
+};
+
+template <typename A>
+class Prod : public Unary<A>
+{
+    static constexpr sign Sa = A::sgn;
+
+  public:
+    static constexpr size_t size = 1;
+    static constexpr sign sgn = Sa == NP ? (A::size % 2 == 0 ? NN : NP) : Sa;
+
+    explicit Prod(const A& a) : Unary<A>(a) {};
+
+    template <typename V>
+    std::array<double, size> eval(const V& x, const V& y) const {
+        const auto a = this->m_a.eval(x, y);
+        if constexpr (Sa == NN) {
+            double r = 1;
+            for (size_t i = 0; i < A::size; ++i) {r *= a[i];}
+            return {r};
+        } else {
+            // product of the partial products (of unknown sign) with the elements, in both orientations
+            const auto as = this->m_a.eval(y, x);
+            double r = 1, rs = 1;
+            for (size_t i = 0; i < A::size; ++i) {
+                const double next = detail::mult<unknown, Sa>(r, rs, a[i], as[i]);
+                rs = detail::mult<unknown, Sa>(rs, r, as[i], a[i]);
+                r = next;
+            }
+            return {r};
+        }
+    };
+};
+
+// variable of length Dim with sign S on the box
+template <size_t Dim, sign S>
+Variable<Dim, S> variable() {return {};}
+
+template <sign S = unknown, size_t N>
+Constant<N, S> constant(const std::array<double, N>& value) {return Constant<N, S>(value);}
+template <sign S = unknown>
+Constant<1, S> constant(double value) {return Constant<1, S>({value});}
+
+template <sign S = unknown, size_t R, size_t C>
+Matrix<R, C, S> matrix(const std::array<std::array<double, C>, R>& m) {return Matrix<R, C, S>(m);}
+
+namespace detail
+{
+// nodes stay, numbers become constants (no type for other operands, so the overloads for them drop out)
+template <typename T, typename = void>
+struct NodeType {};
+template <typename T>
+struct NodeType<T, std::enable_if_t<isNode<T>>> {using type = T;};
+template <typename T>
+struct NodeType<T, std::enable_if_t<std::is_arithmetic_v<T>>> {using type = Constant<1, unknown>;};
+template <typename T>
+using NodeOf = typename NodeType<T>::type;
+
+template <typename T>
+NodeOf<T> node(const T& t) {
+    if constexpr (isNode<T>) {
+        return t;
+    } else {
+        return constant(static_cast<double>(t));
+    }
+}
+} // namespace detail
+
+template <typename A, typename B>
+Add<detail::NodeOf<A>, detail::NodeOf<B>> add(const A& a, const B& b) {return {detail::node(a), detail::node(b)};}
+template <typename A, typename B>
+Mult<detail::NodeOf<A>, detail::NodeOf<B>> mult(const A& a, const B& b) {return {detail::node(a), detail::node(b)};}
+template <size_t R, size_t C, sign S, typename B>
+MatVec<R, C, S, B> mult(const Matrix<R, C, S>& m, const B& b) {return {m, b};}
+template <typename A, typename B>
+Div<detail::NodeOf<A>, detail::NodeOf<B>> div(const A& a, const B& b) {return {detail::node(a), detail::node(b)};}
+template <typename A, typename B>
+Dot<detail::NodeOf<A>, detail::NodeOf<B>> dot(const A& a, const B& b) {return {detail::node(a), detail::node(b)};}
+
+template <typename A>
+Neg<A> neg(const A& a) {return Neg<A>(a);}
+template <typename A>
+Inv<A> inv(const A& a) {return Inv<A>(a);}
+template <typename A>
+Log<A, true> log2(const A& a) {return Log<A, true>(a);}
+template <typename A>
+Log<A, false> ln(const A& a) {return Log<A, false>(a);}
+template <typename A>
+Sum<A> sum(const A& a) {return Sum<A>(a);}
+template <typename A>
+Prod<A> prod(const A& a) {return Prod<A>(a);}
+
+// operators for nodes and numbers
+template <typename A, typename B>
+using IfOperands = std::enable_if_t<isNode<A> || isNode<B>>;
+
+template <typename A, typename B, typename = IfOperands<A, B>>
+auto operator+(const A& a, const B& b) {return add(a, b);}
+template <typename A, typename B, typename = IfOperands<A, B>>
+auto operator-(const A& a, const B& b) {return add(a, neg(detail::node(b)));}
+template <typename A, typename B, typename = IfOperands<A, B>>
+auto operator*(const A& a, const B& b) {return mult(a, b);}
+template <typename A, typename B, typename = IfOperands<A, B>>
+auto operator/(const A& a, const B& b) {return div(a, b);}
+template <typename A, typename = std::enable_if_t<isNode<A>>>
+auto operator-(const A& a) {return neg(a);}
+
+} // namespace et
+
+#endif //EXPRTREE_STATICEXPRESSION_H
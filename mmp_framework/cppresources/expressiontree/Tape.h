@@ -0,0 +1,1386 @@
+#ifndef EXPRTREE_TAPE_H
+#define EXPRTREE_TAPE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+#include <stdexcept>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#include <iostream>
+#include <memory>
+#include "Expression.h"
+#include "Function.h"
+#include "util/Binary.h"
+#include "util/Split.h"
+#include "util/VecMath.h"
+
+/*
+ * Flat evaluation tape for an expression tree.
+ *
+ * The tree evaluates a node for the argument pair (x,y) by recursively
+ * evaluating its children either in the same orientation (x,y) or in the
+ * swapped orientation (y,x), depending on the sign variant of the node. The
+ * Tape compiles every (node, orientation) pair that is actually reached from
+ * the roots into one instruction, in topological order. Every instruction
+ * writes its result into a contiguous value buffer and reads its operands
+ * from there, so evaluation is a single loop over the instructions without
+ * recursion, virtual calls or allocations. Shared subexpressions are
+ * compiled (and evaluated) only once per orientation. Subtrees that do not
+ * depend on the Variable are evaluated once while compiling and stored as
+ * constants. Sliced nodes are no instructions, their value is the element of
+ * the argument's value, and neither are Lists of consecutive elements (e.g.,
+ * [v[0], v[1], ...]). A Rate node is one instruction reading its constants
+ * (alpha | sigma | diag(beta) | beta) and the power in both orientations, an
+ * Affine node reads its constants (scale | offset) and the argument in the
+ * orientation given by the sign of the scale.
+ *
+ * The kernels reproduce Function::evaluate() of the corresponding classes.
+ *
+ * Runtime sign specialization: the sign variants are fixed when the model is
+ * built, but an operand of unknown sign often has one sign on a small box.
+ * Where an instruction reads such an operand in both orientations, these
+ * values bound it on the box, and if they all are nonnegative (nonpositive)
+ * the kernel of the NN (NP) variant runs instead of the split one (see
+ * specialize()). Its bound is the one of the model built with that sign,
+ * valid on the box and mostly cheaper and tighter, so it can differ from the
+ * expression tree, which keeps the variants of the model.
+ *
+ * Outward rounding: the logs (util/VecMath.h) have an error of up to 1 ulp.
+ * A Tape compiled with outward = true widens the results of Log2 and LogN
+ * instructions and the logs of Rate instructions (see rate::evaluate()) by
+ * more than that, up in the orientation (x,y) and down in (y,x): the roots
+ * are nondecreasing in every value computed for (x,y) and nonincreasing in
+ * every value computed for (y,x), so the bounds stay upper bounds of the
+ * exact ones despite the errors of the logs. The direction is part of the
+ * instruction (aux), written and read with the Tape. Constant subtrees and
+ * the other kernels are not widened.
+ *
+ * Incremental evaluation: for every coordinate of x and y the Tape knows the
+ * instructions depending on it (element-wise, e.g., a List of elements of x
+ * only depends on these coordinates). With setCacheSize(n), n > 0, the
+ * values of up to n evaluations are kept; evaluate() starts from the kept
+ * state whose (x,y) differs in the fewest coordinates and reruns only the
+ * instructions depending on them. Branching changes a single coordinate of a
+ * box, so the bounds of the children are mostly computed incrementally. The
+ * results are identical to a full evaluation. If a branching (a change of x_i
+ * and y_i) would rerun more than half of the instructions on average, e.g.,
+ * if the variable enters through a dense matrix, only repeated evaluations
+ * (the same (x,y) as a kept state) are taken from the cache.
+ *
+ * Evaluation does not change the Tape: the values of x, y and the results
+ * (and the kept states) live in a Workspace, the constants are shared. Any
+ * number of threads can evaluate the same Tape concurrently, each into its own
+ * Workspace. The overloads without Workspace use one owned by the Tape.
+ *
+ * Layout of the value buffer: x | y | intermediate results | constants, the
+ * first three parts are the values of a Workspace
+ *
+ * write() stores a compiled Tape in a versioned binary format without
+ * pointers, read() restores it. The constants of a read Tape stay in the
+ * (memory mapped) file data, see ModelFile.h.
+ */
+class Tape
+{
+  public:
+    enum Op : uint8_t {
+        AddVecVec, AddVecScalar,
+        MultVecVec, MultVecScalar, MultMatVec, MultSpMatVec,
+        DivVecVec, DivVecScalar, DivScalarVec,
+        Dot,
+        Inv, Log2, LogN, Neg,
+        Prod, Sum,
+        List,
+        Rate, Affine
+    };
+
+    // operand orientations an instruction reads
+    enum Operand : uint8_t { A = 1, As = 2, B = 4, Bs = 8 };
+
+    static constexpr uint32_t none = UINT32_MAX;
+
+    struct Instruction {
+        Op op;
+        sign sa, sb;    // sign variant of the operands, as in the class name
+        uint32_t dim;   // length of the result
+        uint32_t n;     // length of the (first) operand, columns for MultMatVec/MultSpMatVec
+        uint32_t out;   // offset of the result
+        uint32_t a, as; // offsets of the first operand in same/swapped orientation
+        uint32_t b, bs; // offsets of the second operand in same/swapped orientation
+        uint32_t aux;   // offset into m_args for List, rateAux() for Rate, vecmath::Round for Log2 and LogN
+    };
+
+    // values of the evaluations of a Tape in one thread, see evaluate()
+    class Workspace
+    {
+      public:
+        // Keep the values of up to n evaluations for incremental evaluation (0: always evaluate all instructions)
+        void setCacheSize(size_t n) {
+            m_cacheSize = n;
+            m_valid = false;
+            m_states.clear();
+        };
+        size_t getCacheSize() const {return m_cacheSize;};
+
+      private:
+        friend class Tape;
+        std::vector<double> m_values;               // x | y | intermediate results
+        std::vector<std::vector<double>> m_states;  // older kept values, most recent first
+        std::vector<size_t> m_changed;
+        size_t m_cacheSize = 0;
+        bool m_valid = false;
+    };
+
+    Tape() = default;
+    // outward: widen the logs so that the bounds stay valid, see above
+    explicit Tape(Expression* root, bool outward = false) : Tape(std::vector<Expression*>{root}, outward) {};
+    explicit Tape(const std::vector<Expression*>& roots, bool outward = false) : m_outward(outward) {
+        for (auto root : roots) {
+            if (!root) {
+                throw std::invalid_argument("Tape: root is nullptr");
+            }
+        }
+
+        m_dimX = 0;
+        std::unordered_set<Expression*> seen;
+        for (auto root : roots) {
+            findVariable(root, seen);
+        }
+        m_buffer.resize(2 * m_dimX);
+
+        for (auto root : roots) {
+            m_roots.push_back(compile(root, false));
+            m_rootDims.push_back(root->getDim());
+        }
+
+        m_visited.clear();
+        m_constant.clear();
+        m_split.clear();
+
+        relocate();
+        analyzeDependencies();
+    };
+
+    // Keep the values of up to n evaluations for incremental evaluation (0: always evaluate all instructions)
+    void setCacheSize(size_t n) {m_workspace.setCacheSize(n);};
+    size_t getCacheSize() const {return m_workspace.getCacheSize();};
+
+    // Evaluate all roots for (x,y) into w. x and y have length getVariableDim().
+    // Only w is changed, so threads can evaluate the Tape concurrently into different Workspaces.
+    template <typename T>
+    void evaluate(const T* x, const T* y, Workspace& w) const {
+        if (w.m_values.size() != m_mutable) {
+            w.m_values.assign(m_mutable, 0);
+            w.m_states.clear();
+            w.m_valid = false;
+        }
+
+        if (w.m_cacheSize == 0 || !w.m_valid) {
+            double* v = w.m_values.data();
+            std::copy(x, x + m_dimX, v);
+            std::copy(y, y + m_dimX, v + m_dimX);
+
+            for (const auto& ins : m_code) {
+                run(ins, v);
+            }
+            w.m_valid = true;
+            return;
+        }
+
+        // the closest kept state, w.m_values is the most recent one, w.m_states the older ones (most recent first)
+        auto& states = w.m_states;
+        size_t best = changed(w.m_values, x, y, 2 * m_dimX + 1);
+        size_t bestState = states.size();
+        for (size_t k = 0; k < states.size() && best > 0; ++k) {
+            const size_t c = changed(states[k], x, y, best);
+            if (c < best) {
+                best = c;
+                bestState = k;
+            }
+        }
+        if (best == 0 && bestState == states.size()) {
+            return;
+        }
+
+        const bool full = best > m_dimX || !m_incremental;
+        if (states.size() + 1 < w.m_cacheSize) {
+            // keep the current state, continue with a copy
+            states.insert(states.begin(), w.m_values);
+            if (bestState + 1 < states.size()) {
+                w.m_values = states[bestState + 1];
+            }
+        } else if (full && !states.empty()) {
+            // far from all states: overwrite the least recently used one
+            std::swap(w.m_values, states.back());
+            std::rotate(states.begin(), states.end() - 1, states.end());
+        } else if (bestState < states.size()) {
+            std::swap(w.m_values, states[bestState]);
+            std::rotate(states.begin(), states.begin() + bestState, states.begin() + bestState + 1);
+        }
+
+        // coordinates that differ from the chosen state
+        double* v = w.m_values.data();
+        w.m_changed.clear();
+        for (size_t i = 0; i < 2 * m_dimX; ++i) {
+            const double value = i < m_dimX ? static_cast<double>(x[i]) : static_cast<double>(y[i - m_dimX]);
+            if (!same(v[i], value)) {
+                w.m_changed.push_back(i);
+                v[i] = value;
+            }
+        }
+
+        if (full) {
+            for (const auto& ins : m_code) {
+                run(ins, v);
+            }
+            return;
+        }
+
+        const uint64_t* bits = m_depBits.data();
+        for (size_t i = 0; i < m_code.size(); ++i, bits += m_depWords) {
+            for (auto c : w.m_changed) {
+                if (bits[c / 64] & (uint64_t(1) << (c % 64))) {
+                    run(m_code[i], v);
+                    break;
+                }
+            }
+        }
+    };
+
+    template <typename T>
+    void evaluate(const T* x, const T* y) {evaluate(x, y, m_workspace);};
+
+    // Evaluate and return the first element of the first root
+    template <typename T>
+    double evaluate_me(const T* x, const T* y, Workspace& w) const {
+        evaluate(x, y, w);
+        return *getValue(w);
+    };
+    template <typename T>
+    double evaluate_me(const T* x, const T* y) {return evaluate_me(x, y, m_workspace);};
+
+    // Result of root i after the last evaluation into w
+    const double* getValue(const Workspace& w, size_t i = 0) const {return value(w.m_values.data(), m_roots.at(i));};
+    const double* getValue(size_t i = 0) const {return getValue(m_workspace, i);};
+    int getDim(size_t i = 0) const {return m_rootDims.at(i);};
+    size_t getNumRoots() const {return m_roots.size();};
+    size_t getVariableDim() const {return m_dimX;};
+    const std::vector<Instruction>& getInstructions() const {return m_code;};
+    size_t size() const {return m_code.size();};
+
+    // raw layout for code generators: size of the value buffer, constants (the
+    // values of x, y and the results are in the Workspaces), offsets of the
+    // roots and operand offsets of List instructions
+    size_t getBufferSize() const {return m_mutable + m_numConstants;};
+    size_t getMutableSize() const {return m_mutable;};
+    double getConstant(uint32_t o) const {return *value(nullptr, o);};
+    uint32_t getOffset(size_t i = 0) const {return m_roots.at(i);};
+    const std::vector<uint32_t>& getListArgs() const {return m_args;};
+
+    static const char* opName(Op op) {
+        static const char* names[] = {"add_vec_vec", "add_vec_scalar", "mult_vec_vec", "mult_vec_scalar",
+                                      "mult_mat_vec", "mult_spmat_vec", "div_vec_vec", "div_vec_scalar", "div_scalar_vec",
+                                      "dot", "inverse", "log2", "ln", "negation", "product", "sum",
+                                      "list", "rate", "affine"};
+        return names[op];
+    };
+
+    void print() const {
+        std::cout << "Tape: " << m_code.size() << " instructions, " << getBufferSize() << " values\n";
+        for (size_t i = 0; i < m_code.size(); ++i) {
+            const auto& ins = m_code[i];
+            std::cout << "  " << i << ": [" << ins.out << "] = " << opName(ins.op) << "<" << ins.sa << "," << ins.sb << ">(";
+            for (auto o : {ins.a, ins.as, ins.b, ins.bs}) {
+                if (o == none) {
+                    std::cout << " -";
+                } else {
+                    std::cout << " " << o;
+                }
+            }
+            std::cout << " ) dim=" << ins.dim;
+            const uint32_t round = ins.op == Rate ? ins.aux >> 8 : ins.aux;
+            if ((ins.op == Log2 || ins.op == LogN || ins.op == Rate) && round != vecmath::Nearest) {
+                std::cout << (round == vecmath::Up ? " rounded up" : " rounded down");
+            }
+            std::cout << "\n";
+        }
+    };
+
+    // version of the format of write(), incremented on every incompatible change
+    static constexpr uint32_t formatVersion = 3;
+
+    void write(binary::Writer& out) const {
+        const uint64_t header[] = {m_dimX, m_mutable, m_numConstants, m_code.size(), m_args.size(), m_roots.size(),
+                                   m_depWords, m_incremental};
+        out.write(header, sizeof(header) / sizeof(header[0]));
+
+        // fixed size records, independent of the layout of Instruction
+        std::vector<uint32_t> code;
+        for (const auto& ins : m_code) {
+            code.insert(code.end(), {static_cast<uint32_t>(ins.op), static_cast<uint32_t>(ins.sa), static_cast<uint32_t>(ins.sb),
+                                     ins.dim, ins.n, ins.out, ins.a, ins.as, ins.b, ins.bs, ins.aux});
+        }
+        out.write(code.data(), code.size());
+        out.write(m_args.data(), m_args.size());
+        out.write(m_roots.data(), m_roots.size());
+        const std::vector<int32_t> rootDims(m_rootDims.begin(), m_rootDims.end());
+        out.write(rootDims.data(), rootDims.size());
+        out.write(m_depBits.data(), m_depBits.size());
+        out.write(m_constants.get(), m_numConstants);
+    };
+
+    // Tape written by write(), the constants are read in place and data keeps them alive. Every count is checked
+    // against the rest of the data before anything is allocated, and the whole Tape with check().
+    static Tape read(binary::Reader& in, const std::shared_ptr<const char>& data) {
+        auto inconsistent = [] {return std::runtime_error("Tape: inconsistent model file");};
+        // n elements of the given size, if the rest of the data can hold them
+        auto count = [&](uint64_t n, size_t bytes) {
+            if (n > in.remaining() / bytes) {
+                throw inconsistent();
+            }
+            return static_cast<size_t>(n);
+        };
+
+        Tape ret;
+        uint64_t header[8];
+        in.read(header, 8);
+        // offsets are 32 bit (none excluded)
+        if (header[1] > none || header[2] > none - header[1] || header[0] > header[1] / 2) {
+            throw inconsistent();
+        }
+        ret.m_dimX = header[0];
+        ret.m_mutable = header[1];
+        ret.m_numConstants = header[2];
+        ret.m_depWords = header[6];
+        ret.m_incremental = header[7] != 0;
+
+        const size_t numCode = count(header[3], 11 * sizeof(uint32_t));
+        const uint32_t* code = in.view<uint32_t>(numCode * 11);
+        ret.m_code.reserve(numCode);
+        for (size_t i = 0; i < numCode; ++i, code += 11) {
+            if (code[0] > Affine || code[1] > unknown || code[2] > unknown) {
+                throw std::runtime_error("Tape: invalid instruction in model file");
+            }
+            ret.m_code.push_back({static_cast<Op>(code[0]), static_cast<sign>(code[1]), static_cast<sign>(code[2]),
+                                  code[3], code[4], code[5], code[6], code[7], code[8], code[9], code[10]});
+        }
+        ret.m_args.resize(count(header[4], sizeof(uint32_t)));
+        in.read(ret.m_args.data(), ret.m_args.size());
+        const size_t numRoots = count(header[5], sizeof(uint32_t));
+        ret.m_roots.resize(numRoots);
+        in.read(ret.m_roots.data(), numRoots);
+        const int32_t* rootDims = in.view<int32_t>(numRoots);
+        ret.m_rootDims.assign(rootDims, rootDims + numRoots);
+        if (numCode > 0 && ret.m_depWords != (2 * ret.m_dimX + 63) / 64) {
+            throw inconsistent();
+        }
+        ret.m_depBits.resize(numCode == 0 ? 0 : count(numCode, ret.m_depWords * sizeof(uint64_t)) * ret.m_depWords);
+        in.read(ret.m_depBits.data(), ret.m_depBits.size());
+        ret.m_constants = std::shared_ptr<const double>(data, in.view<double>(ret.m_numConstants));
+
+        ret.check();
+        return ret;
+    };
+
+  private:
+    std::vector<Instruction> m_code;
+    // values during the compilation, afterwards in the Workspaces and m_constants
+    std::vector<double> m_buffer;
+    std::shared_ptr<const double> m_constants;
+    size_t m_numConstants = 0;
+    std::vector<uint32_t> m_args;       // operand offsets of List instructions
+    std::vector<uint32_t> m_roots;      // offsets of the root values
+    std::vector<int> m_rootDims;
+    size_t m_dimX = 0;
+    // length of x | y | intermediate results, the constants follow
+    size_t m_mutable = 0;
+    Workspace m_workspace;
+
+    // compile-time state: offset of every compiled (node, swapped) pair
+    struct NodeHash {
+        size_t operator()(const std::pair<Expression*, bool>& p) const {
+            return std::hash<Expression*>()(p.first) ^ p.second;
+        }
+    };
+    std::unordered_map<std::pair<Expression*, bool>, uint32_t, NodeHash> m_visited;
+    std::unordered_map<Expression*, bool> m_constant;
+    bool m_outward = false;
+    // constants of split matrices (by the MultiDimParameter) and of Rate and Affine nodes, shared by both orientations
+    std::unordered_map<Expression*, uint32_t> m_split;
+
+    // incremental evaluation: coordinates of (x,y) every instruction depends on, m_depWords words per instruction
+    std::vector<uint64_t> m_depBits;
+    size_t m_depWords = 0;
+    bool m_incremental = false;
+
+    // bitwise comparison, 0.0 and -0.0 are different inputs
+    static bool same(double a, double b) {
+        return std::memcmp(&a, &b, sizeof(double)) == 0;
+    };
+
+    // number of coordinates in which (x,y) differs from the inputs of state, counting stops at limit
+    template <typename T>
+    size_t changed(const std::vector<double>& state, const T* x, const T* y, size_t limit) const {
+        size_t ret = 0;
+        for (size_t i = 0; i < m_dimX && ret < limit; ++i) {
+            ret += !same(state[i], static_cast<double>(x[i]));
+            ret += !same(state[m_dimX + i], static_cast<double>(y[i]));
+        }
+        return ret;
+    };
+
+    // element o of the buffer, v are the values of a Workspace
+    const double* value(const double* v, uint32_t o) const {
+        return o < m_mutable ? v + o : m_constants.get() + (o - m_mutable);
+    };
+
+    // operands an instruction reads, as in lowerings() (invalid for combinations of op and signs that are never compiled)
+    static constexpr unsigned invalidOperands = 16;
+    static unsigned operandsRead(const Instruction& ins) {
+        switch (ins.op) {
+            case List: return 0;
+            case Rate: return A | B | Bs;
+            case Affine: return A | B;
+            default: break;
+        }
+        for (const auto& l : lowerings()) {
+            if (l.second.op == ins.op && l.second.sa == ins.sa && l.second.sb == ins.sb) {
+                // the split matrix of unknown sign is passed in a and as, see emit()
+                return l.second.operands | (ins.op == MultMatVec && ins.sa == unknown ? As : 0);
+            }
+        }
+        return invalidOperands;
+    };
+
+    // Everything the kernels access within the buffer (after read()): every operand an instruction reads lies
+    // within x | y | results or within the constants, for the length its kernel reads, the results within
+    // x | y | results, the CSR arrays of the sparse matrices are consistent, and so on.
+    void check() const {
+        const uint64_t size = getBufferSize();
+        // n values from offset o, within one part of the buffer (see value())
+        auto valid = [&](uint32_t o, uint64_t n) {
+            return o < m_mutable ? n <= m_mutable - o : (o <= size && n <= size - o);
+        };
+        // operand o if it is read (or present), n values
+        auto operand = [&](uint32_t o, bool read, uint64_t n) {
+            return o == none ? !read : valid(o, n);
+        };
+        auto integral = [](double v, double max) {return v >= 0 && v < max && std::floor(v) == v;};
+
+        bool ok = m_dimX <= m_mutable / 2 && m_rootDims.size() == m_roots.size();
+        uint64_t results = 0;
+        for (size_t i = 0; ok && i < m_code.size(); ++i) {
+            const Instruction& ins = m_code[i];
+            const unsigned read = operandsRead(ins);
+            ok = read != invalidOperands && ins.dim > 0 && ins.out >= 2 * m_dimX && ins.out <= m_mutable && ins.dim <= m_mutable - ins.out;
+            results += ins.dim;
+            if (!ok) {
+                break;
+            }
+
+            // lengths of the first and second operand
+            const uint64_t dim = ins.dim, n = ins.n;
+            uint64_t na = dim, nb = dim;
+            switch (ins.op) {
+                case AddVecScalar: case MultVecScalar: case DivVecScalar: nb = 1; break;
+                case MultMatVec: na = dim * n; nb = n; break;
+                case MultSpMatVec: na = dim + 1; nb = n; break;
+                case DivScalarVec: na = 1; break;
+                case Dot: case Prod: case Sum: na = nb = n; ok = ins.dim == 1; break;
+                case List: ok = ins.aux <= m_args.size() && ins.dim <= m_args.size() - ins.aux; na = nb = 0; break;
+                case Rate:
+                    // K^2 constants, the buffer has at most 2^32 values
+                    ok = (ins.aux & 0xff) <= rate::PropFair && (ins.aux >> 8) <= vecmath::Down
+                         && ins.dim == ((ins.aux & 0xff) == rate::PerUser ? ins.n : 1) && ins.n < (1u << 16);
+                    na = rate::constants(ins.n);
+                    nb = n;
+                    break;
+                case Log2: case LogN: ok = ins.aux <= vecmath::Down; break;
+                case Affine: ok = ins.n == 1 || ins.n == ins.dim; nb = n + 1; break;
+                default: break;
+            }
+            ok = ok && operand(ins.a, read & A, na) && operand(ins.as, read & As, na)
+                    && operand(ins.b, read & B, nb) && operand(ins.bs, read & Bs, nb);
+
+            if (ok && ins.op == MultSpMatVec) {
+                // CSR arrays (constants): row pointers | column indices | values
+                ok = ins.a >= m_mutable;
+                const double* ptr = ok ? value(nullptr, ins.a) : nullptr;
+                ok = ok && ptr[0] == 0;
+                for (uint32_t r = 0; ok && r < ins.dim; ++r) {
+                    ok = integral(ptr[r + 1], static_cast<double>(size)) && ptr[r] <= ptr[r + 1];
+                }
+                const uint64_t nnz = ok ? static_cast<uint64_t>(ptr[ins.dim]) : 0;
+                ok = ok && valid(ins.a, na + 2 * nnz);
+                for (uint64_t k = 0; ok && k < nnz; ++k) {
+                    ok = integral(ptr[na + k], static_cast<double>(ins.n));
+                }
+            }
+        }
+        // the results fit behind x | y, as laid out by relocate()
+        ok = ok && results <= m_mutable - 2 * m_dimX;
+        for (auto o : m_args) {ok = ok && valid(o, 1);}
+        for (size_t i = 0; i < m_roots.size(); ++i) {ok = ok && m_rootDims[i] > 0 && valid(m_roots[i], m_rootDims[i]);}
+        if (!ok) {
+            throw std::runtime_error("Tape: inconsistent model file");
+        }
+    };
+
+    // reorders the buffer from the order of compilation to x | y | intermediate results | constants
+    void relocate() {
+        std::vector<bool> isMutable(m_buffer.size(), false);
+        std::fill(isMutable.begin(), isMutable.begin() + 2 * m_dimX, true);
+        for (const auto& ins : m_code) {
+            std::fill(isMutable.begin() + ins.out, isMutable.begin() + ins.out + ins.dim, true);
+        }
+
+        // new offsets, keeping the order within both parts (every value stays contiguous)
+        std::vector<uint32_t> to(m_buffer.size() + 1);
+        uint32_t next = 0;
+        for (size_t o = 0; o < m_buffer.size(); ++o) {
+            if (isMutable[o]) {to[o] = next++;}
+        }
+        m_mutable = next;
+        for (size_t o = 0; o < m_buffer.size(); ++o) {
+            if (!isMutable[o]) {to[o] = next++;}
+        }
+        // offset of empty values
+        to[m_buffer.size()] = next;
+
+        auto constants = std::make_shared<std::vector<double>>(m_buffer.size() - m_mutable);
+        for (size_t o = 0; o < m_buffer.size(); ++o) {
+            if (!isMutable[o]) {(*constants)[to[o] - m_mutable] = m_buffer[o];}
+        }
+        m_numConstants = constants->size();
+        m_constants = std::shared_ptr<const double>(constants, constants->data());
+        m_buffer.clear();
+        m_buffer.shrink_to_fit();
+
+        auto move = [&](uint32_t& o) {
+            if (o != none) {o = to[o];}
+        };
+        for (auto& ins : m_code) {
+            for (uint32_t* o : {&ins.out, &ins.a, &ins.as, &ins.b, &ins.bs}) {move(*o);}
+        }
+        std::for_each(m_args.begin(), m_args.end(), move);
+        std::for_each(m_roots.begin(), m_roots.end(), move);
+    };
+
+    // element-wise propagation of the dependencies on the coordinates of (x,y) through the code
+    void analyzeDependencies() {
+        const size_t words = (2 * m_dimX + 63) / 64;
+        m_depWords = words;
+        m_depBits.assign(m_code.size() * words, 0);
+
+        // rows of the element bit sets: x|y and the results of the instructions, constants have none
+        std::vector<int64_t> row(getBufferSize(), -1);
+        size_t rows = 0;
+        for (size_t i = 0; i < 2 * m_dimX; ++i) {
+            row[i] = rows++;
+        }
+        for (const auto& ins : m_code) {
+            for (uint32_t i = 0; i < ins.dim; ++i) {
+                row[ins.out + i] = rows++;
+            }
+        }
+        std::vector<uint64_t> elem(rows * words, 0);
+        for (size_t i = 0; i < 2 * m_dimX; ++i) {
+            elem[i * words + i / 64] |= uint64_t(1) << (i % 64);
+        }
+
+        // dst |= dependencies of the buffer element o (if o is not unused)
+        auto depend = [&](uint64_t* dst, uint32_t o) {
+            if (o != none && row[o] >= 0) {
+                const uint64_t* src = elem.data() + row[o] * words;
+                for (size_t w = 0; w < words; ++w) {dst[w] |= src[w];}
+            }
+        };
+        auto shifted = [](uint32_t o, uint32_t i) {return o == none ? none : o + i;};
+
+        for (size_t k = 0; k < m_code.size(); ++k) {
+            const auto& ins = m_code[k];
+            for (uint32_t i = 0; i < ins.dim; ++i) {
+                uint64_t* out = elem.data() + row[ins.out + i] * words;
+
+                switch (ins.op) {
+                    case AddVecScalar: case MultVecScalar: case DivVecScalar:
+                        depend(out, shifted(ins.a, i));
+                        depend(out, shifted(ins.as, i));
+                        depend(out, ins.b);
+                        depend(out, ins.bs);
+                        break;
+
+                    case DivScalarVec:
+                        depend(out, ins.a);
+                        depend(out, ins.as);
+                        depend(out, shifted(ins.b, i));
+                        depend(out, shifted(ins.bs, i));
+                        break;
+
+                    case MultMatVec: {
+                        const uint32_t cols = ins.n;
+                        const double* m = value(nullptr, ins.a);
+                        const double* ms = ins.sa == unknown ? value(nullptr, ins.as) : m;
+                        for (uint32_t j = 0; j < cols; ++j) {
+                            if (m[j * ins.dim + i] != 0 || ms[j * ins.dim + i] != 0) {
+                                depend(out, shifted(ins.b, j));
+                                depend(out, shifted(ins.bs, j));
+                            }
+                        }
+                        break;
+                    }
+
+                    case MultSpMatVec: {
+                        const double* ptr = value(nullptr, ins.a);
+                        const double* idx = ptr + ins.dim + 1;
+                        for (size_t j = static_cast<size_t>(ptr[i]); j < static_cast<size_t>(ptr[i + 1]); ++j) {
+                            depend(out, shifted(ins.b, static_cast<uint32_t>(idx[j])));
+                            depend(out, shifted(ins.bs, static_cast<uint32_t>(idx[j])));
+                        }
+                        break;
+                    }
+
+                    case Dot: case Prod: case Sum:
+                        for (uint32_t j = 0; j < ins.n; ++j) {
+                            depend(out, shifted(ins.a, j));
+                            depend(out, shifted(ins.as, j));
+                            depend(out, shifted(ins.b, j));
+                            depend(out, shifted(ins.bs, j));
+                        }
+                        break;
+
+                    case List:
+                        depend(out, m_args[ins.aux + i]);
+                        break;
+
+                    case Affine:
+                        depend(out, shifted(ins.a, i));
+                        break;
+
+                    case Rate: {
+                        // a rate depends on the own power and the interfering ones, the sum and product on all
+                        const double* beta = value(nullptr, ins.a) + 3 * ins.n;
+                        for (uint32_t j = 0; j < ins.n; ++j) {
+                            if ((ins.aux & 0xff) != rate::PerUser || j == i || beta[j * ins.n + i] != 0) {
+                                depend(out, shifted(ins.b, j));
+                                depend(out, shifted(ins.bs, j));
+                            }
+                        }
+                        break;
+                    }
+
+                    default:
+                        // element-wise
+                        depend(out, shifted(ins.a, i));
+                        depend(out, shifted(ins.as, i));
+                        depend(out, shifted(ins.b, i));
+                        depend(out, shifted(ins.bs, i));
+                }
+
+                for (size_t w = 0; w < words; ++w) {m_depBits[k * words + w] |= out[w];}
+            }
+        }
+
+        // instructions rerun after a change of x_i and y_i, summed over i
+        auto has = [&](size_t k, size_t c) {return (m_depBits[k * words + c / 64] >> (c % 64)) & 1;};
+        size_t rerun = 0;
+        for (size_t k = 0; k < m_code.size(); ++k) {
+            for (size_t i = 0; i < m_dimX; ++i) {
+                rerun += has(k, i) || has(k, m_dimX + i);
+            }
+        }
+        m_incremental = 2 * rerun < m_code.size() * m_dimX;
+    };
+
+    // true if e does not depend on the Variable
+    bool isConstant(Expression* e) {
+        auto it = m_constant.find(e);
+        if (it != m_constant.end()) {
+            return it->second;
+        }
+
+        bool ret = !dynamic_cast<Variable*>(e);
+        if (auto f = dynamic_cast<Function*>(e)) {
+            for (auto arg : f->getArgs()) {
+                ret = isConstant(arg) && ret;
+            }
+        }
+        m_constant[e] = ret;
+        return ret;
+    };
+
+    static double pos(double v) {return v >= 0 ? v : 0;};
+    static double neg(double v) {return v >= 0 ? 0 : v;};
+
+    void findVariable(Expression* e, std::unordered_set<Expression*>& seen) {
+        if (!seen.insert(e).second) {
+            return;
+        }
+        if (dynamic_cast<Variable*>(e)) {
+            if (m_dimX != 0 && m_dimX != static_cast<size_t>(e->getDim())) {
+                throw std::invalid_argument("Tape: variables of different dimension");
+            }
+            m_dimX = e->getDim();
+        } else if (auto f = dynamic_cast<Function*>(e)) {
+            for (auto arg : f->getArgs()) {
+                findVariable(arg, seen);
+            }
+        }
+    };
+
+    // whether the n values at offset o are x|y or the result of a single instruction
+    bool isResult(uint32_t o, size_t n) const {
+        if (o + n <= 2 * m_dimX) {
+            return true;
+        }
+        return std::any_of(m_code.begin(), m_code.end(), [&](const Instruction& ins) {
+            return ins.out <= o && o + n <= ins.out + ins.dim;
+        });
+    };
+
+    uint32_t allocate(size_t n) {
+        const uint32_t ret = m_buffer.size();
+        m_buffer.resize(m_buffer.size() + n);
+        return ret;
+    };
+
+    // offset of the value of e evaluated for (x,y) (swapped == false) or (y,x)
+    uint32_t compile(Expression* e, bool swapped) {
+        // leaves and subtrees without Variable do not depend on the orientation
+        const bool constant = isConstant(e);
+        if (constant) {
+            swapped = false;
+        }
+
+        auto it = m_visited.find({e, swapped});
+        if (it != m_visited.end()) {
+            return it->second;
+        }
+
+        uint32_t ret;
+        if (dynamic_cast<Variable*>(e)) {
+            ret = swapped ? m_dimX : 0;
+        } else if (auto p = dynamic_cast<MultiDimParameter*>(e)) {
+            // column-major, see util/Gemv.h
+            Matrix* m = p->getValue();
+            const std::vector<double> mat = gemv::columnMajor(m->getRows(), m->getCols(), m->getData());
+            ret = allocate(mat.size());
+            std::copy(mat.begin(), mat.end(), m_buffer.begin() + ret);
+        } else if (auto p = dynamic_cast<SparseMultiDimParameter*>(e)) {
+            // CSR arrays as doubles: row pointers | column indices | values
+            SparseMatrix* m = p->getValue();
+            const size_t rows = m->getRows(), nnz = m->getNonZeros();
+            ret = allocate(rows + 1 + 2 * nnz);
+            std::copy(m->getRowPtr().begin(), m->getRowPtr().end(), m_buffer.begin() + ret);
+            std::copy(m->getColIdx().begin(), m->getColIdx().end(), m_buffer.begin() + ret + rows + 1);
+            std::copy(m->getValues().begin(), m->getValues().end(), m_buffer.begin() + ret + rows + 1 + nnz);
+        } else if (auto f = dynamic_cast<Function*>(e)) {
+            if (constant) {
+                // constant folding
+                const std::vector<double> none;
+                f->evaluate_root(none, none);
+                const std::vector<double>& value = *f->getValue();
+                ret = allocate(value.size());
+                std::copy(value.begin(), value.end(), m_buffer.begin() + ret);
+            } else {
+                ret = lower(f, swapped);
+            }
+        } else {
+            // Parameter (and any other leaf): constant
+            const std::vector<double>& value = *e->getValue();
+            ret = allocate(value.size());
+            std::copy(value.begin(), value.end(), m_buffer.begin() + ret);
+        }
+
+        m_visited[{e, swapped}] = ret;
+        return ret;
+    };
+
+    // aux of a Rate instruction: the rate::Kind in the low byte, the vecmath::Round of its logs above
+    uint32_t rateAux(rate::Kind kind, bool swapped) const {
+        const uint32_t round = m_outward ? (swapped ? vecmath::Down : vecmath::Up) : vecmath::Nearest;
+        return kind | round << 8;
+    }
+
+    uint32_t emit(Function* f, bool swapped, Op op, sign sa, sign sb, unsigned operands) {
+        const auto& args = f->getArgs();
+
+        Instruction ins;
+        ins.op = op;
+        ins.sa = sa;
+        ins.sb = sb;
+        ins.dim = f->getDim();
+        ins.aux = 0;
+        if (m_outward && (op == Log2 || op == LogN)) {
+            ins.aux = swapped ? vecmath::Down : vecmath::Up;
+        }
+
+        if (op == MultMatVec) {
+            ins.n = dynamic_cast<MultiDimParameter*>(args.at(0))->getValue()->getCols();
+        } else if (op == MultSpMatVec) {
+            ins.n = dynamic_cast<SparseMultiDimParameter*>(args.at(0))->getValue()->getCols();
+        } else if (op == DivScalarVec) {
+            ins.n = args.at(1)->getDim();
+        } else {
+            ins.n = args.at(0)->getDim();
+        }
+
+        if (op == MultMatVec && sa == unknown) {
+            // the parts >= 0 and < 0 of the matrix instead of the matrix
+            ins.a = splitMatrix(args.at(0));
+            ins.as = ins.a + ins.dim * ins.n;
+        } else {
+            ins.a = (operands & A) ? compile(args.at(0), swapped) : none;
+            ins.as = (operands & As) ? compile(args.at(0), !swapped) : none;
+        }
+        ins.b = (operands & B) ? compile(args.at(1), swapped) : none;
+        ins.bs = (operands & Bs) ? compile(args.at(1), !swapped) : none;
+
+        ins.out = allocate(ins.dim);
+        m_code.push_back(ins);
+        return ins.out;
+    };
+
+    // offset of the positive part of a MultiDimParameter, followed by the negative part (column-major)
+    uint32_t splitMatrix(Expression* e) {
+        auto it = m_split.find(e);
+        if (it != m_split.end()) {
+            return it->second;
+        }
+
+        Matrix* m = dynamic_cast<MultiDimParameter*>(e)->getValue();
+        std::vector<double> greaterequalthan0, lessthan0;
+        gemv::split(gemv::columnMajor(m->getRows(), m->getCols(), m->getData()), greaterequalthan0, lessthan0);
+
+        const uint32_t ret = allocate(2 * greaterequalthan0.size());
+        std::copy(greaterequalthan0.begin(), greaterequalthan0.end(), m_buffer.begin() + ret);
+        std::copy(lessthan0.begin(), lessthan0.end(), m_buffer.begin() + ret + greaterequalthan0.size());
+        m_split[e] = ret;
+        return ret;
+    };
+
+    // instruction of every Function class with a kernel (by the exact class, a
+    // chain of dynamic_casts would dominate the compilation of large trees)
+    struct Lowering {
+        Op op;
+        sign sa, sb;
+        unsigned operands;
+    };
+    static const std::unordered_map<std::type_index, Lowering>& lowerings() {
+        // sign variants, mirrors the order of variant_expression
+        static const std::unordered_map<std::type_index, Lowering> table = {
+            {typeid(Add_vec_scalar), {AddVecScalar, unknown, unknown, A | B}},
+            {typeid(Add_vec_vec), {AddVecVec, unknown, unknown, A | B}},
+
+            {typeid(Mult_vecNN_scalarNN), {MultVecScalar, NN, NN, A | B}},
+            {typeid(Mult_vecNP_scalarNP), {MultVecScalar, NP, NP, As | Bs}},
+            {typeid(Mult_vecNN_scalarNP), {MultVecScalar, NN, NP, As | B}},
+            {typeid(Mult_vecNP_scalarNN), {MultVecScalar, NP, NN, A | Bs}},
+            {typeid(Mult_vecU_scalarNN), {MultVecScalar, unknown, NN, A | B | Bs}},
+            {typeid(Mult_vecU_scalarNP), {MultVecScalar, unknown, NP, As | B | Bs}},
+            {typeid(Mult_vecNN_scalarU), {MultVecScalar, NN, unknown, A | As | B}},
+            {typeid(Mult_vecNP_scalarU), {MultVecScalar, NP, unknown, A | As | Bs}},
+            {typeid(Mult_vecU_scalarU), {MultVecScalar, unknown, unknown, A | As | B | Bs}},
+
+            {typeid(Mult_MatNN_VecNN), {MultMatVec, NN, NN, A | B}},
+            {typeid(Mult_MatNP_VecNP), {MultMatVec, NP, NP, A | Bs}},
+            {typeid(Mult_MatNN_VecNP), {MultMatVec, NN, NP, A | B}},
+            {typeid(Mult_MatNP_VecNN), {MultMatVec, NP, NN, A | Bs}},
+            {typeid(Mult_MatU_VecNN), {MultMatVec, unknown, NN, A | B | Bs}},
+            {typeid(Mult_MatU_VecNP), {MultMatVec, unknown, NP, A | B | Bs}},
+            {typeid(Mult_MatNN_VecU), {MultMatVec, NN, unknown, A | B}},
+            {typeid(Mult_MatNP_VecU), {MultMatVec, NP, unknown, A | Bs}},
+            {typeid(Mult_MatU_VecU), {MultMatVec, unknown, unknown, A | B | Bs}},
+
+            {typeid(Mult_SpMatNN_VecNN), {MultSpMatVec, NN, NN, A | B}},
+            {typeid(Mult_SpMatNP_VecNP), {MultSpMatVec, NP, NP, A | Bs}},
+            {typeid(Mult_SpMatNN_VecNP), {MultSpMatVec, NN, NP, A | B}},
+            {typeid(Mult_SpMatNP_VecNN), {MultSpMatVec, NP, NN, A | Bs}},
+            {typeid(Mult_SpMatU_VecNN), {MultSpMatVec, unknown, NN, A | B | Bs}},
+            {typeid(Mult_SpMatU_VecNP), {MultSpMatVec, unknown, NP, A | B | Bs}},
+            {typeid(Mult_SpMatNN_VecU), {MultSpMatVec, NN, unknown, A | B}},
+            {typeid(Mult_SpMatNP_VecU), {MultSpMatVec, NP, unknown, A | Bs}},
+            {typeid(Mult_SpMatU_VecU), {MultSpMatVec, unknown, unknown, A | B | Bs}},
+
+            {typeid(Mult_vecNN_vecNN), {MultVecVec, NN, NN, A | B}},
+            {typeid(Mult_vecNP_vecNP), {MultVecVec, NP, NP, As | Bs}},
+            {typeid(Mult_vecNN_vecNP), {MultVecVec, NN, NP, As | B}},
+            {typeid(Mult_vecU_vecNN), {MultVecVec, unknown, NN, A | B | Bs}},
+            {typeid(Mult_vecU_vecNP), {MultVecVec, unknown, NP, As | B | Bs}},
+            {typeid(Mult_vecU_vecU), {MultVecVec, unknown, unknown, A | As | B | Bs}},
+
+            {typeid(Dot_NN_NN), {Dot, NN, NN, A | B}},
+            {typeid(Dot_NP_NP), {Dot, NP, NP, As | Bs}},
+            {typeid(Dot_NN_NP), {Dot, NN, NP, As | B}},
+            {typeid(Dot_U_NN), {Dot, unknown, NN, A | B | Bs}},
+            {typeid(Dot_U_NP), {Dot, unknown, NP, As | B | Bs}},
+            {typeid(Dot_U_U), {Dot, unknown, unknown, A | As | B | Bs}},
+
+            {typeid(Div_VecNN_VecNN), {DivVecVec, NN, NN, A | Bs}},
+            {typeid(Div_VecNP_VecNP), {DivVecVec, NP, NP, As | B}},
+            {typeid(Div_VecNN_VecNP), {DivVecVec, NN, NP, As | Bs}},
+            {typeid(Div_VecNP_VecNN), {DivVecVec, NP, NN, A | B}},
+            {typeid(Div_VecU_VecNN), {DivVecVec, unknown, NN, A | B | Bs}},
+            {typeid(Div_VecU_VecNP), {DivVecVec, unknown, NP, As | B | Bs}},
+            {typeid(Div_VecNN_VecU), {DivVecVec, NN, unknown, A | As | B | Bs}},
+            {typeid(Div_VecNP_VecU), {DivVecVec, NP, unknown, A | As | B | Bs}},
+            {typeid(Div_VecU_VecU), {DivVecVec, unknown, unknown, A | As | B | Bs}},
+
+            {typeid(Div_VecNN_ScalarNN), {DivVecScalar, NN, NN, A | Bs}},
+            {typeid(Div_VecNP_ScalarNP), {DivVecScalar, NP, NP, As | B}},
+            {typeid(Div_VecNN_ScalarNP), {DivVecScalar, NN, NP, As | Bs}},
+            {typeid(Div_VecNP_ScalarNN), {DivVecScalar, NP, NN, A | B}},
+            {typeid(Div_VecU_ScalarNN), {DivVecScalar, unknown, NN, A | B | Bs}},
+            {typeid(Div_VecU_ScalarNP), {DivVecScalar, unknown, NP, As | B | Bs}},
+            {typeid(Div_VecNN_ScalarU), {DivVecScalar, NN, unknown, A | As | B | Bs}},
+            {typeid(Div_VecNP_ScalarU), {DivVecScalar, NP, unknown, A | As | B | Bs}},
+            {typeid(Div_VecU_ScalarU), {DivVecScalar, unknown, unknown, A | As | B | Bs}},
+
+            {typeid(Div_ScalarNN_VecNN), {DivScalarVec, NN, NN, A | Bs}},
+            {typeid(Div_ScalarNP_VecNP), {DivScalarVec, NP, NP, As | B}},
+            {typeid(Div_ScalarNN_VecNP), {DivScalarVec, NN, NP, As | Bs}},
+            {typeid(Div_ScalarNP_VecNN), {DivScalarVec, NP, NN, A | B}},
+            {typeid(Div_ScalarU_VecNN), {DivScalarVec, unknown, NN, A | As | B | Bs}},
+            {typeid(Div_ScalarU_VecNP), {DivScalarVec, unknown, NP, A | As | B | Bs}},
+            {typeid(Div_ScalarNN_VecU), {DivScalarVec, NN, unknown, A | As | B | Bs}},
+            {typeid(Div_ScalarNP_VecU), {DivScalarVec, NP, unknown, A | As | B | Bs}},
+            {typeid(Div_ScalarU_VecU), {DivScalarVec, unknown, unknown, A | As | B | Bs}},
+
+            {typeid(::Log2), {Log2, unknown, unknown, A}},
+            {typeid(::LogN), {LogN, unknown, unknown, A}},
+            {typeid(::Inv), {Inv, unknown, unknown, As}},
+            {typeid(::Neg), {Neg, unknown, unknown, As}},
+            {typeid(::Prod), {Prod, unknown, unknown, A}},
+            {typeid(::Sum), {Sum, unknown, unknown, A}}
+        };
+        return table;
+    };
+
+    uint32_t lower(Function* f, bool s) {
+        auto it = lowerings().find(typeid(*f));
+        if (it != lowerings().end()) {
+            const Lowering& l = it->second;
+            return emit(f, s, l.op, l.sa, l.sb, l.operands);
+        }
+
+        if (auto sl = dynamic_cast<Sliced*>(f)) {
+            // element of the argument, shared by all slices reading it
+            return compile(f->getArgs().at(0), s) + sl->getIndex();
+        }
+        if (dynamic_cast<::List*>(f)) {
+            const auto& args = f->getArgs();
+            std::vector<uint32_t> operands;
+            bool consecutive = true;
+            for (auto arg : args) {
+                operands.push_back(compile(arg, s));
+                consecutive = consecutive && operands.back() == operands.front() + operands.size() - 1;
+            }
+            if (consecutive && isResult(operands.front(), operands.size())) {
+                return operands.front();
+            }
+
+            Instruction ins {List, unknown, unknown, static_cast<uint32_t>(f->getDim()), static_cast<uint32_t>(args.size()),
+                             0, none, none, none, none, static_cast<uint32_t>(m_args.size())};
+            m_args.insert(m_args.end(), operands.begin(), operands.end());
+            ins.out = allocate(ins.dim);
+            m_code.push_back(ins);
+            return ins.out;
+        }
+        if (auto r = dynamic_cast<::Rate*>(f)) {
+            auto it = m_split.find(f);
+            if (it == m_split.end()) {
+                const std::vector<double>& c = r->getConstants();
+                it = m_split.emplace(f, allocate(c.size())).first;
+                std::copy(c.begin(), c.end(), m_buffer.begin() + it->second);
+            }
+            const uint32_t constants = it->second;
+            Expression* p = f->getArgs().at(1);
+            Instruction ins {Rate, NN, NN, static_cast<uint32_t>(f->getDim()), static_cast<uint32_t>(p->getDim()),
+                             0, constants, none, compile(p, s), compile(p, !s), rateAux(r->getKind(), s)};
+            ins.out = allocate(ins.dim);
+            m_code.push_back(ins);
+            return ins.out;
+        }
+        if (auto af = dynamic_cast<::Affine*>(f)) {
+            auto it = m_split.find(f);
+            if (it == m_split.end()) {
+                const std::vector<double>& offset = af->getOffset();
+                it = m_split.emplace(f, allocate(1 + offset.size())).first;
+                m_buffer[it->second] = af->getScale();
+                std::copy(offset.begin(), offset.end(), m_buffer.begin() + it->second + 1);
+            }
+            const uint32_t constants = it->second;
+            const bool swapped = af->getScale() < 0 ? !s : s;
+            Instruction ins {Affine, unknown, unknown, static_cast<uint32_t>(f->getDim()), static_cast<uint32_t>(af->getOffset().size()),
+                             0, compile(f->getArgs().at(0), swapped), none, constants, none, 0};
+            ins.out = allocate(ins.dim);
+            m_code.push_back(ins);
+            return ins.out;
+        }
+
+        throw std::invalid_argument("Tape: unsupported expression " + f->getName());
+    };
+
+    // v are the values of a Workspace, the results are always written there
+    void run(const Instruction& ins, double* v) const {
+        if (ins.op == List) {
+            for (uint32_t i = 0; i < ins.dim; ++i) {v[ins.out + i] = *value(v, m_args[ins.aux + i]);}
+            return;
+        }
+
+        apply(ins, v + ins.out, value(v, ins.a == none ? 0 : ins.a), value(v, ins.as == none ? 0 : ins.as),
+              value(v, ins.b == none ? 0 : ins.b), value(v, ins.bs == none ? 0 : ins.bs));
+    };
+
+  public:
+    // Kernel of a single instruction (except List). Operands that are not
+    // read by the instruction may point anywhere.
+    static void apply(const Instruction& ins, double* out, const double* a, const double* as, const double* b, const double* bs) {
+        const uint32_t dim = ins.dim;
+
+        switch (ins.op) {
+            case AddVecVec:
+                for (uint32_t i = 0; i < dim; ++i) {out[i] = a[i] + b[i];}
+                break;
+
+            case AddVecScalar:
+                for (uint32_t i = 0; i < dim; ++i) {out[i] = a[i] + b[0];}
+                break;
+
+            case MultVecVec: {
+                const Instruction k = specialize(ins, a, as, b, bs);
+                multVecVec(k, out, a, as, b, bs);
+                break;
+            }
+
+            case MultVecScalar: {
+                const Instruction k = specialize(ins, a, as, b, bs);
+                multVecScalar(k, out, a, as, b[0], bs[0]);
+                break;
+            }
+
+            case MultMatVec:
+                multMatVec(ins, out, a, as, b, bs);
+                break;
+
+            case MultSpMatVec:
+                multSpMatVec(ins, out, a, b, bs);
+                break;
+
+            case DivVecVec: {
+                const Instruction k = specialize(ins, a, as, b, bs);
+                divVecVec(k, out, a, as, b, bs);
+                break;
+            }
+
+            case DivVecScalar: {
+                const Instruction k = specialize(ins, a, as, b, bs);
+                divVecScalar(k, out, a, as, b[0], bs[0]);
+                break;
+            }
+
+            case DivScalarVec: {
+                const Instruction k = specialize(ins, a, as, b, bs);
+                divScalarVec(k, out, a[0], as[0], b, bs);
+                break;
+            }
+
+            case Dot: {
+                const Instruction k = specialize(ins, a, as, b, bs);
+                out[0] = dot(k, a, as, b, bs);
+                break;
+            }
+
+            case Inv:
+                for (uint32_t i = 0; i < dim; ++i) {out[i] = 1 / as[i];}
+                break;
+
+            case Log2:
+                vecmath::log2(dim, a, out);
+                vecmath::widen(dim, out, static_cast<vecmath::Round>(ins.aux));
+                break;
+
+            case LogN:
+                vecmath::ln(dim, a, out);
+                vecmath::widen(dim, out, static_cast<vecmath::Round>(ins.aux));
+                break;
+
+            case Neg:
+                for (uint32_t i = 0; i < dim; ++i) {out[i] = -as[i];}
+                break;
+
+            case Prod: {
+                double r = 1;
+                for (uint32_t i = 0; i < ins.n; ++i) {r *= a[i];}
+                out[0] = r;
+                break;
+            }
+
+            case Sum: {
+                double r = 0;
+                for (uint32_t i = 0; i < ins.n; ++i) {r += a[i];}
+                out[0] = r;
+                break;
+            }
+
+            case Rate:
+                rate::evaluate(static_cast<rate::Kind>(ins.aux & 0xff), ins.n, a, b, bs, out, static_cast<vecmath::Round>(ins.aux >> 8));
+                break;
+
+            case Affine: {
+                // b = scale | offset
+                const uint32_t step = ins.n == 1 ? 0 : 1;
+                for (uint32_t i = 0; i < dim; ++i) {out[i] = b[0] * a[i] + b[1 + i * step];}
+                break;
+            }
+
+            case List:
+                throw std::logic_error("Tape: List is not a kernel");
+        }
+    };
+
+  private:
+
+    // Sign of an operand of unknown sign on the current box: its values in
+    // both orientations bound it there, so it is NN (NP) if none (all) of them
+    // have the sign bit set, and with strict (for denominators) none is zero.
+    // The scan only uses bit operations on four accumulators, so that it is
+    // vectorized and cheaper than the kernels it replaces.
+    static sign boxSign(uint32_t n, const double* v, const double* vs, bool strict) {
+        constexpr uint64_t signBit = UINT64_C(1) << 63;
+        uint64_t any[4] = {0, 0, 0, 0}, all[4] = {signBit, signBit, signBit, signBit}, zero[4] = {0, 0, 0, 0};
+        auto scan = [&](uint32_t j, const double* p) {
+            uint64_t bits;
+            std::memcpy(&bits, p, sizeof(bits));
+            const uint64_t mag = bits & ~signBit;
+            any[j] |= bits;
+            all[j] &= bits;
+            zero[j] |= (mag - 1) & ~mag;    // sign bit set iff mag == 0
+        };
+        uint32_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            for (uint32_t j = 0; j < 4; ++j) {scan(j, v + i + j); scan(j, vs + i + j);}
+        }
+        for (; i < n; ++i) {scan(0, v + i); scan(0, vs + i);}
+
+        if (strict && ((zero[0] | zero[1] | zero[2] | zero[3]) & signBit)) {
+            return unknown;
+        }
+        if (!((any[0] | any[1] | any[2] | any[3]) & signBit)) {
+            return NN;
+        }
+        return (all[0] & all[1] & all[2] & all[3]) ? NP : unknown;
+    };
+
+    // Runtime sign specialization: the instruction with the operands of
+    // unknown sign that it reads in both orientations (see lowerings())
+    // replaced by their sign on the current box, so that the kernel of that
+    // sign variant runs instead of the split one. The operands of the
+    // products are swapped for the variants that only exist the other way
+    // round. A division is only specialized if no sign stays unknown, a
+    // denominator of unknown sign is bounded per element (see split::div()).
+    static Instruction specialize(const Instruction& ins, const double*& a, const double*& as, const double*& b, const double*& bs) {
+        const bool both = ins.sa == unknown && ins.sb == unknown;
+        const bool div = ins.op == DivVecVec || ins.op == DivVecScalar || ins.op == DivScalarVec;
+        const bool refineA = both || (ins.op == DivScalarVec && ins.sa == unknown);
+        const bool refineB = both || ((ins.op == MultVecScalar || ins.op == DivVecScalar || ins.op == DivScalarVec) && ins.sb == unknown);
+        if (!refineA && !refineB) {
+            return ins;
+        }
+
+        const uint32_t na = ins.op == DivScalarVec ? 1 : ins.op == Dot ? ins.n : ins.dim;
+        const uint32_t nb = ins.op == MultVecScalar || ins.op == DivVecScalar ? 1 : ins.op == Dot ? ins.n : ins.dim;
+        Instruction ret = ins;
+        if (refineA) {
+            ret.sa = boxSign(na, a, as, false);
+            if (div && ret.sa == unknown) {
+                return ins;
+            }
+        }
+        if (refineB) {
+            ret.sb = boxSign(nb, b, bs, div);
+            if (div && ret.sb == unknown) {
+                return ins;
+            }
+        }
+        if ((ins.op == MultVecVec || ins.op == Dot)
+            && ((ret.sa != unknown && ret.sb == unknown) || (ret.sa == NP && ret.sb == NN))) {
+            std::swap(ret.sa, ret.sb);
+            std::swap(a, b);
+            std::swap(as, bs);
+        }
+        return ret;
+    };
+
+    static void multVecVec(const Instruction& ins, double* out, const double* a, const double* as, const double* b, const double* bs) {
+        const uint32_t dim = ins.dim;
+
+        if (ins.sa == NN && ins.sb == NN) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = a[i] * b[i];}
+        } else if (ins.sa == NP && ins.sb == NP) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = as[i] * bs[i];}
+        } else if (ins.sa == NN && ins.sb == NP) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = as[i] * b[i];}
+        } else if (ins.sa == unknown && ins.sb == NN) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = pos(a[i]) * b[i] + neg(a[i]) * bs[i];}
+        } else if (ins.sa == unknown && ins.sb == NP) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = pos(as[i]) * b[i] + neg(as[i]) * bs[i];}
+        } else {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = split::mult(a[i], as[i], b[i], bs[i]);}
+        }
+    };
+
+    static void multVecScalar(const Instruction& ins, double* out, const double* a, const double* as, const double b, const double bs) {
+        const uint32_t dim = ins.dim;
+
+        if (ins.sa == NN && ins.sb == NN) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = a[i] * b;}
+        } else if (ins.sa == NP && ins.sb == NP) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = as[i] * bs;}
+        } else if (ins.sa == NN && ins.sb == NP) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = as[i] * b;}
+        } else if (ins.sa == NP && ins.sb == NN) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = a[i] * bs;}
+        } else if (ins.sa == unknown && ins.sb == NN) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = pos(a[i]) * b + neg(a[i]) * bs;}
+        } else if (ins.sa == unknown && ins.sb == NP) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = pos(as[i]) * b + neg(as[i]) * bs;}
+        } else if (ins.sa == NN && ins.sb == unknown) {
+            const double* x = b >= 0 ? a : as;
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = x[i] * b;}
+        } else if (ins.sa == NP && ins.sb == unknown) {
+            const double* x = bs >= 0 ? a : as;
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = x[i] * bs;}
+        } else {
+            const double* x = b >= 0 ? a : as;
+            const double* xs = bs >= 0 ? a : as;
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = pos(x[i]) * b + neg(xs[i]) * bs;}
+        }
+    };
+
+    // m is the matrix (column-major), or its positive part if the sign is unknown and ms the negative part
+    static void multMatVec(const Instruction& ins, double* out, const double* m, const double* ms, const double* b, const double* bs) {
+        if (ins.sa == unknown) {
+            gemv::multSplit(ins.dim, ins.n, m, ms, b, bs, out);
+        } else {
+            gemv::mult(ins.dim, ins.n, m, ins.sa == NN ? b : bs, out);
+        }
+    };
+
+    // same as multMatVec() for a matrix in the CSR layout of compile(), visits only the non-zeros
+    static void multSpMatVec(const Instruction& ins, double* out, const double* m, const double* b, const double* bs) {
+        const uint32_t rows = ins.dim;
+        const double* ptr = m;
+        const double* idx = m + rows + 1;
+        const double* val = idx + static_cast<size_t>(ptr[rows]);
+
+        for (uint32_t row = 0; row < rows; ++row) {
+            const size_t begin = static_cast<size_t>(ptr[row]), end = static_cast<size_t>(ptr[row + 1]);
+            double acc = 0;
+
+            if (ins.sa == unknown) {
+                for (size_t k = begin; k < end; ++k) {acc += val[k] * (val[k] >= 0 ? b : bs)[static_cast<size_t>(idx[k])];}
+            } else {
+                const double* x = ins.sa == NN ? b : bs;
+                for (size_t k = begin; k < end; ++k) {acc += val[k] * x[static_cast<size_t>(idx[k])];}
+            }
+
+            out[row] = acc;
+        }
+    };
+
+    static void divVecVec(const Instruction& ins, double* out, const double* a, const double* as, const double* b, const double* bs) {
+        const uint32_t dim = ins.dim;
+
+        if (ins.sa == NN && ins.sb == NN) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = a[i] / bs[i];}
+        } else if (ins.sa == NP && ins.sb == NP) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = as[i] / b[i];}
+        } else if (ins.sa == NN && ins.sb == NP) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = as[i] / bs[i];}
+        } else if (ins.sa == NP && ins.sb == NN) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = a[i] / b[i];}
+        } else if (ins.sa == unknown && ins.sb == NN) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = pos(a[i]) / bs[i] + neg(a[i]) / b[i];}
+        } else if (ins.sa == unknown && ins.sb == NP) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = pos(as[i]) / bs[i] + neg(as[i]) / b[i];}
+        } else {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = split::div(a[i], as[i], b[i], bs[i]);}
+        }
+    };
+
+    static void divVecScalar(const Instruction& ins, double* out, const double* a, const double* as, const double b, const double bs) {
+        const uint32_t dim = ins.dim;
+
+        if (ins.sa == NN && ins.sb == NN) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = a[i] / bs;}
+        } else if (ins.sa == NP && ins.sb == NP) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = as[i] / b;}
+        } else if (ins.sa == NN && ins.sb == NP) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = as[i] / bs;}
+        } else if (ins.sa == NP && ins.sb == NN) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = a[i] / b;}
+        } else if (ins.sa == unknown && ins.sb == NN) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = pos(a[i]) / bs + neg(a[i]) / b;}
+        } else if (ins.sa == unknown && ins.sb == NP) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = pos(as[i]) / bs + neg(as[i]) / b;}
+        } else {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = split::div(a[i], as[i], b, bs);}
+        }
+    };
+
+    static void divScalarVec(const Instruction& ins, double* out, const double a, const double as, const double* b, const double* bs) {
+        const uint32_t dim = ins.dim;
+
+        if (ins.sa == NN && ins.sb == NN) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = a / bs[i];}
+        } else if (ins.sa == NP && ins.sb == NP) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = as / b[i];}
+        } else if (ins.sa == NN && ins.sb == NP) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = as / bs[i];}
+        } else if (ins.sa == NP && ins.sb == NN) {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = a / b[i];}
+        } else if (ins.sa == unknown && ins.sb != unknown) {
+            // a/b is nondecreasing (nonincreasing) in a for b >= 0 (b <= 0), and in b
+            // nonincreasing for a >= 0 and nondecreasing otherwise
+            const double num = ins.sb == NN ? a : as;
+            const double* x = num >= 0 ? bs : b;
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = num / x[i];}
+        } else {
+            for (uint32_t i = 0; i < dim; ++i) {out[i] = split::div(a, as, b[i], bs[i]);}
+        }
+    };
+
+    static double dot(const Instruction& ins, const double* a, const double* as, const double* b, const double* bs) {
+        const uint32_t n = ins.n;
+        double r = 0;
+
+        if (ins.sa == NN && ins.sb == NN) {
+            for (uint32_t i = 0; i < n; ++i) {r += a[i] * b[i];}
+        } else if (ins.sa == NP && ins.sb == NP) {
+            for (uint32_t i = 0; i < n; ++i) {r += as[i] * bs[i];}
+        } else if (ins.sa == NN && ins.sb == NP) {
+            for (uint32_t i = 0; i < n; ++i) {r += as[i] * b[i];}
+        } else if (ins.sa == unknown && ins.sb == NN) {
+            double r2 = 0;
+            for (uint32_t i = 0; i < n; ++i) {r += pos(a[i]) * b[i];}
+            for (uint32_t i = 0; i < n; ++i) {r2 += neg(a[i]) * bs[i];}
+            r += r2;
+        } else if (ins.sa == unknown && ins.sb == NP) {
+            for (uint32_t i = 0; i < n; ++i) {r += pos(as[i]) * b[i];}
+            for (uint32_t i = 0; i < n; ++i) {r += neg(as[i]) * bs[i];}
+        } else {
+            for (uint32_t i = 0; i < n; ++i) {r += split::mult(a[i], as[i], b[i], bs[i]);}
+        }
+
+        return r;
+    };
+};
+
+#endif //EXPRTREE_TAPE_H
@@ -13,7 +13,14 @@ class Variable: public Leaf
     };
     Variable(const Variable & old) = default;
     void evaluate(const std::vector<double>& x_in, const std::vector<double>& y_in) override {
-        m_value = x_in;
+        std::copy(x_in.begin(), x_in.end(), m_value.begin());
+    };
+    void evaluate_interval(const std::vector<double>& lb, const std::vector<double>& ub) override {
+        m_lower = lb;
+        m_upper = ub;
+    };
+    const std::vector<double>& evaluate_ref(const std::vector<double>& x_in, const std::vector<double>&) override {
+        return x_in;
     };
 };
 
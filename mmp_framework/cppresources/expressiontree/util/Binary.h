@@ -0,0 +1,87 @@
+#ifndef EXPRTREE_BINARY_H
+#define EXPRTREE_BINARY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+
+/*
+ * Helpers for the binary model files (see Tape::write() and ModelFile.h).
+ *
+ * Arrays are stored in the byte order of the host and every array starts at
+ * an offset that is a multiple of 8 bytes, so a file mapped into memory (at a
+ * page boundary) can be read in place, e.g., the constants of a Tape.
+ */
+namespace binary
+{
+
+constexpr size_t alignment = 8;
+
+class Writer {
+public:
+    explicit Writer(std::ostream& os) : mOs(os) {}
+
+    template <typename T>
+    void write(const T* data, size_t n) {
+        mOs.write(reinterpret_cast<const char*>(data), n * sizeof(T));
+        mPos += n * sizeof(T);
+        const char zeros[alignment] = {};
+        const size_t pad = (alignment - mPos % alignment) % alignment;
+        mOs.write(zeros, pad);
+        mPos += pad;
+        if (!mOs) {
+            throw std::runtime_error("binary::Writer: write failed");
+        }
+    }
+    template <typename T>
+    void write(const T& value) {write(&value, 1);}
+
+private:
+    std::ostream& mOs;
+    size_t mPos = 0;
+};
+
+// bounds checked reading of data in memory
+class Reader {
+public:
+    Reader(const char* data, size_t size) : mData(data), mSize(size) {}
+
+    // n elements at the current position, in place
+    template <typename T>
+    const T* view(size_t n) {
+        if (n > (mSize - mPos) / sizeof(T)) {
+            throw std::runtime_error("binary::Reader: unexpected end of data");
+        }
+        const T* ret = reinterpret_cast<const T*>(mData + mPos);
+        mPos += n * sizeof(T);
+        mPos = std::min(mSize, mPos + (alignment - mPos % alignment) % alignment);
+        return ret;
+    }
+    template <typename T>
+    void read(T* out, size_t n) {
+        const T* src = view<T>(n);
+        if (n > 0) {
+            std::memcpy(out, src, n * sizeof(T));
+        }
+    }
+    // bytes after the current position
+    size_t remaining() const {return mSize - mPos;}
+    template <typename T>
+    T read() {
+        T ret;
+        read(&ret, 1);
+        return ret;
+    }
+
+private:
+    const char* mData;
+    size_t mSize;
+    size_t mPos = 0;
+};
+
+} // namespace binary
+
+#endif //EXPRTREE_BINARY_H
@@ -0,0 +1,97 @@
+#ifndef EXPRTREE_GEMV_H
+#define EXPRTREE_GEMV_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+/*
+ * Matrix-vector kernels of the Mult_Mat_Vec family, shared by the expression
+ * tree and the Tape (so both give bit-identical results).
+ *
+ * The matrix is stored column-major and the product is computed for blocks of
+ * rows: the partial sums of a block stay in registers and every column updates
+ * them with a short, branch-free, contiguous loop that the compiler vectorizes
+ * without reassociating the sums. So each row is still summed in column order,
+ * i.e., the same order as a row-wise inner product.
+ *
+ * For a matrix of unknown sign the positive and negative parts P and N are
+ * passed separately (materialized once by the caller) and multiplied with the
+ * vector in the two orientations in one fused sweep. A vector of unknown sign
+ * needs no split, M*pos(v) + M*neg(v) == M*v.
+ */
+namespace gemv
+{
+
+// rows per block, their partial sums stay in registers while x is streamed
+constexpr size_t block = 8;
+
+// column-major copy of a row-major rows x cols matrix
+inline std::vector<double> columnMajor(size_t rows, size_t cols, const double* m) {
+    std::vector<double> ret(rows * cols);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            ret[j * rows + i] = m[i * cols + j];
+        }
+    }
+    return ret;
+}
+
+// parts >= 0 resp. < 0 of m
+inline void split(const std::vector<double>& m, std::vector<double>& greaterequalthan0, std::vector<double>& lessthan0) {
+    greaterequalthan0.resize(m.size());
+    lessthan0.resize(m.size());
+    for (size_t i = 0; i < m.size(); ++i) {
+        greaterequalthan0[i] = m[i] >= 0 ? m[i] : 0;
+        lessthan0[i] = m[i] >= 0 ? 0 : m[i];
+    }
+}
+
+// out = M * x, M column-major
+inline void mult(size_t rows, size_t cols, const double* m, const double* x, double* out) {
+    size_t r0 = 0;
+    for (; r0 + block <= rows; r0 += block) {
+        double acc[block] = {};
+        for (size_t j = 0; j < cols; ++j) {
+            const double* c = m + j * rows + r0;
+            const double xj = x[j];
+            for (size_t r = 0; r < block; ++r) {acc[r] += c[r] * xj;}
+        }
+        std::copy(acc, acc + block, out + r0);
+    }
+    for (; r0 < rows; ++r0) {
+        double acc = 0;
+        for (size_t j = 0; j < cols; ++j) {acc += m[j * rows + r0] * x[j];}
+        out[r0] = acc;
+    }
+}
+
+// out = P * b + N * bs, P and N column-major, in one sweep
+inline void multSplit(size_t rows, size_t cols, const double* p, const double* n, const double* b, const double* bs, double* out) {
+    size_t r0 = 0;
+    for (; r0 + block <= rows; r0 += block) {
+        double acc[block] = {};
+        for (size_t j = 0; j < cols; ++j) {
+            const double* cp = p + j * rows + r0;
+            const double* cn = n + j * rows + r0;
+            const double bj = b[j], bsj = bs[j];
+            for (size_t r = 0; r < block; ++r) {
+                acc[r] += cp[r] * bj;
+                acc[r] += cn[r] * bsj;
+            }
+        }
+        std::copy(acc, acc + block, out + r0);
+    }
+    for (; r0 < rows; ++r0) {
+        double acc = 0;
+        for (size_t j = 0; j < cols; ++j) {
+            acc += p[j * rows + r0] * b[j];
+            acc += n[j * rows + r0] * bs[j];
+        }
+        out[r0] = acc;
+    }
+}
+
+} // namespace gemv
+
+#endif //EXPRTREE_GEMV_H
@@ -0,0 +1,47 @@
+#ifndef EXPRTREE_INTERVAL_H
+#define EXPRTREE_INTERVAL_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/*
+ * Operations of interval arithmetic for Expression::evaluate_interval(), the
+ * natural interval extension of the expression tree. Intervals are [lo, hi],
+ * rounded to nearest as the MMP evaluation. A nan bound stands for an unknown
+ * value and is propagated, so that a bound computed from it is never taken
+ * (see _MMPbase::bound()).
+ */
+namespace interval
+{
+
+// smallest and largest of the four results of the endpoints, nan if one is nan
+inline void hull(double p1, double p2, double p3, double p4, double& lo, double& hi) {
+    if (std::isnan(p1) || std::isnan(p2) || std::isnan(p3) || std::isnan(p4)) {
+        lo = hi = std::numeric_limits<double>::quiet_NaN();
+        return;
+    }
+    lo = std::min({p1, p2, p3, p4});
+    hi = std::max({p1, p2, p3, p4});
+}
+
+// [lo, hi] = [alo, ahi] * [blo, bhi]
+inline void mult(double alo, double ahi, double blo, double bhi, double& lo, double& hi) {
+    hull(alo * blo, alo * bhi, ahi * blo, ahi * bhi, lo, hi);
+}
+
+// [lo, hi] = [alo, ahi] / [blo, bhi], the whole real line if [blo, bhi] contains 0
+inline void div(double alo, double ahi, double blo, double bhi, double& lo, double& hi) {
+    if (blo > 0 || bhi < 0) {
+        hull(alo / blo, alo / bhi, ahi / blo, ahi / bhi, lo, hi);
+    } else if (std::isnan(alo) || std::isnan(ahi) || std::isnan(blo) || std::isnan(bhi)) {
+        lo = hi = std::numeric_limits<double>::quiet_NaN();
+    } else {
+        lo = -std::numeric_limits<double>::infinity();
+        hi = std::numeric_limits<double>::infinity();
+    }
+}
+
+} // namespace interval
+
+#endif //EXPRTREE_INTERVAL_H
@@ -1,6 +1,7 @@
 #ifndef EXPRTREE_MATRIX_H
 #define EXPRTREE_MATRIX_H
 
+#include <algorithm>
 #include <vector>
 
 class Matrix {
@@ -15,9 +16,15 @@ public:
 
     Matrix getGreaterEqualThan0();
     Matrix getLessThan0();
+    // same as above, writing into a matrix of the same size (no allocation)
+    void getGreaterEqualThan0(Matrix& ret) const;
+    void getLessThan0(Matrix& ret) const;
     std::vector<size_t> getDim() const;
+    size_t getRows() const {return mRows;};
+    size_t getCols() const {return mCols;};
     std::vector<double> getRow(size_t row);
     std::vector<double>::iterator getRowIt(size_t row);
+    const double* getData() const {return mData.data();};
     std::vector<double> getColumn(size_t col);
 
 private:
@@ -44,7 +51,7 @@ Matrix::Matrix(size_t rows, size_t cols, std::vector<double> mat)
 
 Matrix Matrix::getGreaterEqualThan0() {
     Matrix ret = Matrix(*this);
-    for (double value : ret.mData) {
+    for (double& value : ret.mData) {
         if (value < 0) {
             value = 0;
         }
@@ -54,7 +61,7 @@ Matrix Matrix::getGreaterEqualThan0() {
 
 Matrix Matrix::getLessThan0() {
     Matrix ret = Matrix(*this);
-    for (double value : ret.mData) {
+    for (double& value : ret.mData) {
         if (value > 0) {
             value = 0;
         }
@@ -62,6 +69,14 @@ Matrix Matrix::getLessThan0() {
     return ret;
 }
 
+void Matrix::getGreaterEqualThan0(Matrix& ret) const {
+    std::transform(mData.begin(), mData.end(), ret.mData.begin(), [](double value){return value < 0 ? 0 : value;});
+}
+
+void Matrix::getLessThan0(Matrix& ret) const {
+    std::transform(mData.begin(), mData.end(), ret.mData.begin(), [](double value){return value > 0 ? 0 : value;});
+}
+
 // Matrix element-access operators
 double& Matrix::operator()(size_t i, size_t j) {return mData[i * mCols + j];}
 double Matrix::operator()(size_t i, size_t j) const {return mData[i * mCols + j];}
@@ -0,0 +1,116 @@
+#ifndef EXPRTREE_RATE_H
+#define EXPRTREE_RATE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "Gemv.h"
+#include "VecMath.h"
+
+/*
+ * Kernel of the fused rate of a K-user interference channel with treating
+ * interference as noise (the objective of examples_c++/tin.h), shared by the
+ * expression tree (class Rate) and the Tape, so both give bit-identical
+ * results.
+ *
+ * For powers p (evaluated for (x,y)) and ps (evaluated for (y,x)) the rate of
+ * user i is
+ *   log2(1 + alpha_i p_i / (sigma_i + sum_j beta_ij ps_j + beta_ii (p_i - ps_i)))
+ * i.e., the power of the user itself is p_i, also in the denominator, and
+ * the interference is evaluated for ps. This is a valid MMP bound of the
+ * rate for alpha, beta, sigma, p >= 0 and the same as TIN::MMPobj().
+ *
+ * The interference sums are computed for blocks of users as in util/Gemv.h,
+ * starting from sigma_i and in column order, i.e., the same order as
+ * std::inner_product(y, beta_i, sigma_i) in TIN::MMPobj(). The logs of a
+ * block are computed at once with util/VecMath.h.
+ */
+namespace rate
+{
+
+enum Kind : uint8_t {
+    PerUser,    // the K rates
+    Sum,        // their sum, log2 of the product of the 1 + SINR (TIN<Dim, false>), see evaluate()
+    PropFair    // their product (TIN<Dim, true>)
+};
+
+// length of the constants: alpha | sigma | diag(beta) | beta column-major
+inline size_t constants(size_t k) {return 3 * k + k * k;}
+
+// c as constants(), out has length k for PerUser and 1 otherwise. For Sum, the
+// product of the 1 + SINR is kept as a mantissa and a binary exponent
+// (std::frexp), it overflows for many users with a high SINR, and the sum is
+// log2 of the mantissa plus the exponent. round widens the logs as
+// vecmath::widen() (see Tape, outward rounding); the sum rate is then the sum
+// of the widened rates, widened by the error of the sum, as the rounding
+// errors of the product would exceed the error of its log.
+inline void evaluate(Kind kind, size_t k, const double* c, const double* p, const double* ps, double* out,
+                     vecmath::Round round = vecmath::Nearest) {
+    const double* alpha = c;
+    const double* sigma = c + k;
+    const double* diag = c + 2 * k;
+    const double* beta = c + 3 * k;
+
+    double ret = 1;
+    long exponent = 0;
+    double sum = 0;
+    for (size_t r0 = 0; r0 < k; r0 += gemv::block) {
+        const size_t rows = std::min(gemv::block, k - r0);
+
+        double acc[gemv::block];
+        std::copy(sigma + r0, sigma + r0 + rows, acc);
+        for (size_t j = 0; j < k; ++j) {
+            const double* col = beta + j * k + r0;
+            const double psj = ps[j];
+            for (size_t r = 0; r < rows; ++r) {acc[r] += col[r] * psj;}
+        }
+
+        // 1 + SINR of the block
+        for (size_t r = 0; r < rows; ++r) {
+            const size_t i = r0 + r;
+            acc[r] = 1 + alpha[i] * p[i] / (acc[r] + diag[i] * (p[i] - ps[i]));
+        }
+
+        if (kind == PerUser) {
+            vecmath::log2(rows, acc, out + r0);
+            vecmath::widen(rows, out + r0, round);
+        } else if (kind == Sum && round != vecmath::Nearest) {
+            vecmath::log2(rows, acc, acc);
+            vecmath::widen(rows, acc, round);
+            for (size_t r = 0; r < rows; ++r) {sum += acc[r];}
+        } else if (kind == Sum) {
+            for (size_t r = 0; r < rows; ++r) {
+                int e;
+                ret = std::frexp(ret * acc[r], &e);
+                exponent += e;
+            }
+        } else {
+            vecmath::log2(rows, acc, acc);
+            vecmath::widen(rows, acc, round);
+            for (size_t r = 0; r < rows; ++r) {ret *= acc[r];}
+        }
+    }
+
+    if (kind == Sum && round != vecmath::Nearest) {
+        // the rates are >= 0 up to the widening, so the error of the sum is
+        // below k ulp of it
+        out[0] = sum;
+        vecmath::widen(1, out, round, static_cast<double>(k));
+    } else if (kind == Sum) {
+        // mantissa in [1, 2) for a product >= 1, so that its log and the
+        // exponent have the same sign and the sum is within 2 ulp
+        if (exponent > 0) {
+            ret *= 2;
+            --exponent;
+        }
+        out[0] = vecmath::log2(ret) + static_cast<double>(exponent);
+        vecmath::widen(1, out, round, vecmath::ulpError + 1);
+    } else if (kind == PropFair) {
+        out[0] = ret;
+    }
+}
+
+} // namespace rate
+
+#endif //EXPRTREE_RATE_H
@@ -0,0 +1,141 @@
+#ifndef EXPRTREE_SPARSEMATRIX_H
+#define EXPRTREE_SPARSEMATRIX_H
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "Matrix.h"
+
+/*
+ * Matrix in compressed sparse row (CSR) format: the non-zero entries of row i
+ * are mValues[mRowPtr[i]] ... mValues[mRowPtr[i+1]-1] in columns mColIdx[...],
+ * sorted by column. Zeros are never stored, so a product with a vector visits
+ * only the non-zeros, in the same order as the dense product.
+ */
+class SparseMatrix {
+public:
+    SparseMatrix();
+    // from a dense row-major matrix
+    SparseMatrix(size_t rows, size_t cols, const std::vector<double>& mat);
+    // from CSR arrays (e.g. scipy.sparse.csr_matrix indptr, indices, data)
+    SparseMatrix(size_t rows, size_t cols, const std::vector<size_t>& rowPtr, const std::vector<size_t>& colIdx, const std::vector<double>& values);
+    SparseMatrix(const SparseMatrix &old) = default;
+    double operator()(size_t i, size_t j) const;
+    void print() const;
+
+    Matrix toDense() const;
+    std::vector<size_t> getDim() const;
+    size_t getRows() const {return mRows;};
+    size_t getCols() const {return mCols;};
+    size_t getNonZeros() const {return mValues.size();};
+    const std::vector<size_t>& getRowPtr() const {return mRowPtr;};
+    const std::vector<size_t>& getColIdx() const {return mColIdx;};
+    const std::vector<double>& getValues() const {return mValues;};
+
+    // init + <row, vec>, summed over the non-zeros of the row
+    double rowProduct(size_t row, const double* vec, double init) const {
+        for (size_t k = mRowPtr[row]; k < mRowPtr[row + 1]; ++k) {
+            init += mValues[k] * vec[mColIdx[k]];
+        }
+        return init;
+    };
+    // init + <pos(row), b> + <neg(row), bs> in one sweep, see gemv::multSplit()
+    double rowProductSplit(size_t row, const double* b, const double* bs, double init) const {
+        for (size_t k = mRowPtr[row]; k < mRowPtr[row + 1]; ++k) {
+            init += mValues[k] * (mValues[k] >= 0 ? b : bs)[mColIdx[k]];
+        }
+        return init;
+    };
+
+private:
+    size_t mRows;
+    size_t mCols;
+    std::vector<size_t> mRowPtr;
+    std::vector<size_t> mColIdx;
+    std::vector<double> mValues;
+};
+
+SparseMatrix::SparseMatrix():mRows(0),mCols(0),mRowPtr(1, 0) {}
+
+SparseMatrix::SparseMatrix(size_t rows, size_t cols, const std::vector<double>& mat)
+:   mRows(rows),
+    mCols(cols),
+    mRowPtr(rows + 1, 0)
+{
+    if (mat.size() != rows * cols) {
+        throw std::invalid_argument("SparseMatrix: size of the data does not match rows*cols");
+    }
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            if (mat[i * cols + j] != 0) {
+                mColIdx.push_back(j);
+                mValues.push_back(mat[i * cols + j]);
+            }
+        }
+        mRowPtr[i + 1] = mValues.size();
+    }
+}
+
+SparseMatrix::SparseMatrix(size_t rows, size_t cols, const std::vector<size_t>& rowPtr, const std::vector<size_t>& colIdx, const std::vector<double>& values)
+:   mRows(rows),
+    mCols(cols),
+    mRowPtr(rows + 1, 0)
+{
+    if (rowPtr.size() != rows + 1 || rowPtr.front() != 0 || rowPtr.back() != values.size() || colIdx.size() != values.size()) {
+        throw std::invalid_argument("SparseMatrix: inconsistent CSR arrays");
+    }
+    for (size_t i = 0; i < rows; ++i) {
+        if (rowPtr[i + 1] < rowPtr[i]) {
+            throw std::invalid_argument("SparseMatrix: inconsistent CSR arrays");
+        }
+        for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; ++k) {
+            if (colIdx[k] >= cols || (k > rowPtr[i] && colIdx[k] <= colIdx[k - 1])) {
+                throw std::invalid_argument("SparseMatrix: column indices out of range or not sorted");
+            }
+            // explicitly stored zeros are dropped
+            if (values[k] != 0) {
+                mColIdx.push_back(colIdx[k]);
+                mValues.push_back(values[k]);
+            }
+        }
+        mRowPtr[i + 1] = mValues.size();
+    }
+}
+
+double SparseMatrix::operator()(size_t i, size_t j) const {
+    for (size_t k = mRowPtr[i]; k < mRowPtr[i + 1]; ++k) {
+        if (mColIdx[k] == j) {
+            return mValues[k];
+        }
+    }
+    return 0;
+}
+
+void SparseMatrix::print() const {
+    std::cout << std::endl << "       sparse " << mRows << "x" << mCols << ", " << mValues.size() << " non-zeros: [";
+    for (size_t i = 0; i < mRows; ++i) {
+        for (size_t k = mRowPtr[i]; k < mRowPtr[i + 1]; ++k) {
+            std::cout << (k > 0 ? ", " : "") << "(" << i << "," << mColIdx[k] << "): " << mValues[k];
+        }
+    }
+    std::cout << "]" << std::endl;
+}
+
+Matrix SparseMatrix::toDense() const {
+    Matrix ret(mRows, mCols);
+    for (size_t i = 0; i < mRows; ++i) {
+        for (size_t k = mRowPtr[i]; k < mRowPtr[i + 1]; ++k) {
+            ret(i, mColIdx[k]) = mValues[k];
+        }
+    }
+    return ret;
+}
+
+std::vector<size_t> SparseMatrix::getDim() const {
+    std::vector<size_t> ret(2);
+    ret.at(0) = mRows;
+    ret.at(1) = mCols;
+    return ret;
+}
+
+#endif //EXPRTREE_SPARSEMATRIX_H
@@ -0,0 +1,52 @@
+#ifndef EXPRTREE_SPLIT_H
+#define EXPRTREE_SPLIT_H
+
+#include <limits>
+
+/*
+ * MMP bounds of a product and of a quotient of operands of unknown sign,
+ * shared by the expression tree (the sign variants with U operands) and the
+ * Tape, so both give bit-identical results.
+ *
+ * a and b are the operands evaluated in the orientation of the result, as and
+ * bs in the swapped one. For (x,y) = (ub,lb), a and b are upper and as and bs
+ * lower bounds of the operands on the box [lb, ub], for (lb,ub) the other way
+ * round, and all four coincide for x = y. The tree copies the value of an
+ * argument as soon as it is evaluated, evaluating the other argument may
+ * evaluate it again in the other orientation.
+ */
+namespace split
+{
+
+inline double pos(double v) {return v >= 0 ? v : 0;}
+inline double neg(double v) {return v >= 0 ? 0 : v;}
+
+// a*b = (pos(a) + neg(a)) * (pos(b) + neg(b)): each of the four products of
+// the parts is monotone in both of them
+inline double mult(double a, double as, double b, double bs) {
+    return pos(a) * pos(b) + pos(as) * neg(b) + neg(a) * pos(bs) + neg(as) * neg(bs);
+}
+
+// a/b for a denominator of unknown sign: if the range of b does not contain 0,
+// the bound for its sign on the box (as for the NN and NP variants), otherwise
+// the quotient is unbounded there: +inf for (ub,lb) (b >= bs) and -inf for
+// (lb,ub), nan if b or bs is nan
+inline double div(double a, double as, double b, double bs) {
+    if (b > 0 && bs > 0) {
+        return pos(a) / bs + neg(a) / b;
+    }
+    if (b < 0 && bs < 0) {
+        return pos(as) / bs + neg(as) / b;
+    }
+    if (b >= bs) {
+        return std::numeric_limits<double>::infinity();
+    }
+    if (b < bs) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+} // namespace split
+
+#endif //EXPRTREE_SPLIT_H
@@ -1,6 +1,8 @@
-"""Module for providing Variable, Parameter and MultiDimParameter Class."""
+"""Module for providing Variable, Parameter, MultiDimParameter and
+SparseMultiDimParameter Class."""
 
 from abc import abstractmethod
+import weakref
 
 import cppyy
 import numpy as np
@@ -26,9 +28,14 @@ class Expression:
     def __getitem__(self, key):
         """
         Override the operator [], for accessing parts of an expression.
-        Creates a Sliced-Expression.
+        Creates a Sliced-Expression. Slices are shared, i.e., the same index
+        always returns the same Sliced-Expression, so that its value is
+        computed only once per evaluation.
         """
-        return cppyy.gbl.Sliced(self.cpprep, key)
+        slices = self.__dict__.setdefault("_slices", {})
+        if key not in slices:
+            slices[key] = cppyy.gbl.Sliced(self.cpprep, key)
+        return slices[key]
 
     def eval(self, x, y):
         """
@@ -39,7 +46,7 @@ class Expression:
         :param y: input value y
         :return: The result (vector/list of doubles) of the evaluation
         """
-        self.cpprep.evaluate(x, y)
+        self.cpprep.evaluate_root(x, y)
         self.cpprep.printFunction()
         return self.cpprep.getValue()
 
@@ -165,14 +172,23 @@ class Parameter(Leaf):
         super().__init__()
 
         value = _convert_to_vector(value)
-        # check, if expression of this (dim/value) already exists:
-        par_id = cppyy.gbl.Expression.getParameterId(value)
-        if par_id != -1:
-            # if yes, then return a pointer of respective Parameter
-            self.cpprep = cppyy.gbl.Expression.getExpression(par_id)
+        # check, if a Parameter with this value already exists:
+        key = tuple(float(v) for v in value)
+        existing = _parameters.get(key)
+        if existing is not None:
+            # if yes, then share its C++ object (and keep it alive)
+            self.cpprep = existing.cpprep
+            self._shared = existing
         else:
             # Else create a new Parameter
             self.cpprep = cppyy.gbl.Parameter(value)
+            _parameters[key] = self
+
+
+# Parameters by value, for sharing the C++ object of equal Parameters. Only
+# Parameters still in use are kept, so that the C++ objects of models that are
+# no longer referenced are freed.
+_parameters = weakref.WeakValueDictionary()
 
 
 class MultiDimParameter(Leaf):
@@ -206,6 +222,45 @@ class MultiDimParameter(Leaf):
         self.cpprep = cppyy.gbl.MultiDimParameter(rows, cols, self.vecvalue)
 
 
+class SparseMultiDimParameter(MultiDimParameter):
+    """
+    Concrete class derived from Expression->Leaf->MultiDimParameter.
+    A Matrix stored in compressed sparse row format, only the non-zero
+    entries are stored and visited during evaluation. It can be used
+    wherever a MultiDimParameter can be used.
+    """
+
+    def __init__(self, value):
+        """
+        Create a SparseMultiDimParameter-instance.
+
+        :param value: The value of the Matrix, either a scipy.sparse matrix
+                      or a dense list, tuple or numpy.ndarray.
+        """
+        self.value = value
+
+        if hasattr(value, "tocsr"):
+            # scipy.sparse matrix (without importing scipy)
+            csr = value.tocsr(copy=True)
+            csr.sum_duplicates()
+            csr.sort_indices()
+            rows, cols = csr.shape
+            self.cpprep = cppyy.gbl.SparseMultiDimParameter(
+                rows, cols, [int(v) for v in csr.indptr],
+                [int(v) for v in csr.indices], [float(v) for v in csr.data])
+        elif isinstance(value, (list, tuple, np.ndarray)):
+            rows = len(value)
+            cols = len(value[0])
+            self.vecvalue = [value[i][j] for i in range(rows)
+                             for j in range(cols)]
+            self.cpprep = cppyy.gbl.SparseMultiDimParameter(rows, cols,
+                                                            self.vecvalue)
+        else:
+            raise TypeError(
+                "Unknown type (" + str(type(self.value)) +
+                ") as argument of SparseMultiDimParameter!")
+
+
 class Function(Expression):
     """
     Abstract class, which is derived from Expression.
@@ -6,6 +6,33 @@ import mmp_framework.expression as expr
 
 cppyy.include('OptimizationProblem.h')
 cppyy.include('OptimizationProblemWithConstraints.h')
+cppyy.include('CodeGen.h')
+cppyy.include('ModelFile.h')
+
+
+def _progress_dict(p):
+    return {"time": p.time, "iter": p.iter, "queue_size": p.queueSize,
+            "optval": p.optval, "bound": p.bound, "xopt": list(p.xopt)}
+
+
+class _Observer(cppyy.gbl.Observer):
+    """Forwards the C++ Observer callbacks to Python callables."""
+
+    def __init__(self, problem, on_incumbent, on_progress):
+        super().__init__()
+        self.problem = problem
+        self.on_incumbent = on_incumbent
+        self.on_progress = on_progress
+
+    def incumbent(self, p):
+        if self.on_incumbent is not None and \
+                self.on_incumbent(_progress_dict(p)):
+            self.problem.cancel()
+
+    def progress(self, p):
+        if self.on_progress is not None and \
+                self.on_progress(_progress_dict(p)):
+            self.problem.cancel()
 
 
 class Problem:
@@ -17,43 +44,146 @@ class Problem:
     manipulated.
     """
 
+    _jit_classes = 0  # number of generated classes, for unique class names
+
+    # Problems with at most this many variables use solver classes
+    # instantiated for their dimension (faster evaluation, but every new
+    # dimension costs a few seconds of compilation). Larger problems share
+    # the classes for runtime dimensions, which are compiled only once.
+    fixed_dim_max = 8
+
     def __init__(self, objective: "expr.Function", optvar: "expr.Variable",
-                 constraints=None):
+                 constraints=None, jit=False):
         """
         Create a problem-instance.
 
         :param objective: The objective function to be optimized
         :param optvar: The optimization variable
         :param constraints: The constraint list for the problem.
+        :param jit: Generate and compile a problem specific solver class.
+            This takes a few seconds but speeds up the evaluation of the
+            objective and the constraints.
         """
         if constraints is None:
             constraints = []
         self.obj = objective
         self.optvar = optvar
         self.constraints = constraints
+        self._observer = None  # keeps the Python observer alive
+        self.jit_source = None  # C++ source of the generated class
+
+        if jit:
+            self.mmp_object = self._jit()
+        else:
+            self.mmp_object = self._compile()
+
+        self.mmp_object.setUB(optvar.ub)
+        self.mmp_object.setLB(optvar.lb)
+        self._set_defaults()
+
+    @classmethod
+    def load(cls, filename):
+        """
+        Create a problem-instance from a file written by save().
+
+        The file is mapped into memory, nothing is compiled. The loaded
+        problem has no expression tree: obj and optvar are None and the
+        objective and the constraints are always evaluated by the tape.
+
+        :param filename: the file name.
+        :return: the problem.
+        """
+        model = cppyy.gbl.ModelFile(filename)
+        self = cls.__new__(cls)
+        self.obj = None
+        self.optvar = None
+        self.constraints = []
+        self._observer = None
+        self.jit_source = None
+
+        if model.getNumConstraints() == 0:
+            template = cppyy.gbl.OptimizationProblem
+        else:
+            template = cppyy.gbl.OptimizationProblemWithConstraints
+        self.mmp_object = Problem._instantiate(template, model.getDim())(
+            model)
+        self._set_defaults()
+        return self
+
+    def save(self, filename):
+        """
+        Write the compiled problem (tapes of the objective and the
+        constraints and the bounds of the optimization variable) to a binary
+        file, see load(). An existing file is replaced.
 
+        :param filename: the file name.
+        """
+        if self.jit_source is None:
+            self.mmp_object.save(filename)
+        else:
+            # the generated class has no tape
+            mmp_object = self._compile()
+            mmp_object.setUB(self.optvar.ub)
+            mmp_object.setLB(self.optvar.lb)
+            mmp_object.save(filename)
+
+    def _compile(self):
+        """ Instantiate the generic problem class. """
+        dim = self.optvar.get_dim()
         if len(self.constraints) == 0:
-            self.mmp_object = cppyy.gbl.OptimizationProblem[
-                self.optvar.get_dim()](
-                self.obj.cpprep)
+            template = cppyy.gbl.OptimizationProblem
+            args = [self.obj.cpprep]
         else:
+            template = cppyy.gbl.OptimizationProblemWithConstraints
             cppconstraintlist = []
             for constr in self.constraints:
                 cppconstraintlist.append(constr.cpprep)
-            self.mmp_object = cppyy.gbl.OptimizationProblemWithConstraints[
-                self.optvar.get_dim()](self.obj.cpprep, cppconstraintlist)
+            args = [self.obj.cpprep, cppconstraintlist]
 
-        self.mmp_object.setUB(optvar.ub)
-        self.mmp_object.setLB(optvar.lb)
+        if dim > Problem.fixed_dim_max:
+            args.append(dim)
+        return Problem._instantiate(template, dim)(*args)
+
+    @staticmethod
+    def _instantiate(template, dim):
+        """ The class of template for dim variables, see fixed_dim_max. """
+        if dim <= Problem.fixed_dim_max:
+            return template[dim]
+        return template[cppyy.gbl.DynamicDim]
+
+    def _set_defaults(self):
         self.set_precision(1e-2)
         self.use_relative_tolerance(False)
         self.disable_reduction(True)
         self.output_every(1000000)
 
+    def _jit(self):
+        """ Generate, compile and instantiate a problem specific class. """
+        Problem._jit_classes += 1
+        name = "MMPjit_%d" % Problem._jit_classes
+        dim = self.optvar.get_dim()
+
+        if len(self.constraints) == 0:
+            source = cppyy.gbl.generateMMP(name, self.obj.cpprep, dim)
+        else:
+            cppconstraintlist = cppyy.gbl.std.vector["Constraint*"](
+                [constr.cpprep for constr in self.constraints])
+            source = cppyy.gbl.generateMMPconstraints(
+                name, self.obj.cpprep, cppconstraintlist, dim)
+
+        self.jit_source = str(source)
+        if not cppyy.cppdef(self.jit_source):
+            raise RuntimeError("compilation of the generated class failed")
+        return getattr(cppyy.gbl, name)(self.obj.cpprep)
+
     def print(self):
         """ Print the Objective-Function to console. """
         self.mmp_object.printObjective()
 
+    def print_tape(self):
+        """ Print the compiled evaluation tape of the problem to console. """
+        self.mmp_object.printTape()
+
     # Interface functions for the MMP-class
     # ----------------------------------------------
     def set_console_output(self, a):
@@ -88,6 +218,70 @@ class Problem:
         """
         self.mmp_object.disableReduction = a
 
+    def use_tape(self, a):
+        """
+        Evaluate the compiled tape (default) instead of walking the
+        expression tree. Both give the same results.
+
+        :param a: the flag value (boolean).
+        """
+        self.mmp_object.useTape = a
+
+    def set_tape_cache(self, n):
+        """
+        Set the number of evaluations the tape keeps (default 0, i.e., the
+        whole tape is always evaluated). Bounds of boxes that differ from a
+        kept one in a few coordinates, e.g., the two children of a branching,
+        only recompute the instructions depending on these coordinates. Pays
+        off for problems with many variables. No effect on jit problems.
+
+        :param n: the number of kept evaluations.
+        """
+        self.mmp_object.setTapeCache(n)
+
+    def use_interval_bounds(self, a):
+        """
+        Bound every box by the minimum of the MMP bound and the natural
+        interval extension of the objective (evaluated on the expression
+        tree), default False. Fewer boxes if the interval bound is tighter,
+        e.g., for products and quotients of sign unknown expressions, at
+        the cost of a second evaluation per bound. Not available for jit
+        and loaded problems, which have no expression tree.
+
+        :param a: the flag value (boolean).
+        """
+        self.mmp_object.setIntervalBounds(a)
+
+    def use_outward_rounding(self, a):
+        """
+        Widen the results of the fast logarithms of the objective's tape by
+        more than their rounding error (up to 1 ulp), so that the computed
+        bounds stay upper bounds of the exact ones (default False). Only the
+        tape is widened, not available for jit and loaded problems.
+
+        :param a: the flag value (boolean).
+        """
+        self.mmp_object.setOutwardRounding(a)
+
+    def set_reduction_tolerance(self, a):
+        """
+        Set the bracket width at which the root finder of the reduction stops.
+
+        :param a: the tolerance value (default 1e-1).
+        """
+        self.mmp_object.reductionTol = a
+
+    def use_bisection(self, a):
+        """
+        Use plain bisection instead of the Illinois method in the reduction.
+
+        :param a: the flag value (boolean).
+        """
+        if a:
+            self.mmp_object.rootFinder = cppyy.gbl.RootFinder.Bisection
+        else:
+            self.mmp_object.rootFinder = cppyy.gbl.RootFinder.Illinois
+
     def output_every(self, a):
         """
         Set the output-period for the solver.
@@ -96,6 +290,55 @@ class Problem:
         """
         self.mmp_object.outputEvery = a
 
+    def enable_profiling(self, a):
+        """
+        Enable the per-phase timing of the solver (see get_profile()).
+
+        :param a: the flag value (boolean).
+        """
+        self.mmp_object.setProfiling(a)
+
+    def enable_trace(self, a, capacity=4096):
+        """
+        Enable recording of the convergence trace (see get_trace()).
+
+        :param a: the flag value (boolean).
+        :param capacity: number of samples kept (the newest ones are kept).
+        """
+        if capacity != self.mmp_object.trace.capacity():
+            self.mmp_object.trace.setCapacity(capacity)
+        self.mmp_object.setTrace(a)
+
+    def set_observer(self, on_incumbent=None, on_progress=None,
+                     interval=1.0):
+        """
+        Register callbacks that are called during optimize().
+
+        Both callbacks receive a dict with the keys time, iter, queue_size,
+        optval, bound and xopt. If a callback returns True, the solve is
+        cancelled (see cancel()). Pass no callbacks to remove the observer.
+
+        :param on_incumbent: called whenever a better solution is found.
+        :param on_progress: called at most once every interval seconds.
+        :param interval: the minimum time between two on_progress calls.
+        """
+        if on_incumbent is None and on_progress is None:
+            self._observer = None
+            self.mmp_object.setObserver(cppyy.nullptr, interval)
+        else:
+            self._observer = _Observer(self, on_incumbent, on_progress)
+            self.mmp_object.setObserver(self._observer, interval)
+
+    def cancel(self):
+        """
+        Stop a running optimize() after the current iteration.
+
+        The status is then "Cancelled" and the best solution found so far is
+        kept. Called before optimize(), the next optimize() stops after its
+        first iteration.
+        """
+        self.mmp_object.cancel()
+
     def optimize(self):
         """Start the solver for this problem instance."""
         self.mmp_object.optimize()
@@ -110,7 +353,7 @@ class Problem:
 
     def get_status(self):
         """
-        Get the Status (Optimal, Infeasible, Unsolved) as string.
+        Get the Status (Optimal, Infeasible, Unsolved, Cancelled) as string.
 
         :return: The status-string.
         """
@@ -140,6 +383,46 @@ class Problem:
         """
         return self.mmp_object.runtime
 
+    def get_profile(self):
+        """
+        Get the per-phase timing of the last solver run. Only available if
+        profiling was enabled before calling optimize().
+
+        :return: dict mapping the phase name to (number of calls, seconds).
+        """
+        profile = self.mmp_object.profile
+        phases = {}
+        for i in range(cppyy.gbl.Profiler.NumPhases):
+            phase = cppyy.gbl.Profiler.Phase(i)
+            phases[profile.name(phase)] = (profile.calls(phase),
+                                           profile.seconds(phase))
+        return phases
+
+    def get_trace(self):
+        """
+        Get the convergence trace of the last solver run. Only available if
+        the trace was enabled before calling optimize().
+
+        :return: list of dicts with the keys time, iter, queue_size, optval,
+            bound and peak_rss (in GB), in chronological order.
+        """
+        return [{"time": s.time, "iter": s.iter, "queue_size": s.queueSize,
+                 "optval": s.optval, "bound": s.bound,
+                 "peak_rss": s.peakRSS}
+                for s in self.mmp_object.trace.samples()]
+
+    def save_trace(self, filename):
+        """
+        Write the convergence trace of the last solver run to a file.
+
+        :param filename: file name, ending in .json for JSON output,
+            CSV is written otherwise.
+        """
+        if filename.endswith(".json"):
+            self.mmp_object.trace.writeJSON(filename)
+        else:
+            self.mmp_object.trace.writeCSV(filename)
+
     def get_total_iterations(self):
         """
         Get the total number of needed iterations.
@@ -0,0 +1,155 @@
+/*
+ * Values and bounds of the objectives in models.h: the expression tree with
+ * and without the algebraic rewrites, the Tape and the Tape with outward
+ * rounding evaluate the same function, and the bounds on random boxes
+ * enclose the values at random points of the box.
+ */
+#include <algorithm>
+#include "models.h"
+
+using namespace models;
+
+int main()
+{
+	std::mt19937 g(42);
+
+	for (auto& m : all())
+	{
+		Model simplified({m.obj});
+		Model plain({m.obj}, false);
+		Expression* root = simplified.get(m.obj);
+		Expression* plainRoot = plain.get(m.obj);
+		Tape tape(root), outward(root, true);
+		const auto expressions = root->get_expression_list();
+
+		check(simplified.size() <= plain.size(), m.name + ": rewrites add nodes");
+		if (m.name.rfind("rewrite_", 0) == 0 && m.name != "rewrite_shared" && m.name.rfind("rewrite_broadcast", 0) != 0)
+			check(simplified.size() < plain.size(), m.name + ": merged nodes are removed");
+
+		for (int i = 0; i < 200; ++i)
+		{
+			// box [lb, ub] and a point p in it
+			auto lb = point(g, m.dim), ub = point(g, m.dim), p = point(g, m.dim);
+			for (size_t k = 0; k < m.dim; ++k)
+			{
+				if (lb[k] > ub[k])
+					std::swap(lb[k], ub[k]);
+				p[k] = std::min(std::max(p[k], lb[k]), ub[k]);
+			}
+
+			const double value = root->evaluate_me(p, p);
+			check(near(value, plainRoot->evaluate_me(p, p)), m.name + ": value with and without rewrites");
+			check(close(value, tape.evaluate_me(p.data(), p.data())), m.name + ": value of tree and Tape");
+			check(value <= outward.evaluate_me(p.data(), p.data()), m.name + ": value of the outward rounded Tape");
+
+			const double bound = root->evaluate_me(ub, lb);
+			check(near(bound, plainRoot->evaluate_me(ub, lb)), m.name + ": bound with and without rewrites");
+			const double tapeBound = tape.evaluate_me(ub.data(), lb.data());
+			if (m.unknownProduct)
+				check(tapeBound <= bound + 1e-12 * std::abs(bound), m.name + ": Tape bound of unknown product");
+			else
+				check(close(bound, tapeBound), m.name + ": bound of tree and Tape");
+
+			const double tol = 1e-12 * std::abs(value);
+			check(value <= bound + tol, m.name + ": tree bound encloses the value");
+			check(value <= tapeBound + tol, m.name + ": Tape bound encloses the value");
+			check(value <= outward.evaluate_me(ub.data(), lb.data()), m.name + ": outward rounded bound encloses the value");
+			const double outwardBound = outward.evaluate_me(ub.data(), lb.data());
+			check(tapeBound <= outwardBound, m.name + ": outward rounded bound is wider");
+			// the logs of a Rate are widened as well
+			if (m.name.rfind("rate_", 0) == 0)
+				check(tapeBound < outwardBound, m.name + ": outward rounded Rate");
+
+			for (auto e : expressions)
+				e->evaluate_interval(lb, ub);
+			check(value <= root->getUpper().at(0) + tol, m.name + ": interval bound encloses the value");
+		}
+	}
+
+	{
+		// outward rounded sum rates of few users at low SINR enclose the sum of the exact logs of the same 1 + SINR
+		std::uniform_int_distribution<size_t> users(2, 21);
+		std::uniform_real_distribution<double> u(0, 1);
+		for (double a : {1e-3, 1.0, 1e3})
+			for (int t = 0; t < 500; ++t)
+			{
+				const size_t K = users(g);
+				std::vector<double> c(rate::constants(K)), p(K), ps(K);
+				for (auto& e : c)
+					e = u(g);
+				for (size_t i = 0; i < K; ++i)
+				{
+					c[i] *= a;
+					c[2 * K + i] = c[3 * K + i * K + i];
+					p[i] = u(g);
+					ps[i] = u(g);
+				}
+
+				// as rate::evaluate(): interference in column order
+				long double exact = 0;
+				for (size_t i = 0; i < K; ++i)
+				{
+					double acc = c[K + i];
+					for (size_t j = 0; j < K; ++j)
+						acc += c[3 * K + j * K + i] * ps[j];
+					exact += std::log2l(1 + c[i] * p[i] / (acc + c[2 * K + i] * (p[i] - ps[i])));
+				}
+
+				double up, down;
+				rate::evaluate(rate::Sum, K, c.data(), p.data(), ps.data(), &up, vecmath::Up);
+				rate::evaluate(rate::Sum, K, c.data(), p.data(), ps.data(), &down, vecmath::Down);
+				check(up >= exact, "rate_sum_outward: rounded up");
+				check(down <= exact, "rate_sum_outward: rounded down");
+			}
+	}
+
+	{
+		// the atoms of a constant folded to a known sign become the variants for that sign
+		auto x = new Variable(4, NN);
+		auto c = new Add_vec_vec(new Parameter({1, 2, 3, 4}), new Neg(new Parameter({0.5, 0.5, 0.5, 0.5})));
+		auto n = new Neg(new Parameter({1, 2, 3, 4}));
+		auto mult = new Mult_vecU_vecNN(c, x);
+		auto swapped = new Mult_vecU_vecNP(n, new Neg(x));
+		auto div = new Div_VecNN_VecU(x, c);
+		auto dot = new Dot_U_U(new Neg(x), n);
+		Model model({new Sum(new Add_vec_vec(mult, new Add_vec_vec(swapped, div))), dot});
+		check(dynamic_cast<Mult_vecNN_vecNN*>(model.get(mult)) != nullptr, "folded_signs: variant of a product");
+		check(dynamic_cast<Mult_vecNP_vecNP*>(model.get(swapped)) != nullptr, "folded_signs: variant of a product");
+		check(dynamic_cast<Div_VecNN_VecNN*>(model.get(div)) != nullptr, "folded_signs: variant of a quotient");
+		check(dynamic_cast<Dot_U_NP*>(model.get(dot)) != nullptr, "folded_signs: variant of a dot product");
+	}
+
+	{
+		// the sum rate of many users with a high SINR: the product of the 1 + SINR overflows
+		const size_t K = 80;
+		std::vector<double> beta(K * K, 1e-3), ones(K, 1.0);
+		auto x = new Variable(K, NN);
+		auto sum = new Rate(new Parameter(std::vector<double>(K, 1e4)), x, new MultiDimParameter(K, K, beta),
+				new Parameter(std::vector<double>(K, 1e-2)), rate::Sum);
+		auto y = new Variable(K, NN);
+		auto perUser = new Dot_NN_NN(new Parameter(ones), new Rate(new Parameter(std::vector<double>(K, 1e4)), y,
+				new MultiDimParameter(K, K, beta), new Parameter(std::vector<double>(K, 1e-2)), rate::PerUser));
+		Model model({sum, perUser});
+		Tape tape(model.get(sum)), outward(model.get(sum), true);
+
+		for (int i = 0; i < 20; ++i)
+		{
+			auto lb = point(g, K), ub = point(g, K);
+			for (size_t k = 0; k < K; ++k)
+				if (lb[k] > ub[k])
+					std::swap(lb[k], ub[k]);
+
+			for (auto v : {std::make_pair(ub, lb), std::make_pair(lb, ub), std::make_pair(ub, ub)})
+			{
+				const double r = model.get(sum)->evaluate_me(v.first, v.second);
+				check(std::isfinite(r), "rate_sum_80: finite sum rate");
+				check(near(r, model.get(perUser)->evaluate_me(v.first, v.second), 1e-10), "rate_sum_80: sum of the rates");
+				check(r == tape.evaluate_me(v.first.data(), v.second.data()), "rate_sum_80: tree and Tape");
+				const double o = outward.evaluate_me(v.first.data(), v.second.data());
+				check(r < o, "rate_sum_80: outward rounded Tape");
+			}
+		}
+	}
+
+	return report();
+}
@@ -0,0 +1,194 @@
+#ifndef _MMP_TESTS_MODELS_
+#define _MMP_TESTS_MODELS_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "OptimizationProblem.h"
+#include "OptimizationProblemWithConstraints.h"
+
+/*
+ * Objectives shared by the test drivers. Every model is a function of one
+ * variable x in [0, 1]^K; together they use every atom (and sign variant
+ * class) the Tape has a kernel for and every algebraic rewrite of the Model.
+ *
+ * Every driver is a program of its own that prints the failed checks and
+ * exits with 1 if there are any, e.g. from the root of the repository:
+ *   g++ -std=c++17 -O1 -Immp_framework/cppresources/algorithm \
+ *       -Immp_framework/cppresources/expressiontree tests/cpp/signs.cpp && ./a.out
+ */
+namespace models
+{
+
+struct TestModel
+{
+	std::string name;
+	size_t dim;
+	Function* obj;
+	// contains a product of two arguments of unknown sign, the Tape bounds it per box (see Tape::specialize())
+	bool unknownProduct = false;
+};
+
+const std::vector<double> alpha = {8.34, 0.39, 8.74, 1.24};
+const std::vector<double> sigma = {1e-2, 2e-2, 1e-2, 5e-2};
+const std::vector<double> beta = {0, 5.99, 9.51, 0.607, 1.35, 0, 0.02, 1.62, 0.385, 0.467, 0, 1.87, 0.127, 0.0214, 0.031, 0};
+const std::vector<double> mixed = {0, -1, 0, 2, 0.5, 0, 0, 0, 0, 3, -2, 0, 1, 0, 0, -1};
+
+inline std::vector<TestModel> all()
+{
+	const size_t K = 4;
+	std::vector<TestModel> m;
+
+	{
+		auto x = new Variable(K, NN);
+		auto sinr = new Div_VecNN_VecNN(new Mult_vecNN_vecNN(new Parameter(alpha), x),
+				new Add_vec_vec(new Parameter(sigma), new Mult_MatNN_VecNN(new MultiDimParameter(K, K, beta), x)));
+		m.push_back({"sum_rate_atoms", K, new Sum(new Log2(new Add_vec_scalar(sinr, new Parameter({1.0}))))});
+	}
+	for (auto kind : {rate::PerUser, rate::Sum, rate::PropFair})
+	{
+		auto x = new Variable(K, NN);
+		Function* r = new Rate(new Parameter(alpha), x, new MultiDimParameter(K, K, beta), new Parameter(sigma), kind);
+		if (kind == rate::PerUser)
+			r = new Dot_NN_NN(new Parameter({1, 2, 1, 0.5}), r);
+		m.push_back({"rate_" + std::to_string(kind), K, r});
+	}
+	{
+		auto x = new Variable(K, NN);
+		auto sparse = new Mult_SpMatNN_VecNN(new SparseMultiDimParameter(K, K, beta), x);
+		m.push_back({"sparse_ln", K, new Prod(new LogN(new Add_vec_scalar(sparse, new Parameter({1.5}))))});
+	}
+	{
+		// unknown signs: matrices of mixed sign, negations and Affine
+		auto x = new Variable(K, NN);
+		auto s = new Mult_SpMatU_VecNN(new SparseMultiDimParameter(K, K, mixed), x);
+		auto d = new Mult_MatU_VecNN(new MultiDimParameter(K, K, mixed), x);
+		auto l = new List(std::vector<Expression*>{new Sliced(x, 0), new Sliced(d, 2), new Sliced(s, 1), new Sliced(x, 3)});
+		auto aff = new Neg(new Add_vec_scalar(l, new Parameter({0.5})));
+		auto q = new Div_VecU_VecNN(aff, new Add_vec_scalar(x, new Parameter({1.0})));
+		m.push_back({"mixed_signs", K, new Sum(new Add_vec_vec(q, new Mult_vecU_scalarNN(s, new Sliced(x, 1)))), false});
+	}
+	{
+		auto x = new Variable(K, NN);
+		auto a = new Mult_MatU_VecNN(new MultiDimParameter(K, K, mixed), x);
+		auto b = new Add_vec_vec(new Parameter({-0.5, 0.5, -0.2, 0.1}), x);
+		m.push_back({"unknown_product", K, new Sum(new Mult_vecU_vecU(a, b)), true});
+	}
+	{
+		// the numerator of the divisions by a vector of unknown sign
+		auto x = new Variable(K, NN);
+		auto u = new Add_vec_vec(new Parameter({-0.5, 0.5, -0.2, 0.1}), x);
+		auto nn = new Div_VecNN_VecU(new Add_vec_scalar(x, new Parameter({1.0})), u);
+		auto np = new Div_VecNP_VecU(new Neg(new Add_vec_scalar(x, new Parameter({2.0}))), u);
+		m.push_back({"div_unknown", K, new Sum(new Add_vec_vec(nn, np))});
+	}
+	{
+		auto x = new Variable(K, NN);
+		auto inv = new Inv(new Add_vec_scalar(x, new Parameter({0.25})));
+		auto ratio = new Div_ScalarNN_VecNN(new Sliced(x, 2), new Add_vec_scalar(x, new Parameter({1.0})));
+		auto scaled = new Div_VecNN_ScalarNN(inv, new Add_vec_scalar(new Sliced(x, 0), new Parameter({2.0})));
+		m.push_back({"inv_div_scalar", K, new Dot_NN_NN(new Add_vec_vec(scaled, ratio), new Mult_vecNN_scalarNN(x, new Parameter({3.0})))});
+	}
+	{
+		// one Function reads x in both orientations, through different arguments
+		auto x = new Variable(K, NN);
+		m.push_back({"both_orientations", K, new Sum(new Add_vec_vec(x, new Div_ScalarNN_VecNN(new Parameter({1.0}), x)))});
+	}
+	{
+		// constants of unknown sign that fold to nonnegative values, see exactVariant() in Function.h
+		auto x = new Variable(K, NN);
+		auto c = new Add_vec_vec(new Parameter({1, 2, 3, 4}), new Neg(new Parameter({0.5, 0.5, 0.5, 0.5})));
+		auto q = new Div_VecNN_VecU(new Add_vec_scalar(x, new Parameter({1.0})), c);
+		m.push_back({"folded_signs", K, new Add_vec_vec(new Dot_U_NN(c, x), new Sum(new Add_vec_vec(new Mult_vecU_vecNN(c, x), q)))});
+	}
+
+	// the algebraic rewrites of the Model, see rewrite() in Function.h
+	{
+		auto x = new Variable(K, NN);
+		m.push_back({"rewrite_neg_neg", K, new Sum(new Log2(new Add_vec_scalar(new Neg(new Neg(x)), new Parameter({1.0}))))});
+	}
+	{
+		auto x = new Variable(K, NN);
+		auto a = new Neg(new Add_vec_vec(new Parameter({1, 2, 3, 4}), new Mult_vecNN_scalarNN(x, new Parameter({2.0}))));
+		m.push_back({"rewrite_neg_add", K, new Sum(new Mult_vecNN_vecNP(x, a))});
+	}
+	{
+		auto x = new Variable(K, NN);
+		auto a = new Add_vec_scalar(new Add_vec_vec(new Parameter({1, 2, 3, 4}), new Neg(x)), new Parameter({3.0}));
+		m.push_back({"rewrite_add_add", K, new Sum(new Log2(a))});
+	}
+	{
+		// a scalar added to a constant vector is no Affine of the scalar
+		auto x = new Variable(K, NN);
+		m.push_back({"rewrite_broadcast", K, new Sum(new Neg(new Add_vec_scalar(new Parameter({1, 2, 3}), new Sliced(x, 0))))});
+		auto y = new Variable(K, NN);
+		auto c = new Add_vec_scalar(new Parameter({1, 2, 3}), new Neg(new Sliced(y, 1)));
+		m.push_back({"rewrite_broadcast_neg", K, new Sum(new Add_vec_scalar(c, new Parameter({0.5})))});
+	}
+	{
+		auto x = new Variable(K, NN);
+		auto z = new Neg(x);
+		m.push_back({"rewrite_dot", K, new Add_vec_vec(new Sum(new Mult_vecNN_vecNN(x, x)),
+				new Add_vec_vec(new Sum(new Mult_vecNN_vecNP(x, z)), new Sum(new Mult_vecNP_vecNP(z, z))))});
+	}
+	{
+		auto x = new Variable(K, NN);
+		auto u = new Add_vec_vec(new Parameter({-0.5, 0.5, -0.2, 0.1}), x);
+		m.push_back({"rewrite_dot_unknown", K, new Add_vec_vec(new Sum(new Mult_vecU_vecNN(u, x)), new Sum(new Mult_vecU_vecNP(u, new Neg(x))))});
+	}
+	{
+		// shared nodes are not merged
+		auto x = new Variable(K, NN);
+		auto a = new Add_vec_scalar(x, new Parameter({1.0}));
+		auto n = new Neg(a);
+		m.push_back({"rewrite_shared", K, new Sum(new Add_vec_vec(new Mult_vecNN_vecNP(a, n), new Add_vec_scalar(n, new Parameter({2.0}))))});
+	}
+
+	return m;
+}
+
+// random point of [0, 1]^dim, in float like the boxes of BRB
+inline std::vector<double> point(std::mt19937& g, size_t dim)
+{
+	std::uniform_real_distribution<float> u(0, 1);
+	std::vector<double> p(dim);
+	for (auto& e : p)
+		e = u(g);
+	return p;
+}
+
+inline bool close(double a, double b, double tol = 1e-12)
+{
+	return a == b || std::abs(a - b) <= tol * std::max(std::abs(a), std::abs(b));
+}
+
+// close up to the rounding errors of a sum of terms of magnitude up to 1, also if the terms cancel
+// (the rewrites change the order of some sums, see rewrite() in Function.h)
+inline bool near(double a, double b, double tol = 1e-12)
+{
+	return a == b || std::abs(a - b) <= tol * std::max({1.0, std::abs(a), std::abs(b)});
+}
+
+inline int failures = 0;
+
+inline void check(bool ok, const std::string& what)
+{
+	if (!ok)
+	{
+		++failures;
+		std::printf("FAIL %s\n", what.c_str());
+	}
+}
+
+inline int report()
+{
+	std::printf("%d failures\n", failures);
+	return failures == 0 ? 0 : 1;
+}
+
+} // namespace models
+
+#endif
@@ -0,0 +1,240 @@
+/*
+ * Every sign variant of the products and quotients: on random boxes, the
+ * values in both orientations of the tree and of the Tape enclose the values
+ * of the function at random points of the box (upper bound for (ub,lb), lower
+ * bound for (lb,ub)), no bound is nan, and the values at a point are the
+ * products and quotients of the values of the operands.
+ */
+#include <algorithm>
+#include <functional>
+#include "models.h"
+
+using namespace models;
+
+namespace
+{
+
+const size_t K = 4;
+
+// operand of the given sign, a function of x in [0, 1]^K; second selects other offsets. The vectors of
+// unknown sign have elements of both signs and elements whose range contains 0 (as denominators).
+Expression* operand(Variable* x, sign s, bool second)
+{
+	switch (s)
+	{
+		case NN:
+			return new Add_vec_scalar(x, new Parameter({second ? 0.5 : 0.25}));
+		case NP:
+			return new Neg(new Add_vec_scalar(x, new Parameter({second ? 0.5 : 0.25})));
+		default:
+			if (second)
+				return new Add_vec_vec(new Parameter({0.4, -0.6, -1.5, 0.2}), new Neg(x));
+			return new Add_vec_vec(new Parameter({-0.5, 0.3, 1.5, -1.2}), x);
+	}
+}
+
+Expression* scalar(Variable* x, sign s, bool second)
+{
+	return new Sliced(operand(x, s, second), second ? 3 : 0);
+}
+
+std::vector<double> matrix(sign s)
+{
+	std::vector<double> m = s == unknown ? mixed : beta;
+	if (s == NP)
+		for (auto& e : m)
+			e = -e;
+	return m;
+}
+
+std::vector<double> values(Expression* e, const std::vector<double>& p)
+{
+	e->evaluate_root(p, p);
+	return *e->getValue();
+}
+
+bool encloses(double lower, double v, double upper)
+{
+	const double tol = 1e-12 * std::abs(v);
+	return std::isnan(v) || (lower <= v + tol && v <= upper + tol);
+}
+
+bool equal(double a, double b)
+{
+	return (std::isnan(a) && std::isnan(b)) || close(a, b);
+}
+
+// f: the atom of operands a, b; exact: its value from the values of the operands at a point
+void test(const std::string& name, Function* f, Expression* a, Expression* b,
+		const std::function<std::vector<double>(const std::vector<double>&, const std::vector<double>&)>& exact)
+{
+	std::mt19937 g(7);
+	Model model({f}, false);
+	Expression* root = model.get(f);
+	Tape tape(root);
+	const size_t dim = root->getDim();
+
+	for (int i = 0; i < 300; ++i)
+	{
+		auto lb = point(g, K), ub = point(g, K);
+		for (size_t k = 0; k < K; ++k)
+			if (lb[k] > ub[k])
+				std::swap(lb[k], ub[k]);
+
+		root->evaluate_root(ub, lb);
+		const std::vector<double> upper = *root->getValue();
+		root->evaluate_root(lb, ub);
+		const std::vector<double> lower = *root->getValue();
+		tape.evaluate(ub.data(), lb.data());
+		const std::vector<double> tapeUpper(tape.getValue(), tape.getValue() + dim);
+		tape.evaluate(lb.data(), ub.data());
+		const std::vector<double> tapeLower(tape.getValue(), tape.getValue() + dim);
+
+		for (size_t k = 0; k < dim; ++k)
+			check(!std::isnan(upper[k]) && !std::isnan(lower[k]) && !std::isnan(tapeUpper[k]) && !std::isnan(tapeLower[k]),
+					name + ": nan bound");
+
+		for (int j = 0; j < 30; ++j)
+		{
+			auto p = point(g, K);
+			for (size_t k = 0; k < K; ++k)
+				p[k] = lb[k] + p[k] * (ub[k] - lb[k]);
+
+			const std::vector<double> expected = exact(values(a, p), values(b, p));
+			root->evaluate_root(p, p);
+			const std::vector<double> value = *root->getValue();
+			tape.evaluate(p.data(), p.data());
+
+			for (size_t k = 0; k < dim; ++k)
+			{
+				check(equal(value[k], expected[k]), name + ": value of the tree");
+				check(equal(tape.getValue()[k], expected[k]), name + ": value of the Tape");
+				check(encloses(lower[k], expected[k], upper[k]), name + ": tree bounds enclose the value");
+				check(encloses(tapeLower[k], expected[k], tapeUpper[k]), name + ": Tape bounds enclose the value");
+			}
+		}
+	}
+}
+
+double at(const std::vector<double>& v, size_t i)
+{
+	return v[v.size() == 1 ? 0 : i];
+}
+
+std::vector<double> elementwise(const std::vector<double>& a, const std::vector<double>& b, double (*op)(double, double))
+{
+	std::vector<double> r(std::max(a.size(), b.size()));
+	for (size_t i = 0; i < r.size(); ++i)
+		r[i] = op(at(a, i), at(b, i));
+	return r;
+}
+
+double mult(double a, double b) {return a * b;}
+double div(double a, double b) {return a / b;}
+
+const char* name(sign s)
+{
+	return s == NN ? "NN" : (s == NP ? "NP" : "U");
+}
+
+// atom T of sign variant (Sa, Sb), where Make builds it from the operands
+template <typename T, sign Sa, sign Sb>
+struct Case
+{
+	static constexpr sign a = Sa, b = Sb;
+	using type = T;
+};
+
+template <typename... C, typename Make>
+void testAll(const std::string& family, Make make)
+{
+	(make(family + "_" + name(C::a) + "_" + name(C::b), C::a, C::b, [](auto* a, Expression* b) -> Function* {return new typename C::type(a, b);}), ...);
+}
+
+} // namespace
+
+int main()
+{
+	auto vecVec = [](double (*op)(double, double)) {
+		return [op](const std::string& n, sign sa, sign sb, auto create) {
+			auto x = new Variable(K, NN);
+			Expression* a = operand(x, sa, false);
+			Expression* b = operand(x, sb, true);
+			test(n, create(a, b), a, b, [op](const std::vector<double>& av, const std::vector<double>& bv) {return elementwise(av, bv, op);});
+		};
+	};
+	auto vecScalar = [](double (*op)(double, double)) {
+		return [op](const std::string& n, sign sa, sign sb, auto create) {
+			auto x = new Variable(K, NN);
+			Expression* a = operand(x, sa, false);
+			Expression* b = scalar(x, sb, true);
+			test(n, create(a, b), a, b, [op](const std::vector<double>& av, const std::vector<double>& bv) {return elementwise(av, bv, op);});
+		};
+	};
+	auto scalarVec = [](const std::string& n, sign sa, sign sb, auto create) {
+		auto x = new Variable(K, NN);
+		Expression* a = scalar(x, sa, false);
+		Expression* b = operand(x, sb, true);
+		test(n, create(a, b), a, b, [](const std::vector<double>& av, const std::vector<double>& bv) {return elementwise(av, bv, div);});
+	};
+	auto dot = [](const std::string& n, sign sa, sign sb, auto create) {
+		auto x = new Variable(K, NN);
+		Expression* a = operand(x, sa, false);
+		Expression* b = operand(x, sb, true);
+		test(n, create(a, b), a, b, [](const std::vector<double>& av, const std::vector<double>& bv) {
+			double r = 0;
+			for (size_t i = 0; i < av.size(); ++i)
+				r += av[i] * bv[i];
+			return std::vector<double>{r};
+		});
+	};
+	// tag: a null pointer of the type of the matrix parameter
+	auto matVec = [](auto tag) {
+		return [](const std::string& n, sign sa, sign sb, auto create) {
+			using P = std::remove_pointer_t<decltype(tag)>;
+			auto x = new Variable(K, NN);
+			const std::vector<double> m = matrix(sa);
+			Expression* b = operand(x, sb, true);
+			test(n, create(new P(K, K, m), b), x, b, [m](const std::vector<double>&, const std::vector<double>& bv) {
+				std::vector<double> r(K, 0);
+				for (size_t i = 0; i < K; ++i)
+					for (size_t j = 0; j < K; ++j)
+						r[i] += m[i * K + j] * bv[j];
+				return r;
+			});
+		};
+	};
+
+	testAll<Case<Mult_vecNN_vecNN, NN, NN>, Case<Mult_vecNP_vecNP, NP, NP>, Case<Mult_vecNN_vecNP, NN, NP>,
+			Case<Mult_vecU_vecNN, unknown, NN>, Case<Mult_vecU_vecNP, unknown, NP>, Case<Mult_vecU_vecU, unknown, unknown>>
+			("mult_vec_vec", vecVec(mult));
+	testAll<Case<Mult_vecNN_scalarNN, NN, NN>, Case<Mult_vecNP_scalarNP, NP, NP>, Case<Mult_vecNN_scalarNP, NN, NP>,
+			Case<Mult_vecNP_scalarNN, NP, NN>, Case<Mult_vecU_scalarNN, unknown, NN>, Case<Mult_vecU_scalarNP, unknown, NP>,
+			Case<Mult_vecNN_scalarU, NN, unknown>, Case<Mult_vecNP_scalarU, NP, unknown>, Case<Mult_vecU_scalarU, unknown, unknown>>
+			("mult_vec_scalar", vecScalar(mult));
+	testAll<Case<Div_VecNN_VecNN, NN, NN>, Case<Div_VecNP_VecNP, NP, NP>, Case<Div_VecNN_VecNP, NN, NP>,
+			Case<Div_VecNP_VecNN, NP, NN>, Case<Div_VecU_VecNN, unknown, NN>, Case<Div_VecU_VecNP, unknown, NP>,
+			Case<Div_VecNN_VecU, NN, unknown>, Case<Div_VecNP_VecU, NP, unknown>, Case<Div_VecU_VecU, unknown, unknown>>
+			("div_vec_vec", vecVec(div));
+	testAll<Case<Div_VecNN_ScalarNN, NN, NN>, Case<Div_VecNP_ScalarNP, NP, NP>, Case<Div_VecNN_ScalarNP, NN, NP>,
+			Case<Div_VecNP_ScalarNN, NP, NN>, Case<Div_VecU_ScalarNN, unknown, NN>, Case<Div_VecU_ScalarNP, unknown, NP>,
+			Case<Div_VecNN_ScalarU, NN, unknown>, Case<Div_VecNP_ScalarU, NP, unknown>, Case<Div_VecU_ScalarU, unknown, unknown>>
+			("div_vec_scalar", vecScalar(div));
+	testAll<Case<Div_ScalarNN_VecNN, NN, NN>, Case<Div_ScalarNP_VecNP, NP, NP>, Case<Div_ScalarNN_VecNP, NN, NP>,
+			Case<Div_ScalarNP_VecNN, NP, NN>, Case<Div_ScalarU_VecNN, unknown, NN>, Case<Div_ScalarU_VecNP, unknown, NP>,
+			Case<Div_ScalarNN_VecU, NN, unknown>, Case<Div_ScalarNP_VecU, NP, unknown>, Case<Div_ScalarU_VecU, unknown, unknown>>
+			("div_scalar_vec", scalarVec);
+	testAll<Case<Dot_NN_NN, NN, NN>, Case<Dot_NP_NP, NP, NP>, Case<Dot_NN_NP, NN, NP>,
+			Case<Dot_U_NN, unknown, NN>, Case<Dot_U_NP, unknown, NP>, Case<Dot_U_U, unknown, unknown>>
+			("dot", dot);
+	testAll<Case<Mult_MatNN_VecNN, NN, NN>, Case<Mult_MatNP_VecNP, NP, NP>, Case<Mult_MatNN_VecNP, NN, NP>,
+			Case<Mult_MatNP_VecNN, NP, NN>, Case<Mult_MatU_VecNN, unknown, NN>, Case<Mult_MatU_VecNP, unknown, NP>,
+			Case<Mult_MatNN_VecU, NN, unknown>, Case<Mult_MatNP_VecU, NP, unknown>, Case<Mult_MatU_VecU, unknown, unknown>>
+			("mult_mat_vec", matVec(static_cast<MultiDimParameter*>(nullptr)));
+	testAll<Case<Mult_SpMatNN_VecNN, NN, NN>, Case<Mult_SpMatNP_VecNP, NP, NP>, Case<Mult_SpMatNN_VecNP, NN, NP>,
+			Case<Mult_SpMatNP_VecNN, NP, NN>, Case<Mult_SpMatU_VecNN, unknown, NN>, Case<Mult_SpMatU_VecNP, unknown, NP>,
+			Case<Mult_SpMatNN_VecU, NN, unknown>, Case<Mult_SpMatNP_VecU, NP, unknown>, Case<Mult_SpMatU_VecU, unknown, unknown>>
+			("mult_spmat_vec", matVec(static_cast<SparseMultiDimParameter*>(nullptr)));
+
+	return report();
+}
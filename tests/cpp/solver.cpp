@@ -0,0 +1,80 @@
+/*
+ * BRB::optimize() on models of models.h: every incumbent reported to an
+ * Observer has a bound that covers the final optimum, i.e., the boxes of the
+ * iteration that found the incumbent are counted in the bound. Interval
+ * bounds need the expression tree, a loaded problem rejects them.
+ */
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include "models.h"
+
+using namespace models;
+
+namespace
+{
+
+class Recorder : public Observer
+{
+	public:
+		std::vector<Progress> incumbents;
+		void incumbent(const Progress& p) override {incumbents.push_back(p);};
+};
+
+} // namespace
+
+int main()
+{
+	for (auto& m : all())
+	{
+		if (m.name != "sum_rate_atoms" && m.name.rfind("rate_", 0) != 0)
+			continue;
+
+		OptimizationProblem<4> problem(m.obj);
+		problem.setLB(0.0);
+		problem.setUB(1.0);
+		problem.output = false;
+		Recorder recorder;
+		problem.setObserver(&recorder);
+		problem.optimize();
+
+		check(!recorder.incumbents.empty(), m.name + ": incumbents reported");
+		for (const auto& p : recorder.incumbents)
+		{
+			check(p.optval <= problem.optval, m.name + ": incumbent value");
+			check(p.bound >= problem.optval, m.name + ": bound of an incumbent covers the optimum");
+		}
+	}
+
+	{
+		OptimizationProblem<4> problem(all().front().obj);
+		problem.setLB(0.0);
+		problem.setUB(1.0);
+		problem.setIntervalBounds(true);
+		check(problem.useIntervals, "interval bounds of a problem with expression tree");
+
+		const std::string file = (std::filesystem::temp_directory_path() / "mmp_solver_test.mmp").string();
+		problem.save(file);
+		problem.save(file);
+		// the temporary files are renamed into place
+		size_t files = 0;
+		for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::temp_directory_path()))
+			files += entry.path().filename().string().rfind("mmp_solver_test.mmp", 0) == 0;
+		check(files == 1, "save() leaves no temporary files");
+		OptimizationProblem<4> loaded{ModelFile(file)};
+		bool rejected = false;
+		try
+		{
+			loaded.setIntervalBounds(true);
+		}
+		catch (const std::logic_error&)
+		{
+			rejected = true;
+		}
+		check(rejected && !loaded.useIntervals, "interval bounds of a loaded problem");
+		loaded.setIntervalBounds(false);
+		std::remove(file.c_str());
+	}
+
+	return report();
+}